@@ -0,0 +1,143 @@
+local builtin = _G.builtin
+local hasFFI, ffi = pcall(require, "ffi")
+local type = type
+local pairs = pairs
+local rawget = rawget
+local ipairs = ipairs
+local table_concat = table.concat
+
+--[[
+Opt-in LuaJIT FFI accessors for the hottest scalar properties.
+
+	builtin.enableFFI() -- returns false when FFI or the C accessors are not available
+
+After it is called, accessing the properties listed below on a Node,
+Sprite, Body or Action object calls the C functions exported from
+Source/Lua/LuaManual.cpp directly instead of the tolua++ metamethods,
+so that loops doing node.x = node.x + 1 can be compiled by the JIT.
+Other fields still go through tolua++ with the same behavior.
+]]
+
+-- {type, name, readonly}
+local properties = {
+	Node = {
+		{"int", "order"},
+		{"float", "angle"},
+		{"float", "angleX"},
+		{"float", "angleY"},
+		{"float", "scaleX"},
+		{"float", "scaleY"},
+		{"float", "x"},
+		{"float", "y"},
+		{"float", "z"},
+		{"float", "skewX"},
+		{"float", "skewY"},
+		{"bool", "visible"},
+		{"float", "width"},
+		{"float", "height"},
+		{"float", "opacity"},
+	},
+	Sprite = {
+		{"float", "alphaRef"},
+	},
+	Body = {
+		{"float", "mass", true},
+		{"float", "velocityX"},
+		{"float", "velocityY"},
+		{"float", "angularRate"},
+		{"float", "linearDamping"},
+		{"float", "angularDamping"},
+	},
+	Action = {
+		{"float", "duration", true},
+		{"bool", "running", true},
+		{"bool", "paused", true},
+		{"bool", "reversed"},
+		{"float", "speed"},
+	},
+}
+
+-- metatable index of super class names registered by tolua++
+local MT_SUPER = 3
+
+local enabled = false
+
+-- symbols are missing when the engine is not linked into the executable
+-- (e.g. libmain.so on Android), then the tolua++ accessors stay in use
+local function loadAccessors()
+	local decls = {}
+	for className, props in pairs(properties) do
+		for _, prop in ipairs(props) do
+			local ptype, name, readonly = prop[1], prop[2], prop[3]
+			decls[#decls + 1] = ptype.." dora_"..className.."_get_"..name.."(void* self);"
+			if not readonly then
+				decls[#decls + 1] = "void dora_"..className.."_set_"..name.."(void* self, "..ptype.." value);"
+			end
+		end
+	end
+	ffi.cdef(table_concat(decls, "\n"))
+	local C = ffi.C
+
+	local accessors = {}
+	for className, props in pairs(properties) do
+		local getters, setters = {}, {}
+		for _, prop in ipairs(props) do
+			local name, readonly = prop[2], prop[3]
+			getters[name] = C["dora_"..className.."_get_"..name]
+			if not readonly then
+				setters[name] = C["dora_"..className.."_set_"..name]
+			end
+		end
+		accessors[className] = {getters, setters}
+	end
+	return accessors
+end
+
+local function enableFFI()
+	if enabled then return true end
+	if not hasFFI then return false end
+
+	local loaded, accessors = pcall(loadAccessors)
+	if not loaded then
+		hasFFI = false
+		return false
+	end
+
+	for _, cls in pairs(builtin) do
+		local supers = type(cls) == "table" and rawget(cls, MT_SUPER)
+		if type(supers) == "table" then
+			local getters, setters
+			for className, accessor in pairs(accessors) do
+				if supers[className] then
+					getters, setters = getters or {}, setters or {}
+					for name, getter in pairs(accessor[1]) do getters[name] = getter end
+					for name, setter in pairs(accessor[2]) do setters[name] = setter end
+				end
+			end
+			if getters then
+				local index = cls.__index
+				local newindex = cls.__newindex
+				cls.__index = function(self, key)
+					local getter = getters[key]
+					if getter and type(self) == "userdata" then
+						return getter(self)
+					end
+					return index(self, key)
+				end
+				cls.__newindex = function(self, key, value)
+					local setter = setters[key]
+					if setter and type(self) == "userdata" then
+						setter(self, value)
+					else
+						newindex(self, key, value)
+					end
+				end
+			end
+		end
+	end
+
+	enabled = true
+	return true
+end
+
+builtin.enableFFI = enableFFI
@@ -254,6 +254,10 @@ Atlas::Atlas(uint16_t _textureSize, Type type, bool antiAlias, uint16_t _maxRegi
 	: m_textureSize(_textureSize)
 	, m_regionCount(0)
 	, m_maxRegionCount(_maxRegionsCount)
+	, m_dirtyLeft(UINT16_MAX)
+	, m_dirtyTop(UINT16_MAX)
+	, m_dirtyRight(0)
+	, m_dirtyBottom(0)
 	, m_type(type)
 {
 	AssertUnless(_textureSize >= 64 && _textureSize <= 4096, "Invalid _textureSize %d.", _textureSize);
@@ -357,13 +361,47 @@ uint16_t Atlas::addRegion(uint16_t _width, uint16_t _height, const uint8_t* _bit
 void Atlas::updateRegion(const AtlasRegion& _region, const uint8_t* _bitmapBuffer)
 {
 	uint32_t bytes = m_type == Gray ? 1 : 4;
-	uint32_t targetSize = _region.width * _region.height * bytes;
-	if (0 < targetSize)
+	uint32_t rowSize = _region.width * bytes;
+	if (0 < rowSize * _region.height)
 	{
-		const bgfx::Memory* mem = bgfx::alloc(targetSize);
-		bx::memCopy(mem->data, _bitmapBuffer, mem->size);
-		bgfx::updateTexture2D(m_texture->getHandle(), 0, 0, _region.x, _region.y, _region.width, _region.height, mem);
+		uint32_t pitch = m_textureSize * bytes;
+		uint8_t* dst = m_textureBuffer + _region.y * pitch + _region.x * bytes;
+		for (uint16_t yy = 0; yy < _region.height; ++yy)
+		{
+			bx::memCopy(dst, _bitmapBuffer, rowSize);
+			dst += pitch;
+			_bitmapBuffer += rowSize;
+		}
+		m_dirtyLeft = std::min<uint16_t>(m_dirtyLeft, _region.x);
+		m_dirtyTop = std::min<uint16_t>(m_dirtyTop, _region.y);
+		m_dirtyRight = std::max<uint16_t>(m_dirtyRight, _region.x + _region.width);
+		m_dirtyBottom = std::max<uint16_t>(m_dirtyBottom, _region.y + _region.height);
+	}
+}
+
+void Atlas::commit()
+{
+	if (m_dirtyLeft >= m_dirtyRight || m_dirtyTop >= m_dirtyBottom)
+	{
+		return;
+	}
+	uint32_t bytes = m_type == Gray ? 1 : 4;
+	uint16_t width = m_dirtyRight - m_dirtyLeft;
+	uint16_t height = m_dirtyBottom - m_dirtyTop;
+	uint32_t rowSize = width * bytes;
+	uint32_t pitch = m_textureSize * bytes;
+	const bgfx::Memory* mem = bgfx::alloc(rowSize * height);
+	const uint8_t* src = m_textureBuffer + m_dirtyTop * pitch + m_dirtyLeft * bytes;
+	uint8_t* dst = mem->data;
+	for (uint16_t yy = 0; yy < height; ++yy)
+	{
+		bx::memCopy(dst, src, rowSize);
+		dst += rowSize;
+		src += pitch;
 	}
+	bgfx::updateTexture2D(m_texture->getHandle(), 0, 0, m_dirtyLeft, m_dirtyTop, width, height, mem);
+	m_dirtyLeft = m_dirtyTop = UINT16_MAX;
+	m_dirtyRight = m_dirtyBottom = 0;
 }
 
 } // namespace bgfx
@@ -48,9 +48,12 @@ public:
 	/// add a region to the atlas, and copy the content of mem to the underlying texture
 	uint16_t addRegion(uint16_t _width, uint16_t _height, const uint8_t* _bitmapBuffer, uint16_t outline = 0);
 
-	/// update a preallocated region
+	/// update a preallocated region, the texture is updated by next commit
 	void updateRegion(const AtlasRegion& _region, const uint8_t* _bitmapBuffer);
 
+	/// upload the dirty rectangle of all updated regions to texture at once
+	void commit();
+
 	/// return the TextureHandle (cube) of the atlas
 	Dorothy::Texture2D* getTexture() const
 	{
@@ -113,6 +116,11 @@ private:
 
 	uint16_t m_regionCount;
 	uint16_t m_maxRegionCount;
+
+	uint16_t m_dirtyLeft;
+	uint16_t m_dirtyTop;
+	uint16_t m_dirtyRight;
+	uint16_t m_dirtyBottom;
 };
 
 } // namespace bgfx
@@ -24,6 +24,7 @@ BX_PRAGMA_DIAGNOSTIC_IGNORED_MSVC(4245) // error C4245: '=' : conversion from 'i
 BX_PRAGMA_DIAGNOSTIC_POP();
 
 #include "bgfx/bgfx.h"
+#include "bx/mutex.h"
 
 #define SDF_IMPLEMENTATION
 #include "sdf/sdf.h"
@@ -75,8 +76,12 @@ public:
 	bool bakeGlyphDistance(CodePoint _codePoint, GlyphInfo& _outGlyphInfo, uint8_t* _outBuffer);
 
 	FT_Face getFace() const;
+
+	/// FreeType faces are not thread safe, lock it before using the face
+	bx::Mutex& getMutex();
 private:
 	FTHolder* m_font;
+	bx::Mutex m_mutex;
 };
 
 TrueTypeFont::TrueTypeFont() : m_font(NULL)
@@ -351,6 +356,7 @@ struct FontManager::CachedFont
 {
 	CachedFont()
 		: trueTypeFont(NULL)
+		, fontType(FONT_TYPE_ALPHA)
 	{
 		masterFontHandle.idx = bx::HandleAlloc::invalid;
 	}
@@ -358,6 +364,7 @@ struct FontManager::CachedFont
 	FontInfo fontInfo;
 	GlyphHashMap cachedGlyphs;
 	TrueTypeFont* trueTypeFont;
+	uint32_t fontType;
 	// an handle to a master font in case of sub distance field font
 	FontHandle masterFontHandle;
 	int16_t padding;
@@ -368,10 +375,14 @@ FT_Face TrueTypeFont::getFace() const
 	return m_font->face;
 }
 
-#define MAX_FONT_BUFFER_SIZE (512 * 512 * 4)
+bx::Mutex& TrueTypeFont::getMutex()
+{
+	return m_mutex;
+}
 
 FontManager::FontManager(uint16_t _textureSideWidth)
 	: m_currentAtlas(nullptr)
+	, m_currentDistanceAtlas(nullptr)
 	, m_textureWidth(_textureSideWidth)
 {
 	init();
@@ -422,7 +433,7 @@ void FontManager::destroyTtf(TrueTypeHandle _handle)
 	m_filesHandles.free(_handle.idx);
 }
 
-FontHandle FontManager::createFontByPixelSize(TrueTypeHandle _ttfHandle, uint32_t _typefaceIndex, uint32_t _pixelSize)
+FontHandle FontManager::createFontByPixelSize(TrueTypeHandle _ttfHandle, uint32_t _typefaceIndex, uint32_t _pixelSize, uint32_t _fontType)
 {
 	AssertUnless(bgfx::isValid(_ttfHandle), "Invalid handle used");
 
@@ -439,6 +450,7 @@ FontHandle FontManager::createFontByPixelSize(TrueTypeHandle _ttfHandle, uint32_
 
 	CachedFont& font = m_cachedFonts[fontIdx];
 	font.trueTypeFont = ttf;
+	font.fontType = _fontType;
 	font.fontInfo = ttf->getFontInfo();
 	font.fontInfo.pixelSize = uint16_t(_pixelSize);
 	font.cachedGlyphs.clear();
@@ -471,6 +483,7 @@ FontHandle FontManager::createScaledFontToPixelSize(FontHandle _baseFontHandle,
 	font.cachedGlyphs.clear();
 	font.fontInfo = newFontInfo;
 	font.trueTypeFont = NULL;
+	font.fontType = baseFont.fontType;
 	font.masterFontHandle = _baseFontHandle;
 
 	FontHandle handle = { fontIdx };
@@ -516,69 +529,118 @@ bool FontManager::preloadGlyph(FontHandle _handle, const wchar_t* _string)
 }
 
 bool FontManager::preloadGlyph(FontHandle _handle, CodePoint _codePoint)
+{
+	AssertUnless(bgfx::isValid(_handle), "Invalid handle used");
+	if (findGlyphInfo(_handle, _codePoint))
+	{
+		return true;
+	}
+	GlyphInfo glyphInfo;
+	if (!bakeGlyph(_handle, _codePoint, glyphInfo, m_buffer))
+	{
+		return false;
+	}
+	return addGlyph(_handle, _codePoint, glyphInfo, m_buffer) != NULL;
+}
+
+bool FontManager::bakeGlyph(FontHandle _handle, CodePoint _codePoint, GlyphInfo& _outGlyphInfo, uint8_t* _outBuffer)
+{
+	AssertUnless(bgfx::isValid(_handle), "Invalid handle used");
+	const CachedFont& font = m_cachedFonts[_handle.idx];
+	if (NULL == font.trueTypeFont)
+	{
+		return isValid(font.masterFontHandle) && bakeGlyph(font.masterFontHandle, _codePoint, _outGlyphInfo, _outBuffer);
+	}
+	bx::MutexScope lock(font.trueTypeFont->getMutex());
+	if (font.fontType == FONT_TYPE_DISTANCE)
+	{
+		return font.trueTypeFont->bakeGlyphDistance(_codePoint, _outGlyphInfo, _outBuffer);
+	}
+	return font.trueTypeFont->bakeGlyphAlpha(_codePoint, _outGlyphInfo, _outBuffer);
+}
+
+const GlyphInfo* FontManager::addGlyph(FontHandle _handle, CodePoint _codePoint, GlyphInfo& _glyphInfo, const uint8_t* _bitmap)
 {
 	AssertUnless(bgfx::isValid(_handle), "Invalid handle used");
 	CachedFont& font = m_cachedFonts[_handle.idx];
 	FontInfo& fontInfo = font.fontInfo;
 
 	GlyphHashMap::iterator iter = font.cachedGlyphs.find(_codePoint);
-	if (iter != font.cachedGlyphs.end() )
+	if (iter != font.cachedGlyphs.end())
 	{
-		return true;
+		return &iter->second;
 	}
 
+	GlyphInfo glyphInfo;
 	if (NULL != font.trueTypeFont)
 	{
-		GlyphInfo glyphInfo;
-		if (!font.trueTypeFont->bakeGlyphAlpha(_codePoint, glyphInfo, m_buffer))
+		bool distance = font.fontType == FONT_TYPE_DISTANCE;
+		if (!addBitmap(_glyphInfo, _bitmap, distance))
 		{
-			return false;
-		}
-		if (!addBitmap(glyphInfo, m_buffer))
-		{
-			m_currentAtlas = new Atlas(m_textureWidth, Atlas::Gray);
-			m_atlases.push_back(MakeOwn(m_currentAtlas));
-			if (!addBitmap(glyphInfo, m_buffer))
+			Atlas* atlas = new Atlas(m_textureWidth, Atlas::Gray);
+			m_atlases.push_back(MakeOwn(atlas));
+			if (distance) m_currentDistanceAtlas = atlas;
+			else m_currentAtlas = atlas;
+			if (!addBitmap(_glyphInfo, _bitmap, distance))
 			{
-				return false;
+				return NULL;
 			}
 		}
+		glyphInfo = _glyphInfo;
+	}
+	else if (isValid(font.masterFontHandle))
+	{
+		const GlyphInfo* glyph = addGlyph(font.masterFontHandle, _codePoint, _glyphInfo, _bitmap);
+		if (!glyph)
+		{
+			return NULL;
+		}
+		glyphInfo = *glyph;
+	}
+	else
+	{
+		return NULL;
+	}
 
-		glyphInfo.advance_x = (glyphInfo.advance_x * fontInfo.scale);
-		glyphInfo.advance_y = (glyphInfo.advance_y * fontInfo.scale);
-		glyphInfo.offset_x = (glyphInfo.offset_x * fontInfo.scale);
-		glyphInfo.offset_y = (glyphInfo.offset_y * fontInfo.scale);
-		glyphInfo.height = (glyphInfo.height * fontInfo.scale);
-		glyphInfo.width = (glyphInfo.width * fontInfo.scale);
+	glyphInfo.advance_x = (glyphInfo.advance_x * fontInfo.scale);
+	glyphInfo.advance_y = (glyphInfo.advance_y * fontInfo.scale);
+	glyphInfo.offset_x = (glyphInfo.offset_x * fontInfo.scale);
+	glyphInfo.offset_y = (glyphInfo.offset_y * fontInfo.scale);
+	glyphInfo.height = (glyphInfo.height * fontInfo.scale);
+	glyphInfo.width = (glyphInfo.width * fontInfo.scale);
 
-		font.cachedGlyphs[_codePoint] = glyphInfo;
-		return true;
-	}
+	font.cachedGlyphs[_codePoint] = glyphInfo;
+	return &font.cachedGlyphs.find(_codePoint)->second;
+}
 
-	if (isValid(font.masterFontHandle) &&  preloadGlyph(font.masterFontHandle, _codePoint) )
+const GlyphInfo* FontManager::findGlyphInfo(FontHandle _handle, CodePoint _codePoint)
+{
+	const CachedFont& font = m_cachedFonts[_handle.idx];
+	GlyphHashMap::const_iterator it = font.cachedGlyphs.find(_codePoint);
+	if (it != font.cachedGlyphs.end())
 	{
-		const GlyphInfo* glyph = getGlyphInfo(font.masterFontHandle, _codePoint);
+		return &it->second;
+	}
+	if (NULL == font.trueTypeFont && isValid(font.masterFontHandle) && findGlyphInfo(font.masterFontHandle, _codePoint))
+	{
+		// scale the glyph already baked by master font
+		GlyphInfo glyphInfo;
+		return addGlyph(_handle, _codePoint, glyphInfo, NULL);
+	}
+	return NULL;
+}
 
-		if (glyph)
-		{
-			GlyphInfo glyphInfo = *glyph;
-			glyphInfo.advance_x = (glyphInfo.advance_x * fontInfo.scale);
-			glyphInfo.advance_y = (glyphInfo.advance_y * fontInfo.scale);
-			glyphInfo.offset_x = (glyphInfo.offset_x * fontInfo.scale);
-			glyphInfo.offset_y = (glyphInfo.offset_y * fontInfo.scale);
-			glyphInfo.height = (glyphInfo.height * fontInfo.scale);
-			glyphInfo.width = (glyphInfo.width * fontInfo.scale);
-
-			font.cachedGlyphs[_codePoint] = glyphInfo;
-			return true;
-		}
-		else
-		{
-			return false;
-		}
+void FontManager::commit()
+{
+	for (const auto& atlas : m_atlases)
+	{
+		atlas->commit();
 	}
+}
 
-	return false;
+uint32_t FontManager::getAtlasCount() const
+{
+	return (uint32_t)m_atlases.size();
 }
 
 const FontInfo& FontManager::getFontInfo(FontHandle _handle) const
@@ -606,15 +668,21 @@ const GlyphInfo* FontManager::getGlyphInfo(FontHandle _handle, CodePoint _codePo
 	return &it->second;
 }
 
-bool FontManager::addBitmap(GlyphInfo& _glyphInfo, const uint8_t* _data)
+bool FontManager::addBitmap(GlyphInfo& _glyphInfo, const uint8_t* _data, bool _distance)
 {
-	uint16_t regionIndex = m_currentAtlas->addRegion((uint16_t)ceil(_glyphInfo.width), (uint16_t)ceil(_glyphInfo.height), _data);
+	// distance field glyphs are kept in their own linear filtered pages
+	Atlas* atlas = _distance ? m_currentDistanceAtlas : m_currentAtlas;
+	if (!atlas)
+	{
+		return false;
+	}
+	uint16_t regionIndex = atlas->addRegion((uint16_t)ceil(_glyphInfo.width), (uint16_t)ceil(_glyphInfo.height), _data);
 	if (regionIndex == UINT16_MAX)
 	{
 		return false;
 	}
 	_glyphInfo.regionIndex = regionIndex;
-	_glyphInfo.atlas = m_currentAtlas;
+	_glyphInfo.atlas = atlas;
 	return true;
 }
 
@@ -622,6 +690,7 @@ uint32_t FontManager::getKerning(FontHandle _handle, CodePoint _codeLeft, CodePo
 {
 	const CachedFont& font = m_cachedFonts[_handle.idx];
 	TrueTypeFont* trueTypeFont = font.trueTypeFont ? font.trueTypeFont : m_cachedFonts[font.masterFontHandle.idx].trueTypeFont;
+	bx::MutexScope lock(trueTypeFont->getMutex());
 	if (!FT_HAS_KERNING(trueTypeFont->getFace()))
 	{
 		return 0;
@@ -15,6 +15,7 @@ class Atlas;
 
 #define MAX_OPENED_FILES 64
 #define MAX_OPENED_FONT  64
+#define MAX_FONT_BUFFER_SIZE (512 * 512 * 4)
 
 #define FONT_TYPE_ALPHA             UINT32_C(0x00000100) // L8
 // #define FONT_TYPE_LCD               UINT32_C(0x00000200) // BGRA8
@@ -137,8 +138,9 @@ public:
 	/// Unload a TrueType font (free font memory) but keep loaded glyphs.
 	void destroyTtf(TrueTypeHandle _handle);
 
-	/// Return a font whose height is a fixed pixel size.
-	FontHandle createFontByPixelSize(TrueTypeHandle _handle, uint32_t _typefaceIndex, uint32_t _pixelSize);
+	/// Return a font whose height is a fixed pixel size, glyphs of
+	/// FONT_TYPE_DISTANCE fonts are baked as signed distance fields.
+	FontHandle createFontByPixelSize(TrueTypeHandle _handle, uint32_t _typefaceIndex, uint32_t _pixelSize, uint32_t _fontType = FONT_TYPE_ALPHA);
 
 	/// Return a scaled child font whose height is a fixed pixel size.
 	FontHandle createScaledFontToPixelSize(FontHandle _baseFontHandle, uint32_t _pixelSize);
@@ -155,6 +157,23 @@ public:
 	/// Preload a single glyph, return true on success.
 	bool preloadGlyph(FontHandle _handle, CodePoint _character);
 
+	/// Raster a glyph into a buffer without touching the atlas or the
+	/// glyph cache, it is safe to be called from a worker thread.
+	bool bakeGlyph(FontHandle _handle, CodePoint _codePoint, GlyphInfo& _outGlyphInfo, uint8_t* _outBuffer);
+
+	/// Add a glyph rastered by bakeGlyph to the atlas and the glyph cache.
+	const GlyphInfo* addGlyph(FontHandle _handle, CodePoint _codePoint, GlyphInfo& _glyphInfo, const uint8_t* _bitmap);
+
+	/// Return the glyph if it is already loaded by the font or its master
+	/// font, return NULL instead of loading it.
+	const GlyphInfo* findGlyphInfo(FontHandle _handle, CodePoint _codePoint);
+
+	/// Upload the modified part of every atlas page to its texture.
+	void commit();
+
+	/// Return the number of atlas pages created for glyphs.
+	uint32_t getAtlasCount() const;
+
 	/// Return the font descriptor of a font.
 	///
 	/// @remark the handle is required to be valid
@@ -176,9 +195,10 @@ private:
 	};
 
 	void init();
-	bool addBitmap(GlyphInfo& _glyphInfo, const uint8_t* _data);
+	bool addBitmap(GlyphInfo& _glyphInfo, const uint8_t* _data, bool _distance);
 
 	Atlas* m_currentAtlas;
+	Atlas* m_currentDistanceAtlas;
 	Dorothy::OwnVector<Atlas> m_atlases;
 
 	uint16_t m_textureWidth;
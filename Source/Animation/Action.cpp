@@ -431,18 +431,16 @@ bool FrameAction::update(Node* target, float eclapsed)
 	Sprite* sprite = DoraCast<Sprite>(target);
 	if (sprite)
 	{
-		int frames = s_cast<int>(_def->rects.size());
+		const vector<FrameQuad>& quads = _def->getFrames();
+		int frames = s_cast<int>(quads.size());
 		float time = std::max(0.0f, eclapsed / std::max(_def->duration, FLT_EPSILON));
 		int current = s_cast<int>(time * frames + 0.5f);
 		if (current < frames)
 		{
-			if (sprite->getTexture() != _texture)
+			const FrameQuad& quad = quads[current];
+			if (sprite->getTexture() != _texture || sprite->getTextureRect() != quad.rect)
 			{
-				sprite->setTexture(_texture);
-			}
-			if (sprite->getTextureRect() != *_def->rects[current])
-			{
-				sprite->setTextureRect(*_def->rects[current]);
+				sprite->setFrame(_texture, quad);
 			}
 		}
 	}
@@ -454,6 +452,7 @@ Own<ActionDuration> FrameAction::alloc(FrameActionDef* def)
 {
 	FrameAction* action = new FrameAction();
 	action->_def = def;
+	action->_texture = def->getTexture();
 	action->_ended = false;
 	return Own<ActionDuration>(action);
 }
@@ -13,6 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "fmt/format.h"
 #include "Animation/ModelDef.h"
 #include "Cache/FrameCache.h"
+#include "Cache/XmlItemCache.h"
 
 NS_DOROTHY_BEGIN
 
@@ -280,43 +281,45 @@ Action* ResetAction::create(float duration, SpriteDef* def, Ease::Enum easing)
 
 /* KeyAnimationDef */
 
-KeyFrameDef* KeyAnimationDef::getLastFrameDef() const
+KeyAnimationDef::KeyAnimationDef():
+_keyFrameDefs(nullptr),
+_frameCount(0)
+{ }
+
+void KeyAnimationDef::setFrames(KeyFrameDef* frames, Uint32 count)
 {
-	if (!_keyFrameDefs.empty())
-	{
-		return _keyFrameDefs.back();
-	}
-	return nullptr;
+	_keyFrameDefs = frames;
+	_frameCount = count;
 }
 
-void KeyAnimationDef::add(Own<KeyFrameDef>&& def)
+KeyFrameDef* KeyAnimationDef::getFrames() const
 {
-	_keyFrameDefs.push_back(std::move(def));
+	return _keyFrameDefs;
 }
 
-const OwnVector<KeyFrameDef>& KeyAnimationDef::getFrames() const
+Uint32 KeyAnimationDef::getFrameCount() const
 {
-	return _keyFrameDefs;
+	return _frameCount;
 }
 
 Action* KeyAnimationDef::toAction()
 {
-	if (_keyFrameDefs.empty())
+	if (_frameCount == 0)
 	{
 		return nullptr;
 	}
 
 	vector<Own<ActionDuration>> keyFrames;
-	keyFrames.reserve(_keyFrameDefs.size());
+	keyFrames.reserve(_frameCount);
 	vector<Own<ActionDuration>> keyAttrs;
 	keyAttrs.reserve(KeyFrameDef::MaxKeyAttributes);
 
-	KeyFrameDef* lastDef = _keyFrameDefs.front();
+	KeyFrameDef* lastDef = &_keyFrameDefs[0];
 	keyFrames.push_back(KeyReset::alloc(lastDef));
-	for (size_t i = 1; i < _keyFrameDefs.size(); i++)
+	for (Uint32 i = 1; i < _frameCount; i++)
 	{
 		/* Get current keyFrameDef */
-		KeyFrameDef* def = _keyFrameDefs[i];
+		KeyFrameDef* def = &_keyFrameDefs[i];
 		/* Check for animated attributes of keyFrame */
 		if (lastDef->x != def->x)
 		{
@@ -373,11 +376,16 @@ Action* KeyAnimationDef::toAction()
 	return Sequence::create(std::move(keyFrames));
 }
 
+void KeyAnimationDef::bake(ModelTracks* tracks, Uint32 part, int animation)
+{
+	tracks->addKeys(part, animation, _keyFrameDefs, _frameCount);
+}
+
 string KeyAnimationDef::toXml()
 {
 	fmt::MemoryWriter writer;
 	writer << '<' << char(Xml::Model::Element::KeyAnimation);
-	if (_keyFrameDefs.empty())
+	if (_frameCount == 0)
 	{
 		writer << "/>";
 	}
@@ -385,8 +393,9 @@ string KeyAnimationDef::toXml()
 	{
 		writer << '>';
 		KeyFrameDef* lastDef = nullptr;
-		for (KeyFrameDef* keyFrameDef : _keyFrameDefs)
+		for (Uint32 i = 0; i < _frameCount; i++)
 		{
+			KeyFrameDef* keyFrameDef = &_keyFrameDefs[i];
 			writer << keyFrameDef->toXml(lastDef);
 			lastDef = keyFrameDef;
 		}
@@ -395,19 +404,51 @@ string KeyAnimationDef::toXml()
 	return writer.str();
 }
 
+void KeyAnimationDef::toBinary(BinaryWriter& writer)
+{
+	writer.write(s_cast<Uint8>(AnimationDef::Key));
+	writer.write(_frameCount);
+	for (Uint32 i = 0; i < _frameCount; i++)
+	{
+		const KeyFrameDef* def = &_keyFrameDefs[i];
+		writer.write(def->duration);
+		writer.write(s_cast<Uint8>(def->visible ? 1 : 0));
+		writer.write(def->opacity);
+		writer.write(def->x);
+		writer.write(def->y);
+		writer.write(def->scaleX);
+		writer.write(def->scaleY);
+		writer.write(def->rotation);
+		writer.write(def->skewX);
+		writer.write(def->skewY);
+		writer.write(s_cast<Uint8>(def->easePos));
+		writer.write(s_cast<Uint8>(def->easeScale));
+		writer.write(s_cast<Uint8>(def->easeOpacity));
+		writer.write(s_cast<Uint8>(def->easeRotation));
+		writer.write(s_cast<Uint8>(def->easeSkew));
+	}
+}
+
 void KeyAnimationDef::restoreResetAnimation(Node* target, ActionDuration* action)
 {
 	ResetAction* resetAction = DoraCast<ResetAction>(action);
-	if (resetAction)
+	if (resetAction && _frameCount > 0)
 	{
-		target->setVisible(_keyFrameDefs[0]->visible);
+		target->setVisible(_keyFrameDefs[0].visible);
 		resetAction->prepareWith(target);
-		resetAction->updateEndValues(_keyFrameDefs[0]);
+		resetAction->updateEndValues(&_keyFrameDefs[0]);
 	}
 }
 
 /* FrameAnimationDef */
 
+void FrameAnimationDef::toBinary(BinaryWriter& writer)
+{
+	writer.write(s_cast<Uint8>(AnimationDef::Frame));
+	writer.write(_file);
+	writer.write(delay);
+}
+
 Action* FrameAnimationDef::toAction()
 {
 	return Sequence::create(
@@ -416,6 +457,11 @@ Action* FrameAnimationDef::toAction()
 	);
 }
 
+void FrameAnimationDef::bake(ModelTracks* tracks, Uint32 part, int animation)
+{
+	tracks->addFrames(part, animation, _def, delay);
+}
+
 void FrameAnimationDef::setFile(String filename)
 {
 	_file = filename;
@@ -15,13 +15,18 @@ NS_DOROTHY_BEGIN
 class Object;
 class Node;
 class ResetAction;
+class ModelTracks;
+class BinaryWriter;
 
 class AnimationDef
 {
 public:
+	enum { None = 0, Key = 1, Frame = 2 }; // types in binary form
 	virtual ~AnimationDef() { }
 	virtual Action* toAction() = 0;
+	virtual void bake(ModelTracks* tracks, Uint32 part, int animation) = 0;
 	virtual string toXml() = 0;
+	virtual void toBinary(BinaryWriter& writer) = 0;
 	virtual void restoreResetAnimation(Node* target, ActionDuration* resetTarget) = 0;
 };
 
@@ -106,17 +111,24 @@ private:
 	DORA_TYPE_OVERRIDE(ResetAction);
 };
 
+/** @brief Key frames of the animation are not owned,
+ they are stored in the contiguous key frame array of a ModelDef.
+*/
 class KeyAnimationDef : public AnimationDef
 {
 public:
-	void add(Own<KeyFrameDef>&& def);
-	KeyFrameDef* getLastFrameDef() const;
-	const OwnVector<KeyFrameDef>& getFrames() const;
+	KeyAnimationDef();
+	void setFrames(KeyFrameDef* frames, Uint32 count);
+	KeyFrameDef* getFrames() const;
+	Uint32 getFrameCount() const;
 	virtual Action* toAction() override;
+	virtual void bake(ModelTracks* tracks, Uint32 part, int animation) override;
 	virtual string toXml() override;
+	virtual void toBinary(BinaryWriter& writer) override;
 	virtual void restoreResetAnimation(Node* target, ActionDuration* resetTarget) override;
 private:
-	OwnVector<KeyFrameDef> _keyFrameDefs;
+	KeyFrameDef* _keyFrameDefs;
+	Uint32 _frameCount;
 };
 
 class FrameAnimationDef : public AnimationDef
@@ -126,7 +138,9 @@ public:
 	FrameAnimationDef():delay(0) { }
 	float delay;
 	virtual Action* toAction() override;
+	virtual void bake(ModelTracks* tracks, Uint32 part, int animation) override;
 	virtual string toXml() override;
+	virtual void toBinary(BinaryWriter& writer) override;
 	virtual void restoreResetAnimation(Node* target, ActionDuration* resetTarget) override { }
 private:
 	Ref<FrameActionDef> _def;
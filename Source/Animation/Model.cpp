@@ -443,7 +443,7 @@ void Model::visit(SpriteDef* parentDef, Node* parentNode, ClipDef* clipDef)
 	{
 		return;
 	}
-	const OwnVector<SpriteDef>& childrenDefs = parentDef->children;
+	const vector<SpriteDef*>& childrenDefs = parentDef->children;
 	for (size_t n = 0; n < childrenDefs.size(); n++)
 	{
 		SpriteDef* nodeDef = childrenDefs[n];
@@ -472,7 +472,7 @@ void Model::visit(SpriteDef* parentDef, Node* parentNode, ClipDef* clipDef)
 			}
 		}
 		// Animation
-		const OwnVector<AnimationDef>& animationDefs = nodeDef->animationDefs;
+		const vector<AnimationDef*>& animationDefs = nodeDef->animationDefs;
 		for (size_t i = 0; i < animationDefs.size(); i++)
 		{
 			AnimationDef* animationDef = animationDefs[i];
@@ -711,4 +711,332 @@ void Model::setupCallback()
 	}
 }
 
+/* ModelBatch */
+
+ModelBatch::ModelBatch(String filename):
+_stopping(false),
+_parallelThreshold(500),
+_jobs(0),
+_modelDef(SharedModelCache.load(filename)),
+_tracks(nullptr)
+{ }
+
+ModelBatch::~ModelBatch()
+{
+	ModelBatch::stopWorkers();
+}
+
+bool ModelBatch::init()
+{
+	if (!Node::init()) return false;
+	if (!_modelDef) return false;
+	_tracks = _modelDef->getTracks();
+	Node::scheduleUpdate();
+	return true;
+}
+
+void ModelBatch::setParallelThreshold(Uint32 var)
+{
+	_parallelThreshold = var;
+}
+
+Uint32 ModelBatch::getParallelThreshold() const
+{
+	return _parallelThreshold;
+}
+
+Uint32 ModelBatch::getCount() const
+{
+	return s_cast<Uint32>(_instances.size());
+}
+
+Uint32 ModelBatch::add(const Vec2& position)
+{
+	ModelBatch::wait();
+	_instances.push_back({position, 0.0f, 1.0f, Animation::None, Look::None, false, false, _modelDef->isFaceRight()});
+	return s_cast<Uint32>(_instances.size() - 1);
+}
+
+void ModelBatch::place(Uint32 index, const Vec2& position)
+{
+	if (index >= _instances.size()) return;
+	ModelBatch::wait();
+	_instances[index].position = position;
+}
+
+float ModelBatch::play(Uint32 index, String name, bool loop)
+{
+	if (index >= _instances.size()) return 0.0f;
+	ModelBatch::wait();
+	Instance& instance = _instances[index];
+	instance.animation = _modelDef->getAnimationIndexByName(name);
+	instance.time = 0.0f;
+	instance.loop = loop;
+	instance.playing = instance.animation != Animation::None;
+	return _tracks->getDuration(instance.animation) / std::max(instance.speed, FLT_EPSILON);
+}
+
+void ModelBatch::stop(Uint32 index)
+{
+	if (index >= _instances.size()) return;
+	ModelBatch::wait();
+	_instances[index].playing = false;
+}
+
+void ModelBatch::setSpeed(Uint32 index, float speed)
+{
+	if (index >= _instances.size()) return;
+	ModelBatch::wait();
+	_instances[index].speed = std::max(speed, 0.0f);
+}
+
+void ModelBatch::setFaceRight(Uint32 index, bool var)
+{
+	if (index >= _instances.size()) return;
+	ModelBatch::wait();
+	_instances[index].faceRight = var;
+}
+
+void ModelBatch::setLook(Uint32 index, String name)
+{
+	if (index >= _instances.size()) return;
+	ModelBatch::wait();
+	_instances[index].look = _modelDef->getLookIndexByName(name);
+}
+
+void ModelBatch::clear()
+{
+	ModelBatch::wait();
+	_instances.clear();
+	_vertices.clear();
+	_textures.clear();
+}
+
+void ModelBatch::cleanup()
+{
+	ModelBatch::stopWorkers();
+	Node::cleanup();
+}
+
+void ModelBatch::wait()
+{
+	for (; _jobs > 0; _jobs--)
+	{
+		_evaluated.wait();
+	}
+}
+
+void ModelBatch::stopWorkers()
+{
+	ModelBatch::wait();
+	_stopping = true;
+	for (Worker& worker : _workers)
+	{
+		if (worker.thread.isRunning())
+		{
+			worker.start.post();
+			worker.thread.shutdown();
+		}
+	}
+	_stopping = false;
+}
+
+int ModelBatch::work(void* userData)
+{
+	Worker* worker = r_cast<Worker*>(userData);
+	while (true)
+	{
+		worker->start.wait();
+		if (worker->batch->_stopping)
+		{
+			return 0;
+		}
+		worker->batch->evaluate(worker->begin, worker->end);
+		worker->batch->_evaluated.post();
+	}
+	return 0;
+}
+
+bool ModelBatch::update(double deltaTime)
+{
+	ModelBatch::wait();
+	if (isUpdating() && _tracks)
+	{
+		float deltaTimeF = s_cast<float>(deltaTime);
+		for (Instance& instance : _instances)
+		{
+			if (!instance.playing) continue;
+			float duration = _tracks->getDuration(instance.animation);
+			instance.time += deltaTimeF * instance.speed;
+			if (instance.time >= duration)
+			{
+				if (instance.loop && duration > 0.0f)
+				{
+					instance.time = std::fmod(instance.time, duration);
+				}
+				else
+				{
+					instance.time = duration;
+					instance.playing = false;
+				}
+			}
+		}
+		Uint32 count = s_cast<Uint32>(_instances.size());
+		size_t quadCount = _tracks->getDrawOrder().size() * count;
+		_vertices.resize(quadCount * 4);
+		_textures.resize(quadCount);
+		_color = _realColor;
+		if (_parallelThreshold > 0 && count > _parallelThreshold)
+		{
+			// evaluated by the workers of this batch instead of the shared async
+			// queues, so that no file or decoding job queued there stalls the frame,
+			// the logic thread takes the last part and joins the workers before rendering
+			Uint32 chunk = (count + WorkerCount) / (WorkerCount + 1);
+			for (Uint32 i = 0; i < WorkerCount; i++)
+			{
+				Worker& worker = _workers[i];
+				if (!worker.thread.isRunning())
+				{
+					worker.batch = this;
+					worker.thread.init(ModelBatch::work, &worker);
+				}
+				worker.begin = std::min(chunk * i, count);
+				worker.end = std::min(chunk * (i + 1), count);
+				worker.start.post();
+				_jobs++;
+			}
+			ModelBatch::evaluate(std::min(chunk * WorkerCount, count), count);
+		}
+		else
+		{
+			ModelBatch::evaluate(0, count);
+		}
+	}
+	bool result = Node::update(deltaTime);
+	return !isUpdating() && result;
+}
+
+void ModelBatch::evaluate(Uint32 begin, Uint32 end)
+{
+	if (begin >= end) return;
+	Uint32 partCount = _tracks->getPartCount();
+	const vector<Uint32>& drawOrder = _tracks->getDrawOrder();
+	size_t quadCount = drawOrder.size();
+	vector<ModelTracks::Pose> poses(partCount);
+	vector<AffineTransform> transforms(partCount);
+	float opacity = _color.getOpacity();
+	for (Uint32 i = begin; i < end; i++)
+	{
+		const Instance& instance = _instances[i];
+		if (partCount == 0) break;
+		_tracks->evaluate(instance.animation, instance.time, &poses.front());
+		Uint32 look = 0 <= instance.look && instance.look < 32 ? (1u << instance.look) : 0;
+		AffineTransform root = {instance.faceRight == _modelDef->isFaceRight() ? 1.0f : -1.0f, 0.0f, 0.0f, 1.0f, instance.position.x, instance.position.y};
+		for (Uint32 n = 0; n < partCount; n++)
+		{
+			const ModelTracks::Part& part = _tracks->getPart(n);
+			ModelTracks::Pose& pose = poses[n];
+			const AffineTransform* parent = &root;
+			float parentOpacity = opacity;
+			if (part.parent >= 0)
+			{
+				const ModelTracks::Pose& parentPose = poses[part.parent];
+				pose.visible = pose.visible && parentPose.visible;
+				parent = &transforms[part.parent];
+				parentOpacity = parentPose.opacity;
+			}
+			pose.visible = pose.visible && (part.looks & look) == 0;
+			pose.opacity *= parentOpacity;
+			/* the same local transform as Node::getLocalTransform() */
+			float c = 1.0f, s = 0.0f;
+			if (pose.rotation != 0.0f)
+			{
+				float radians = -bx::toRad(pose.rotation);
+				c = std::cos(radians);
+				s = std::sin(radians);
+			}
+			AffineTransform local = {c * pose.scaleX, s * pose.scaleX, -s * pose.scaleY, c * pose.scaleY, pose.x, pose.y};
+			if (pose.skewX != 0.0f || pose.skewY != 0.0f)
+			{
+				AffineTransform skewMatrix {
+					1.0f, std::tan(bx::toRad(pose.skewY)),
+					std::tan(bx::toRad(pose.skewX)), 1.0f,
+					0.0f, 0.0f};
+				local = AffineTransform::concat(skewMatrix, local);
+			}
+			if (part.anchorPoint != Vec2::zero)
+			{
+				local = AffineTransform::translate(local, -part.anchorPoint.x, -part.anchorPoint.y);
+			}
+			transforms[n] = AffineTransform::concat(local, *parent);
+		}
+		size_t start = i * quadCount;
+		for (size_t n = 0; n < quadCount; n++)
+		{
+			Uint32 index = drawOrder[n];
+			const ModelTracks::Pose& pose = poses[index];
+			Texture2D* texture = pose.visible ? pose.texture : nullptr;
+			_textures[start + n] = texture;
+			if (!texture) continue;
+			const Rect& rect = *pose.rect;
+			const AffineTransform& t = transforms[index];
+			const bgfx::TextureInfo& info = texture->getInfo();
+			float left = rect.getX() / info.width;
+			float top = rect.getY() / info.height;
+			float right = (rect.getX() + rect.getWidth()) / info.width;
+			float bottom = (rect.getY() + rect.getHeight()) / info.height;
+			float w = rect.getWidth(), h = rect.getHeight();
+			Color color = _color;
+			color.setOpacity(pose.opacity);
+			Uint32 abgr = color.toABGR();
+			SpriteVertex* quad = &_vertices[(start + n) * 4];
+			quad[0] = {t.c * h + t.tx, t.d * h + t.ty, 0.0f, 1.0f, left, top, abgr};
+			quad[1] = {t.a * w + t.c * h + t.tx, t.b * w + t.d * h + t.ty, 0.0f, 1.0f, right, top, abgr};
+			quad[2] = {t.tx, t.ty, 0.0f, 1.0f, left, bottom, abgr};
+			quad[3] = {t.a * w + t.tx, t.b * w + t.ty, 0.0f, 1.0f, right, bottom, abgr};
+		}
+	}
+}
+
+void ModelBatch::render()
+{
+	ModelBatch::wait();
+	if (_textures.empty()) return;
+	BlendFunc blendFunc = BlendFunc::Default;
+	Uint64 state = (
+		BGFX_STATE_RGB_WRITE | BGFX_STATE_ALPHA_WRITE |
+		BGFX_STATE_MSAA | blendFunc.toValue());
+	SpriteEffect* effect = SharedSpriteRenderer.getDefaultModelEffect();
+	const float* world = getWorld();
+	// parts on frame animation textures are drawn after the ones on the clip texture
+	vector<Texture2D*> textures;
+	if (_tracks->getTexture()) textures.push_back(_tracks->getTexture());
+	for (Texture2D* texture : _textures)
+	{
+		if (texture && std::find(textures.begin(), textures.end(), texture) == textures.end())
+		{
+			textures.push_back(texture);
+		}
+	}
+	for (Texture2D* texture : textures)
+	{
+		_batch.clear();
+		for (size_t n = 0; n < _textures.size(); n++)
+		{
+			if (_textures[n] != texture) continue;
+			_batch.insert(_batch.end(), _vertices.begin() + n * 4, _vertices.begin() + n * 4 + 4);
+			if (_batch.size() == MaxBatchQuads * 4)
+			{
+				SharedSpriteRenderer.push(_batch.data(), s_cast<Uint32>(_batch.size()), effect, texture, state, INT32_MAX, world);
+				_batch.clear();
+			}
+		}
+		if (!_batch.empty())
+		{
+			SharedSpriteRenderer.push(_batch.data(), s_cast<Uint32>(_batch.size()), effect, texture, state, INT32_MAX, world);
+		}
+	}
+	SharedRendererManager.setCurrent(SharedSpriteRenderer.getTarget());
+}
+
 NS_DOROTHY_END
@@ -9,6 +9,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #pragma once
 
 #include "Node/Node.h"
+#include "Node/Sprite.h"
 
 NS_DOROTHY_BEGIN
 
@@ -19,6 +20,7 @@ class Sequence;
 class Sprite;
 class SpriteDef;
 class ModelDef;
+class ModelTracks;
 class ClipDef;
 
 /** @brief A look is to change visibility of a model`s different parts.
@@ -171,4 +173,74 @@ private:
 	DORA_TYPE_OVERRIDE(Model);
 };
 
+/** @brief Draws a crowd of the same model without creating nodes or actions
+ for each of them. Animations baked in ModelTracks are evaluated per instance
+ into a shared vertex buffer and drawn with one submission per texture.
+ Recovery between animations and animation end handlers are not supported.
+*/
+class ModelBatch : public Node
+{
+public:
+	enum { MaxBatchQuads = 16384 }; // sprite indices are 16-bit
+	PROPERTY_READONLY(Uint32, Count);
+	/** @brief split pose evaluation with the worker threads owned by the batch
+	 when there are more instances than the threshold, zero for always on the
+	 logic thread. The workers are started on first use and stopped on cleanup. */
+	PROPERTY(Uint32, ParallelThreshold);
+	virtual ~ModelBatch();
+	Uint32 add(const Vec2& position);
+	void place(Uint32 index, const Vec2& position);
+	float play(Uint32 index, String name, bool loop = false);
+	void stop(Uint32 index);
+	void setSpeed(Uint32 index, float speed);
+	void setFaceRight(Uint32 index, bool var);
+	void setLook(Uint32 index, String name);
+	void clear();
+	virtual bool init() override;
+	virtual bool update(double deltaTime) override;
+	virtual void render() override;
+	virtual void cleanup() override;
+	CREATE_FUNC(ModelBatch);
+protected:
+	ModelBatch(String filename);
+private:
+	struct Instance
+	{
+		Vec2 position;
+		float time;
+		float speed;
+		int animation;
+		int look;
+		bool loop;
+		bool playing;
+		bool faceRight;
+	};
+	struct Worker
+	{
+		ModelBatch* batch;
+		Uint32 begin;
+		Uint32 end;
+		bx::Thread thread;
+		bx::Semaphore start;
+	};
+	enum { WorkerCount = 2 };
+	static int work(void* userData);
+	void evaluate(Uint32 begin, Uint32 end);
+	void wait();
+	void stopWorkers();
+	bool _stopping;
+	Uint32 _parallelThreshold;
+	Uint32 _jobs;
+	Color _color;
+	Ref<ModelDef> _modelDef;
+	ModelTracks* _tracks;
+	vector<Instance> _instances;
+	vector<SpriteVertex> _vertices;
+	vector<Texture2D*> _textures;
+	vector<SpriteVertex> _batch;
+	bx::Semaphore _evaluated;
+	Worker _workers[WorkerCount];
+	DORA_TYPE_OVERRIDE(ModelBatch);
+};
+
 NS_DOROTHY_END
@@ -11,6 +11,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Node/Sprite.h"
 #include "Cache/ClipCache.h"
 #include "Cache/TextureCache.h"
+#include "Cache/FrameCache.h"
+#include "Cache/XmlItemCache.h"
 #include "Const/XmlTag.h"
 #include "Animation/Animation.h"
 #include "Animation/Model.h"
@@ -131,6 +133,39 @@ string SpriteDef::toXml()
 	return writer.str();
 }
 
+void SpriteDef::toBinary(BinaryWriter& writer)
+{
+	writer.write(s_cast<Uint8>(front ? 1 : 0));
+	writer.write(x);
+	writer.write(y);
+	writer.write(rotation);
+	writer.write(anchorX);
+	writer.write(anchorY);
+	writer.write(scaleX);
+	writer.write(scaleY);
+	writer.write(skewX);
+	writer.write(skewY);
+	writer.write(opacity);
+	writer.write(name);
+	writer.write(clip);
+	writer.write(s_cast<Uint32>(animationDefs.size()));
+	for (AnimationDef* animationDef : animationDefs)
+	{
+		if (animationDef) animationDef->toBinary(writer);
+		else writer.write(s_cast<Uint8>(AnimationDef::None));
+	}
+	writer.write(s_cast<Uint32>(looks.size()));
+	for (int look : looks)
+	{
+		writer.write(look);
+	}
+	writer.write(s_cast<Uint32>(children.size()));
+	for (SpriteDef* child : children)
+	{
+		child->toBinary(writer);
+	}
+}
+
 std::tuple<Action*, ResetAction*> SpriteDef::toResetAction()
 {
 	Own<ActionDuration> resetAction = ResetAction::alloc(1.0f, this, Ease::InOutQuad);
@@ -148,42 +183,237 @@ void SpriteDef::restoreResetAnimation(Node* target, ActionDuration* action)
 	}
 }
 
+/* ModelTracks */
+
+ModelTracks::ModelTracks(ModelDef* def):
+_texture(nullptr),
+_animationCount(0)
+{
+	SpriteDef* root = def->getRoot();
+	if (!root) return;
+	ClipDef* clipDef = SharedClipCache.load(def->getClipFile());
+	if (clipDef)
+	{
+		_texture = SharedTextureCache.load(clipDef->textureFile);
+		_resources.push_back(clipDef);
+		_resources.push_back(_texture);
+	}
+	vector<SpriteDef*> spriteDefs;
+	vector<Uint32> front;
+	for (SpriteDef* child : root->children)
+	{
+		vector<Uint32> order = ModelTracks::addPart(child, -1, clipDef, spriteDefs);
+		vector<Uint32>& target = child->front ? front : _drawOrder;
+		target.insert(target.end(), order.begin(), order.end());
+	}
+	_drawOrder.insert(_drawOrder.end(), front.begin(), front.end());
+	for (Part& part : _parts)
+	{
+		part.pose.rect = &part.rect;
+		part.pose.texture = part.rect.size != Size::zero ? _texture : nullptr;
+	}
+	for (SpriteDef* spriteDef : spriteDefs)
+	{
+		_animationCount = std::max(_animationCount, s_cast<Uint32>(spriteDef->animationDefs.size()));
+	}
+	_durations.resize(_animationCount, 0.0f);
+	_tracks.resize(_animationCount * _parts.size(), Track{0, 0, 0.0f, nullptr, nullptr});
+	for (Uint32 i = 0; i < s_cast<Uint32>(spriteDefs.size()); i++)
+	{
+		const vector<AnimationDef*>& animationDefs = spriteDefs[i]->animationDefs;
+		for (size_t n = 0; n < animationDefs.size(); n++)
+		{
+			if (animationDefs[n])
+			{
+				animationDefs[n]->bake(this, i, s_cast<int>(n));
+			}
+		}
+	}
+}
+
+vector<Uint32> ModelTracks::addPart(SpriteDef* def, int parent, ClipDef* clipDef, vector<SpriteDef*>& spriteDefs)
+{
+	Uint32 index = s_cast<Uint32>(_parts.size());
+	Part part;
+	part.parent = parent;
+	part.looks = 0;
+	for (int look : def->looks)
+	{
+		if (0 <= look && look < 32) part.looks |= (1u << look);
+	}
+	part.rect = Rect::zero;
+	if (clipDef)
+	{
+		auto it = clipDef->rects.find(def->clip);
+		if (it != clipDef->rects.end()) part.rect = it->second;
+	}
+	part.anchorPoint = Vec2{def->anchorX * part.rect.getWidth(), def->anchorY * part.rect.getHeight()};
+	part.pose = {def->x, def->y, def->scaleX, def->scaleY, def->rotation, def->skewX, def->skewY, def->opacity, true, nullptr, nullptr};
+	_parts.push_back(part);
+	spriteDefs.push_back(def);
+	// children behind the parent are drawn first as a Model does with their negative orders
+	vector<Uint32> back, front;
+	for (SpriteDef* child : def->children)
+	{
+		vector<Uint32> order = ModelTracks::addPart(child, s_cast<int>(index), clipDef, spriteDefs);
+		vector<Uint32>& target = child->front ? front : back;
+		target.insert(target.end(), order.begin(), order.end());
+	}
+	back.push_back(index);
+	back.insert(back.end(), front.begin(), front.end());
+	return back;
+}
+
+Texture2D* ModelTracks::getTexture() const
+{
+	return _texture;
+}
+
+Uint32 ModelTracks::getPartCount() const
+{
+	return s_cast<Uint32>(_parts.size());
+}
+
+Uint32 ModelTracks::getAnimationCount() const
+{
+	return _animationCount;
+}
+
+const ModelTracks::Part& ModelTracks::getPart(Uint32 index) const
+{
+	return _parts[index];
+}
+
+const vector<Uint32>& ModelTracks::getDrawOrder() const
+{
+	return _drawOrder;
+}
+
+float ModelTracks::getDuration(int animation) const
+{
+	if (animation < 0 || animation >= s_cast<int>(_animationCount))
+	{
+		return 0.0f;
+	}
+	return _durations[animation];
+}
+
+ModelTracks::Track& ModelTracks::getTrack(Uint32 part, int animation)
+{
+	return _tracks[animation * _parts.size() + part];
+}
+
+void ModelTracks::addKeys(Uint32 part, int animation, const KeyFrameDef* frames, Uint32 count)
+{
+	Track& track = ModelTracks::getTrack(part, animation);
+	track.firstKey = s_cast<Uint32>(_keys.size());
+	track.keyCount = count;
+	// the first key frame is a reset taking no time as KeyAnimationDef::toAction() does
+	float time = 0.0f;
+	for (Uint32 i = 0; i < count; i++)
+	{
+		const KeyFrameDef* def = &frames[i];
+		if (i > 0) time += def->duration;
+		_keys.push_back({time,
+			def->x, def->y, def->scaleX, def->scaleY, def->rotation,
+			def->skewX, def->skewY, def->opacity, def->visible,
+			s_cast<Uint8>(def->easePos), s_cast<Uint8>(def->easeScale),
+			s_cast<Uint8>(def->easeRotation), s_cast<Uint8>(def->easeSkew),
+			s_cast<Uint8>(def->easeOpacity)});
+	}
+	_durations[animation] = std::max(_durations[animation], time);
+}
+
+void ModelTracks::addFrames(Uint32 part, int animation, FrameActionDef* def, float delay)
+{
+	if (!def || def->rects.empty()) return;
+	Track& track = ModelTracks::getTrack(part, animation);
+	track.frames = def;
+	track.delay = delay;
+	track.texture = def->getTexture();
+	_resources.push_back(def);
+	if (track.texture) _resources.push_back(track.texture);
+	_durations[animation] = std::max(_durations[animation], delay + def->duration);
+}
+
+void ModelTracks::evaluate(int animation, float time, Pose* poses) const
+{
+	Uint32 partCount = s_cast<Uint32>(_parts.size());
+	for (Uint32 i = 0; i < partCount; i++)
+	{
+		poses[i] = _parts[i].pose;
+	}
+	if (animation < 0 || animation >= s_cast<int>(_animationCount))
+	{
+		return;
+	}
+	const Track* tracks = &_tracks[animation * partCount];
+	for (Uint32 i = 0; i < partCount; i++)
+	{
+		const Track& track = tracks[i];
+		Pose& pose = poses[i];
+		if (track.keyCount > 0)
+		{
+			const Key* keys = &_keys[track.firstKey];
+			Uint32 next = 1;
+			while (next < track.keyCount && keys[next].time <= time) next++;
+			const Key& last = keys[next - 1];
+			pose.visible = last.visible;
+			if (next == track.keyCount)
+			{
+				pose.x = last.x; pose.y = last.y;
+				pose.scaleX = last.scaleX; pose.scaleY = last.scaleY;
+				pose.rotation = last.rotation;
+				pose.skewX = last.skewX; pose.skewY = last.skewY;
+				pose.opacity = last.opacity;
+			}
+			else
+			{
+				// values move toward the next key with its easing while visibility switches when it is reached
+				const Key& key = keys[next];
+				float duration = key.time - last.time;
+				float t = duration > 0.0f ? std::max(time - last.time, 0.0f) / duration : 1.0f;
+				float p = Ease::func(s_cast<Ease::Enum>(key.easePos), t);
+				pose.x = last.x + (key.x - last.x) * p;
+				pose.y = last.y + (key.y - last.y) * p;
+				p = Ease::func(s_cast<Ease::Enum>(key.easeScale), t);
+				pose.scaleX = last.scaleX + (key.scaleX - last.scaleX) * p;
+				pose.scaleY = last.scaleY + (key.scaleY - last.scaleY) * p;
+				p = Ease::func(s_cast<Ease::Enum>(key.easeRotation), t);
+				pose.rotation = last.rotation + (key.rotation - last.rotation) * p;
+				p = Ease::func(s_cast<Ease::Enum>(key.easeSkew), t);
+				pose.skewX = last.skewX + (key.skewX - last.skewX) * p;
+				pose.skewY = last.skewY + (key.skewY - last.skewY) * p;
+				p = Ease::func(s_cast<Ease::Enum>(key.easeOpacity), t);
+				pose.opacity = last.opacity + (key.opacity - last.opacity) * p;
+			}
+		}
+		else if (track.frames && time >= track.delay)
+		{
+			const vector<Rect>& rects = track.frames->rects;
+			int frames = s_cast<int>(rects.size());
+			float t = (time - track.delay) / std::max(track.frames->duration, FLT_EPSILON);
+			int current = std::min(s_cast<int>(t * frames + 0.5f), frames - 1);
+			pose.rect = &rects[current];
+			pose.texture = track.texture;
+		}
+	}
+}
+
 /* ModelDef */
 
 ModelDef::ModelDef():
 _isFaceRight(false)
 { }
 
-ModelDef::ModelDef(
-	bool isFaceRight,
-	const Size& size,
-	String clipFile,
-	Own<SpriteDef>&& root,
-	const unordered_map<string,Vec2>& keys,
-	const unordered_map<string,int>& animationIndex,
-	const unordered_map<string,int>& lookIndex):
-_clip(clipFile),
-_isFaceRight(isFaceRight),
-_size(size),
-_keys(keys),
-_animationIndex(animationIndex),
-_lookIndex(lookIndex),
-_root(std::move(root))
-{ }
-
 const string& ModelDef::getClipFile() const
 {
 	return _clip;
 }
 
-void ModelDef::setRoot(Own<SpriteDef>&& root )
-{
-	_root = std::move(root);
-}
-
 SpriteDef* ModelDef::getRoot()
 {
-	return _root;
+	return _spriteDefs.empty() ? nullptr : &_spriteDefs.front();
 }
 
 string ModelDef::toXml()
@@ -200,7 +430,11 @@ string ModelDef::toXml()
 		writer << char(Xml::Model::Dorothy::Size) << '=';
 		writer.write("\"%d,%d\"", s_cast<int>(_size.width), s_cast<int>(_size.height));
 	}
-	writer << '>' << _root->toXml();
+	writer << '>';
+	if (!_spriteDefs.empty())
+	{
+		writer << _spriteDefs.front().toXml();
+	}
 	for (const auto& item: _animationIndex)
 	{
 		writer << '<' << char(Xml::Model::Element::AnimationName) << ' '
@@ -225,6 +459,44 @@ string ModelDef::toXml()
 	return writer.str();
 }
 
+string ModelDef::toBinary()
+{
+	BinaryWriter writer('M', 2);
+	writer.write(Slice(_clip).getFileName());
+	writer.write(s_cast<Uint8>(_isFaceRight ? 1 : 0));
+	writer.write(_size.width);
+	writer.write(_size.height);
+	// sizes of the define arrays go first for a reader to allocate them at once
+	writer.write(s_cast<Uint32>(_spriteDefs.size()));
+	writer.write(s_cast<Uint32>(_keyAnimationDefs.size()));
+	writer.write(s_cast<Uint32>(_frameAnimationDefs.size()));
+	writer.write(s_cast<Uint32>(_keyFrameDefs.size()));
+	if (!_spriteDefs.empty())
+	{
+		_spriteDefs.front().toBinary(writer);
+	}
+	writer.write(s_cast<Uint32>(_animationIndex.size()));
+	for (const auto& item : _animationIndex)
+	{
+		writer.write(item.first);
+		writer.write(item.second);
+	}
+	writer.write(s_cast<Uint32>(_lookIndex.size()));
+	for (const auto& item : _lookIndex)
+	{
+		writer.write(item.first);
+		writer.write(item.second);
+	}
+	writer.write(s_cast<Uint32>(_keys.size()));
+	for (const auto& item : _keys)
+	{
+		writer.write(item.first);
+		writer.write(item.second.x);
+		writer.write(item.second.y);
+	}
+	return writer.getData();
+}
+
 bool ModelDef::isFaceRight() const
 {
 	return _isFaceRight;
@@ -330,6 +602,15 @@ vector<string> ModelDef::getAnimationNames() const
 	return names;
 }
 
+ModelTracks* ModelDef::getTracks()
+{
+	if (!_tracks)
+	{
+		_tracks = New<ModelTracks>(this);
+	}
+	return _tracks;
+}
+
 string ModelDef::getTextureFile() const
 {
 	return SharedClipCache.load(_clip)->textureFile;
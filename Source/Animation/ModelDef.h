@@ -9,6 +9,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #pragma once
 
 #include "Support/Geometry.h"
+#include "Animation/Animation.h"
 
 NS_DOROTHY_BEGIN
 
@@ -19,6 +20,10 @@ class ActionDuration;
 class Sprite;
 class ClipDef;
 class Node;
+class Texture2D;
+class FrameActionDef;
+class KeyFrameDef;
+class BinaryWriter;
 
 class SpriteDef
 {
@@ -37,8 +42,10 @@ public:
 	string name;
 	string clip;
 
-	OwnVector<SpriteDef> children;
-	OwnVector<AnimationDef> animationDefs;
+	/* children and animations are not owned,
+	 they are stored in the contiguous define arrays of a ModelDef */
+	vector<SpriteDef*> children;
+	vector<AnimationDef*> animationDefs;
 	vector<int> looks;
 
 	SpriteDef();
@@ -52,6 +59,7 @@ public:
 	std::tuple<Action*,ResetAction*> toResetAction();
 	Sprite* toSprite(ClipDef* clipDef);
 	string toXml();
+	void toBinary(BinaryWriter& writer);
 
 	void restoreResetAnimation(Node* target, ActionDuration* action);
 
@@ -59,7 +67,7 @@ public:
 	static void traverse(SpriteDef* root, const NodeFunc& func)
 	{
 		func(root);
-		const OwnVector<SpriteDef>& childrenDef = root->children;
+		const vector<SpriteDef*>& childrenDef = root->children;
 		for (SpriteDef* childDef: childrenDef)
 		{
 			SpriteDef::traverse(childDef, func);
@@ -68,20 +76,97 @@ public:
 };
 
 class Model;
+class ModelDef;
 
-/** @brief Data define for a 2D model. */
+/** @brief Animations of a model baked into flat key frame arrays,
+ they are built once for a ModelDef and shared by all the instances of a ModelBatch.
+*/
+class ModelTracks
+{
+public:
+	struct Pose
+	{
+		float x;
+		float y;
+		float scaleX;
+		float scaleY;
+		float rotation;
+		float skewX;
+		float skewY;
+		float opacity;
+		bool visible;
+		const Rect* rect;
+		Texture2D* texture;
+	};
+	struct Key
+	{
+		float time;
+		float x;
+		float y;
+		float scaleX;
+		float scaleY;
+		float rotation;
+		float skewX;
+		float skewY;
+		float opacity;
+		bool visible;
+		Uint8 easePos;
+		Uint8 easeScale;
+		Uint8 easeRotation;
+		Uint8 easeSkew;
+		Uint8 easeOpacity;
+	};
+	struct Track
+	{
+		Uint32 firstKey;
+		Uint32 keyCount;
+		float delay;
+		FrameActionDef* frames;
+		Texture2D* texture;
+	};
+	struct Part
+	{
+		int parent;
+		Uint32 looks;
+		Vec2 anchorPoint;
+		Rect rect;
+		Pose pose;
+	};
+	ModelTracks(ModelDef* def);
+	PROPERTY_READONLY(Texture2D*, Texture);
+	PROPERTY_READONLY(Uint32, PartCount);
+	PROPERTY_READONLY(Uint32, AnimationCount);
+	/** @brief parts are stored with parents before their children. */
+	const Part& getPart(Uint32 index) const;
+	/** @brief part indices in the order they are drawn by a Model. */
+	const vector<Uint32>& getDrawOrder() const;
+	float getDuration(int animation) const;
+	/** @brief write the local pose of every part at the time of an animation,
+	 parts not animated keep the pose of their sprite defines. */
+	void evaluate(int animation, float time, Pose* poses) const;
+	void addKeys(Uint32 part, int animation, const KeyFrameDef* frames, Uint32 count);
+	void addFrames(Uint32 part, int animation, FrameActionDef* def, float delay);
+private:
+	vector<Uint32> addPart(SpriteDef* def, int parent, ClipDef* clipDef, vector<SpriteDef*>& spriteDefs);
+	Track& getTrack(Uint32 part, int animation);
+	Texture2D* _texture;
+	Uint32 _animationCount;
+	vector<Part> _parts;
+	vector<Uint32> _drawOrder;
+	vector<Key> _keys;
+	vector<Track> _tracks;
+	vector<float> _durations;
+	RefVector<Object> _resources;
+};
+
+/** @brief Data define for a 2D model.
+ The sprite, animation and key frame defines of a model are stored in contiguous arrays
+ with the root sprite coming first, they are filled by a ModelCache parser and never grow afterwards.
+*/
 class ModelDef : public Object
 {
 public:
 	ModelDef();
-	ModelDef(
-		bool isFaceRight,
-		const Size& size,
-		String clipFile,
-		Own<SpriteDef>&& root,
-		const unordered_map<string,Vec2>& keys,
-		const unordered_map<string,int>& animationIndex,
-		const unordered_map<string,int>& lookIndex);
 	const string& getClipFile() const;
 	SpriteDef* getRoot();
 	void addKeyPoint(String key, const Vec2& point);
@@ -99,13 +184,19 @@ public:
 	vector<string> getLookNames() const;
 	vector<string> getAnimationNames() const;
 	string getTextureFile() const;
+	/** @brief get the animations baked for instanced drawing, they are built on the first call. */
+	ModelTracks* getTracks();
 	string toXml();
+	string toBinary();
 	static ModelDef* create();
 private:
-	void setRoot(Own<SpriteDef>&& root);
+	Own<ModelTracks> _tracks;
 	bool _isFaceRight;
 	Size _size;
-	Own<SpriteDef> _root;
+	vector<SpriteDef> _spriteDefs;
+	vector<KeyAnimationDef> _keyAnimationDefs;
+	vector<FrameAnimationDef> _frameAnimationDefs;
+	vector<KeyFrameDef> _keyFrameDefs;
 	string _clip;
 	unordered_map<string,int> _animationIndex;
 	unordered_map<string,int> _lookIndex;
@@ -11,23 +11,142 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Cache/SoundCache.h"
 #include "Basic/Content.h"
 #include "Basic/Scheduler.h"
+#include "Basic/Application.h"
+#include "bx/timer.h"
 
 NS_DOROTHY_BEGIN
 
+/* PCMSource */
+class PCMInstance : public SoLoud::AudioSourceInstance
+{
+public:
+	PCMInstance(PCMSource* parent):
+	_parent(parent),
+	_offset(0)
+	{ }
+	virtual void getAudio(float* buffer, unsigned int samples) override
+	{
+		const Sint16* data = _parent->getData();
+		Uint32 sampleCount = _parent->getSampleCount();
+		if (!data || sampleCount == 0)
+		{
+			std::fill(buffer, buffer + samples * mChannels, 0.0f);
+			return;
+		}
+		const float scale = 1.0f / 32768.0f;
+		Uint32 written = 0;
+		while (written < samples)
+		{
+			Uint32 count = std::min(samples - written, sampleCount - std::min(_offset, sampleCount));
+			for (Uint32 i = 0; i < mChannels; i++)
+			{
+				const Sint16* src = data + i * sampleCount + _offset;
+				float* dst = buffer + i * samples + written;
+				for (Uint32 j = 0; j < count; j++)
+				{
+					dst[j] = src[j] * scale;
+				}
+			}
+			written += count;
+			_offset += count;
+			if (written < samples)
+			{
+				if (mFlags & AudioSourceInstance::LOOPING)
+				{
+					_offset = 0;
+					mLoopCount++;
+				}
+				else
+				{
+					for (Uint32 i = 0; i < mChannels; i++)
+					{
+						float* dst = buffer + i * samples + written;
+						std::fill(dst, dst + samples - written, 0.0f);
+					}
+					_offset += samples - written;
+					written = samples;
+				}
+			}
+		}
+	}
+	virtual SoLoud::result rewind() override
+	{
+		_offset = 0;
+		mStreamTime = 0;
+		return 0;
+	}
+	virtual bool hasEnded() override
+	{
+		return !(mFlags & AudioSourceInstance::LOOPING) && _offset >= _parent->getSampleCount();
+	}
+private:
+	PCMSource* _parent;
+	Uint32 _offset;
+};
+
+PCMSource::PCMSource():
+_sampleCount(0)
+{ }
+
+PCMSource::~PCMSource()
+{
+	stop();
+}
+
+Uint32 PCMSource::getSampleCount() const
+{
+	return _sampleCount;
+}
+
+const Sint16* PCMSource::getData() const
+{
+	return _data.empty() ? nullptr : &_data.front();
+}
+
+void PCMSource::load(const SoLoud::Wav& wav)
+{
+	stop();
+	mBaseSamplerate = wav.mBaseSamplerate;
+	mChannels = wav.mChannels;
+	_sampleCount = wav.mSampleCount;
+	size_t size = s_cast<size_t>(_sampleCount) * mChannels;
+	_data.resize(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		float sample = Math::clamp(wav.mData[i], -1.0f, 1.0f);
+		_data[i] = s_cast<Sint16>(std::round(sample * 32767.0f));
+	}
+}
+
+SoLoud::AudioSourceInstance* PCMSource::createInstance()
+{
+	return new PCMInstance(this);
+}
+
 /* SoundFile */
-SoLoud::Wav& SoundFile::getWav()
+PCMSource& SoundFile::getSource()
 {
-	return _wav;
+	return _source;
 }
 
 SoundFile::SoundFile(OwnArray<Uint8>&& data)
 {
-	SoLoud::result result = _wav.loadMem(data, s_cast<Uint32>(data.size()), false, false);
+	SoundFile::decode(data);
+}
+
+bool SoundFile::decode(const OwnArray<Uint8>& data)
+{
+	// decode into floats with a temporary wav and keep
+	// the samples as 16-bit PCM taking half of the memory
+	SoLoud::Wav wav;
+	SoLoud::result result = wav.loadMem(data.get(), s_cast<Uint32>(data.size()), false, false);
 	if (result)
 	{
 		Log("fail to load sound file due to reason: %s.", SharedAudio.getSoLoud().getErrorString(result));
-		return;
+		return false;
 	}
+	_source.load(wav);
+	return true;
 }
 
 /* SoundStream */
@@ -53,10 +172,50 @@ _data(std::move(data))
 
 /* Audio */
 Audio::Audio():
+_latencyBudget(0.1),
+_maxVoices(16),
+_deferredIndex(0),
 _currentVoice(0),
 _timer(Timer::create())
 { }
 
+void Audio::setLatencyBudget(double var)
+{
+	_latencyBudget = var;
+}
+
+double Audio::getLatencyBudget() const
+{
+	return _latencyBudget;
+}
+
+void Audio::setMaxVoices(Uint32 var)
+{
+	_maxVoices = var;
+}
+
+Uint32 Audio::getMaxVoices() const
+{
+	return _maxVoices;
+}
+
+Uint32 Audio::getVoiceCount()
+{
+	_voices.erase(std::remove_if(_voices.begin(), _voices.end(), [this](const Voice& voice)
+	{
+		return !_soloud.isValidVoiceHandle(voice.handle);
+	}), _voices.end());
+	for (auto it = _deferredHandles.begin(); it != _deferredHandles.end();)
+	{
+		if (it->second != 0 && !_soloud.isValidVoiceHandle(it->second))
+		{
+			it = _deferredHandles.erase(it);
+		}
+		else ++it;
+	}
+	return s_cast<Uint32>(_voices.size());
+}
+
 SoLoud::Soloud& Audio::getSoLoud()
 {
 	return _soloud;
@@ -69,7 +228,9 @@ Audio::~Audio()
 
 bool Audio::init()
 {
-	SoLoud::result result = _soloud.init();
+	// mix into nowhere when running without a device in headless mode
+	SoLoud::result result = SharedApplication.isHeadless() ?
+		_soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF, SoLoud::Soloud::NULLDRIVER) : _soloud.init();
 	if (result)
 	{
 		Log("fail to init soloud engine deal to reason: %s.", _soloud.getErrorString(result));
@@ -80,19 +241,119 @@ bool Audio::init()
 
 Uint32 Audio::play(String filename, bool loop)
 {
-	SoundFile* file = SharedSoundCache.load(filename);
+	string fullPath = SharedContent.getFullPath(filename);
+	SoundFile* file = SharedSoundCache.get(fullPath);
 	if (file)
 	{
-		SoLoud::handle handle = _soloud.play(file->getWav());
-		_soloud.setLooping(handle, loop);
-		_soloud.setInaudibleBehavior(handle, true, true);
-		return handle;
+		return Audio::play(fullPath, file, loop);
+	}
+	// the handle of a deferred voice is mapped to the real one once decoded,
+	// SoLoud voice handles never have all the low 12 bits set
+	_deferredIndex = (_deferredIndex + 1) % 0xfffff;
+	Uint32 deferred = (_deferredIndex << 12) | 0xfff;
+	_deferredHandles[deferred] = 0;
+	double requestTime = bx::getHPCounter() / s_cast<double>(bx::getHPFrequency());
+	SharedSoundCache.loadAsync(fullPath, [this, fullPath, loop, requestTime, deferred](SoundFile* file)
+	{
+		auto it = _deferredHandles.find(deferred);
+		if (it == _deferredHandles.end())
+		{
+			// stopped before being decoded
+			return;
+		}
+		double latency = bx::getHPCounter() / s_cast<double>(bx::getHPFrequency()) - requestTime;
+		if (!file || (!loop && _latencyBudget > 0.0 && latency > _latencyBudget))
+		{
+			// a late sound effect is worse than a missing one
+			_deferredHandles.erase(it);
+			return;
+		}
+		Uint32 handle = Audio::play(fullPath, file, loop);
+		if (handle == 0)
+		{
+			// dropped by the voice priority
+			_deferredHandles.erase(deferred);
+			return;
+		}
+		_deferredHandles[deferred] = handle;
+	});
+	return deferred;
+}
+
+Uint32 Audio::play(const string& name, SoundFile* file, bool loop)
+{
+	Uint32 maxInstances = 0;
+	int priority = 0;
+	auto limit = _limits.find(name);
+	if (limit != _limits.end())
+	{
+		maxInstances = limit->second.maxInstances;
+		priority = limit->second.priority;
+	}
+	Uint32 voiceCount = Audio::getVoiceCount();
+	Uint32 frame = SharedApplication.getFrame();
+	Uint32 instances = 0;
+	auto oldest = _voices.end();
+	for (auto it = _voices.begin(); it != _voices.end(); ++it)
+	{
+		if (it->name != name) continue;
+		if (it->frame == frame)
+		{
+			// the same sound triggered twice in a frame only gets louder and costs a voice
+			return it->handle;
+		}
+		if (instances++ == 0) oldest = it;
+	}
+	if (maxInstances > 0 && instances >= maxInstances)
+	{
+		_soloud.stop(oldest->handle);
+		_voices.erase(oldest);
+	}
+	else if (_maxVoices > 0 && voiceCount >= _maxVoices)
+	{
+		// voices are kept in the order they started, so the first found is the oldest
+		auto victim = _voices.begin();
+		for (auto it = _voices.begin(); it != _voices.end(); ++it)
+		{
+			if (it->priority < victim->priority) victim = it;
+		}
+		if (victim->priority > priority)
+		{
+			return 0;
+		}
+		_soloud.stop(victim->handle);
+		_voices.erase(victim);
+	}
+	SoLoud::handle handle = _soloud.play(file->getSource());
+	_soloud.setLooping(handle, loop);
+	_soloud.setInaudibleBehavior(handle, true, true);
+	_voices.push_back({name, handle, priority, frame});
+	return handle;
+}
+
+void Audio::setLimit(String filename, Uint32 maxInstances, int priority)
+{
+	string fullPath = SharedContent.getFullPath(filename);
+	if (maxInstances == 0 && priority == 0)
+	{
+		_limits.erase(fullPath);
+	}
+	else
+	{
+		_limits[fullPath] = {maxInstances, priority};
 	}
-	return 0;
 }
 
 void Audio::stop(Uint32 handle)
 {
+	auto it = _deferredHandles.find(handle);
+	if (it != _deferredHandles.end())
+	{
+		Uint32 voice = it->second;
+		_deferredHandles.erase(it);
+		if (voice != 0) _soloud.stop(voice);
+		return;
+	}
 	_soloud.stop(handle);
 }
 
@@ -145,4 +406,18 @@ void Audio::stopStream(float fadeTime)
 	_currentStream = nullptr;
 }
 
+double Audio::mixOffline(double duration)
+{
+	const Uint32 bufferSize = 512;
+	Uint32 channels = std::max(_soloud.getBackendChannels(), 1u);
+	Uint32 samples = s_cast<Uint32>(duration * _soloud.getBackendSamplerate());
+	vector<float> buffer(bufferSize * channels);
+	double startTime = SharedApplication.getEclapsedTime();
+	for (Uint32 mixed = 0; mixed < samples; mixed += bufferSize)
+	{
+		_soloud.mix(&buffer.front(), std::min(bufferSize, samples - mixed));
+	}
+	return SharedApplication.getEclapsedTime() - startTime;
+}
+
 NS_DOROTHY_END
@@ -16,15 +16,35 @@ NS_DOROTHY_BEGIN
 
 class Timer;
 
+/** @brief decoded samples kept as 16-bit PCM in planar channel blocks,
+ they are converted to float only while being mixed. */
+class PCMSource : public SoLoud::AudioSource
+{
+public:
+	PCMSource();
+	virtual ~PCMSource();
+	PROPERTY_READONLY(Uint32, SampleCount);
+	PROPERTY_READONLY(const Sint16*, Data);
+	void load(const SoLoud::Wav& wav);
+	virtual SoLoud::AudioSourceInstance* createInstance() override;
+private:
+	Uint32 _sampleCount;
+	vector<Sint16> _data;
+};
+
 class SoundFile : public Object
 {
 public:
-	PROPERTY_READONLY_CALL(SoLoud::Wav&, Wav);
+	PROPERTY_READONLY_CALL(PCMSource&, Source);
+	/** @brief decode wav or ogg data, it touches nothing but the source,
+	 so it can run in a worker before the file is shared. */
+	bool decode(const OwnArray<Uint8>& data);
 	CREATE_FUNC(SoundFile);
 protected:
+	SoundFile() { }
 	SoundFile(OwnArray<Uint8>&& data);
 private:
-	SoLoud::Wav _wav;
+	PCMSource _source;
 	DORA_TYPE_OVERRIDE(SoundFile);
 };
 
@@ -46,15 +66,52 @@ class Audio
 {
 public:
 	PROPERTY_READONLY_CALL(SoLoud::Soloud&, SoLoud);
+	/** @brief time in seconds a sound not in cache may take to be decoded before
+	 its voice is dropped instead of being started late, zero for never dropping.
+	 Looping sounds are always started. */
+	PROPERTY(double, LatencyBudget);
+	/** @brief the number of sound effects playing at the same time, a new one steals
+	 the voice of the lowest priority when it is reached, zero for no limit. */
+	PROPERTY(Uint32, MaxVoices);
+	PROPERTY_READONLY_CALL(Uint32, VoiceCount);
 	virtual ~Audio();
 	bool init();
+	/** @brief play a cached sound right away and return its voice handle,
+	 other sounds are decoded in workers and started later, their returned
+	 handles can still be stopped before or after the voices start. */
 	Uint32 play(String filename, bool loop = false);
+	/** @brief let a sound play with at most maxInstances voices, zero for no limit,
+	 its oldest voice is stopped for a new one. Voices of higher priority
+	 are the last to be stolen when MaxVoices is reached. */
+	void setLimit(String filename, Uint32 maxInstances, int priority = 0);
 	void stop(Uint32 handle);
 	void playStream(String filename, bool loop = false, float crossFadeTime = 0.0f);
 	void stopStream(float fadeTime = 0.0f);
+	/** @brief mix the given seconds of audio into a scratch buffer on the calling
+	 thread and return the time it took, for measuring the mixer with the null backend. */
+	double mixOffline(double duration);
 protected:
 	Audio();
+	Uint32 play(const string& name, SoundFile* file, bool loop);
 private:
+	struct Limit
+	{
+		Uint32 maxInstances;
+		int priority;
+	};
+	struct Voice
+	{
+		string name;
+		Uint32 handle;
+		int priority;
+		Uint32 frame;
+	};
+	double _latencyBudget;
+	Uint32 _maxVoices;
+	Uint32 _deferredIndex;
+	unordered_map<Uint32, Uint32> _deferredHandles;
+	vector<Voice> _voices;
+	unordered_map<string, Limit> _limits;
 	Ref<Timer> _timer;
 	Uint32 _currentVoice;
 	Ref<SoundStream> _lastStream;
@@ -11,18 +11,27 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Basic/AutoreleasePool.h"
 #include "Basic/Director.h"
 #include "bx/timer.h"
+#include "bx/os.h"
 #include <ctime>
+#include <cstring>
 
 #if BX_PLATFORM_ANDROID
 #include <jni.h>
 extern "C" ANativeWindow* Android_JNI_GetNativeWindow();
 #endif // BX_PLATFORM_ANDROID
 
+#if BX_PLATFORM_OSX || BX_PLATFORM_IOS
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif // BX_PLATFORM_OSX || BX_PLATFORM_IOS
+
 NS_DOROTHY_BEGIN
 
 bool BGFXDora::init()
 {
-	return bgfx::init();
+	return bgfx::init(SharedApplication.isHeadless() ?
+		bgfx::RendererType::Noop : bgfx::RendererType::Count);
 }
 
 BGFXDora::~BGFXDora()
@@ -32,7 +41,9 @@ BGFXDora::~BGFXDora()
 
 Application::Application():
 _fpsLimited(false),
+_headless(false),
 _frame(0),
+_seed(std::mt19937::default_seed),
 _width(800),
 _height(600),
 _maxFPS(60),
@@ -40,6 +51,13 @@ _minFPS(30),
 _deltaTime(0),
 _cpuTime(0),
 _totalTime(0),
+_ticksPerSecond(0),
+_sleepError(0),
+_frameTimeMean(0),
+_frameTimeP95(0),
+_frameTimeP99(0),
+_missedFrames(0),
+_maxTicks(0),
 _frequency(double(bx::getHPFrequency())),
 _sdlWindow(nullptr)
 {
@@ -122,6 +140,16 @@ SDL_Window* Application::getSDLWindow() const
 	return _sdlWindow;
 }
 
+double Application::getTicksPerSecond() const
+{
+	return _ticksPerSecond;
+}
+
+bool Application::isHeadless() const
+{
+	return _headless;
+}
+
 // This function runs in main thread, and do render work
 int Application::run()
 {
@@ -229,6 +257,18 @@ int Application::run()
 	return _logicThread.getExitCode();
 }
 
+// This function runs game logic in the calling thread with no window
+int Application::runHeadless(Uint32 maxTicks)
+{
+	_headless = true;
+
+	// call this function before bgfx init to run the Noop renderer in current thread
+	Application::renderFrame();
+
+	_maxTicks = maxTicks;
+	return Application::mainLogic(this);
+}
+
 void Application::updateDeltaTime()
 {
 	double currentTime = bx::getHPCounter() / _frequency;
@@ -274,6 +314,73 @@ double Application::getTotalTime() const
 	return _totalTime;
 }
 
+double Application::getFrameTimeMean() const
+{
+	return _frameTimeMean;
+}
+
+double Application::getFrameTimeP95() const
+{
+	return _frameTimeP95;
+}
+
+double Application::getFrameTimeP99() const
+{
+	return _frameTimeP99;
+}
+
+Uint32 Application::getMissedFrames() const
+{
+	return _missedFrames;
+}
+
+void Application::waitForNextFrame()
+{
+	double frameTime = 1.0/_maxFPS;
+	// sleep for most of the rest time, leaving a margin for the OS timer to oversleep
+	double margin = std::max(_sleepError, 0.001);
+	double restTime = frameTime - getEclapsedTime();
+	if (restTime > margin)
+	{
+		Uint32 sleepMs = s_cast<Uint32>((restTime - margin) * 1000.0);
+		if (sleepMs > 0)
+		{
+			double sleepStart = bx::getHPCounter() / _frequency;
+			bx::sleep(sleepMs);
+			double overSleep = bx::getHPCounter() / _frequency - sleepStart - sleepMs / 1000.0;
+			// keep the worst recent oversleep and let it decay slowly
+			_sleepError = std::min(std::max(overSleep, _sleepError * 0.95), frameTime * 0.5);
+		}
+	}
+	// spin wait for the final sub-millisecond
+	while (getEclapsedTime() < frameTime);
+	updateDeltaTime();
+}
+
+void Application::updateFrameStats()
+{
+	// frames exceeding the budget by more than one millisecond miss the deadline
+	if (_deltaTime > 1.0/_maxFPS + 0.001)
+	{
+		_missedFrames++;
+	}
+	_frameTimes.push_back(_deltaTime);
+	if (_frameTimes.size() >= _maxFPS)
+	{
+		double totalTime = 0;
+		for (double frameTime : _frameTimes)
+		{
+			totalTime += frameTime;
+		}
+		std::sort(_frameTimes.begin(), _frameTimes.end());
+		size_t last = _frameTimes.size() - 1;
+		_frameTimeMean = totalTime / _frameTimes.size();
+		_frameTimeP95 = _frameTimes[std::min(s_cast<size_t>(_frameTimes.size() * 0.95), last)];
+		_frameTimeP99 = _frameTimes[std::min(s_cast<size_t>(_frameTimes.size() * 0.99), last)];
+		_frameTimes.clear();
+	}
+}
+
 void Application::makeTimeNow()
 {
 	_totalTime += _deltaTime;
@@ -282,12 +389,25 @@ void Application::makeTimeNow()
 
 void Application::shutdown()
 {
-	_renderEvent.post("Quit"_slice);
+	if (_headless)
+	{
+		SDL_Event ev;
+		ev.quit.type = SDL_QUIT;
+		postEvent(ev);
+	}
+	else _renderEvent.post("Quit"_slice);
+}
+
+void Application::postEvent(const SDL_Event& event)
+{
+	_logicEvent.post("SDLEvent"_slice, event);
 }
 
 void Application::invokeInRender(const function<void()>& func)
 {
-	_renderEvent.post("Invoke"_slice, func);
+	// there is no render thread in headless mode
+	if (_headless) invokeInLogic(func);
+	else _renderEvent.post("Invoke"_slice, func);
 }
 
 void Application::invokeInLogic(const function<void()>& func)
@@ -316,7 +436,10 @@ int Application::mainLogic(void* userData)
 	app->_frame = bgfx::frame();
 
 	// Update and invoke render apis
-	app->updateDeltaTime();
+	if (app->_headless) app->_deltaTime = 1.0/app->_maxFPS;
+	else app->updateDeltaTime();
+	Uint32 ticks = 0;
+	double tickTime = 0.0;
 	bool running = true;
 	while (running)
 	{
@@ -364,16 +487,39 @@ int Application::mainLogic(void* userData)
 		// process submitted rendering primitives.
 		app->_frame = bgfx::frame();
 
-		// limit for max FPS
-		if (app->_fpsLimited)
+		// step lua collector in the time left before the next frame
+		double restTime = 0.0;
+		if (app->_fpsLimited && !app->_headless)
 		{
-			do
+			restTime = 1.0/app->_maxFPS - app->getEclapsedTime() - std::max(app->_sleepError, 0.001);
+		}
+		SharedDirector.collectGarbage(std::max(restTime, 0.0));
+
+		if (app->_headless)
+		{
+			// use fixed time step and measure ticks per second
+			tickTime += app->getEclapsedTime();
+			ticks++;
+			if (tickTime >= 1.0)
+			{
+				app->_ticksPerSecond = ticks / tickTime;
+				Log("headless logic runs at %.1f ticks per second.", app->_ticksPerSecond);
+				ticks = 0;
+				tickTime = 0.0;
+			}
+			if (app->_maxTicks > 0 && --app->_maxTicks == 0)
 			{
-				app->updateDeltaTime();
+				app->shutdown();
 			}
-			while (app->getDeltaTime() < 1.0/app->_maxFPS);
+			app->_deltaTime = 1.0/app->_maxFPS;
+		}
+		else
+		{
+			// limit for max FPS
+			if (app->_fpsLimited) app->waitForNextFrame();
+			else app->updateDeltaTime();
+			app->updateFrameStats();
 		}
-		else app->updateDeltaTime();
 		app->makeTimeNow();
 	}
 
@@ -403,6 +549,29 @@ const Slice Application::getPlatform() const
 #endif
 }
 
+double Application::getHeapSize() const
+{
+#if BX_PLATFORM_WINDOWS
+	double size = 0.0;
+	_HEAPINFO info;
+	info._pentry = nullptr;
+	while (_heapwalk(&info) == _HEAPOK)
+	{
+		if (info._useflag == _USEDENTRY) size += info._size;
+	}
+	return size;
+#elif BX_PLATFORM_OSX || BX_PLATFORM_IOS
+	malloc_statistics_t stats;
+	malloc_zone_statistics(nullptr, &stats);
+	return s_cast<double>(stats.size_in_use);
+#elif BX_PLATFORM_ANDROID || BX_PLATFORM_LINUX
+	struct mallinfo info = mallinfo();
+	return s_cast<double>(info.uordblks);
+#else
+	return 0.0;
+#endif
+}
+
 #if BX_PLATFORM_OSX || BX_PLATFORM_WINDOWS || BX_PLATFORM_ANDROID
 void Application::setupSdlWindow()
 {
@@ -428,6 +597,13 @@ NS_DOROTHY_END
 #if BX_PLATFORM_OSX || BX_PLATFORM_ANDROID || BX_PLATFORM_IOS
 int main(int argc, char *argv[])
 {
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--headless") == 0)
+		{
+			return SharedApplication.runHeadless();
+		}
+	}
 	return SharedApplication.run();
 }
 #endif // BX_PLATFORM_OSX || BX_PLATFORM_ANDROID || BX_PLATFORM_IOS
@@ -473,6 +649,10 @@ int CALLBACK WinMain(
 #if DORA_DEBUG
 	SharedConsole.init();
 #endif
+	if (std::strstr(lpCmdLine, "--headless"))
+	{
+		return SharedApplication.runHeadless();
+	}
 	return SharedApplication.run();
 }
 #endif // BX_PLATFORM_WINDOWS
@@ -30,18 +30,33 @@ public:
 	PROPERTY_READONLY(double, EclapsedTime);
 	PROPERTY_READONLY(double, CPUTime);
 	PROPERTY_READONLY(double, TotalTime);
+	PROPERTY_READONLY(double, FrameTimeMean);
+	PROPERTY_READONLY(double, FrameTimeP95);
+	PROPERTY_READONLY(double, FrameTimeP99);
+	PROPERTY_READONLY(Uint32, MissedFrames);
 	PROPERTY_READONLY(const Slice, Platform);
 	PROPERTY_READONLY_CALL(Uint32, Rand);
 	PROPERTY_READONLY(Uint32, RandMin);
 	PROPERTY_READONLY(Uint32, RandMax);
 	PROPERTY_READONLY(SDL_Window*, SDLWindow);
+	PROPERTY_READONLY(double, TicksPerSecond);
+	/** @brief bytes of heap memory in use by the process, 0 when not supported by the platform. */
+	PROPERTY_READONLY(double, HeapSize);
+	PROPERTY_READONLY_BOOL(Headless);
 	PROPERTY(Uint32, MaxFPS);
 	PROPERTY(Uint32, MinFPS);
 	PROPERTY(Uint32, Seed);
 	PROPERTY_BOOL(FPSLimited);
 	SDLEventHandler eventHandler;
 	int run();
+	/** @brief run game logic in current thread without window and GPU.
+	 Logic ticks use a fixed time step of 1/MaxFPS and run as fast as the CPU allows.
+	 @param maxTicks quit after the given ticks, 0 for running until shutdown.
+	 */
+	int runHeadless(Uint32 maxTicks = 0);
 	void shutdown();
+	/** @brief feed an SDL event to logic thread, used to replay recorded input. */
+	void postEvent(const SDL_Event& event);
 	void invokeInRender(const function<void()>& func);
 	void invokeInLogic(const function<void()>& func);
 	static int mainLogic(void* userData);
@@ -60,21 +75,32 @@ protected:
 	void updateDeltaTime();
 	void updateWindowSize();
 	void makeTimeNow();
+	void waitForNextFrame();
+	void updateFrameStats();
 	void setupSdlWindow();
 	bgfx::RenderFrame::Enum renderFrame();
 private:
 	bool _fpsLimited;
+	bool _headless;
 	int _width;
 	int _height;
 	Uint32 _seed;
 	Uint32 _maxFPS;
 	Uint32 _minFPS;
+	Uint32 _maxTicks;
 	uint32_t _frame;
 	const double _frequency;
 	double _lastTime;
 	double _deltaTime;
 	double _cpuTime;
 	double _totalTime;
+	double _ticksPerSecond;
+	double _sleepError;
+	double _frameTimeMean;
+	double _frameTimeP95;
+	double _frameTimeP99;
+	Uint32 _missedFrames;
+	vector<double> _frameTimes;
 	bx::Thread _logicThread;
 	EventQueue _logicEvent;
 	EventQueue _renderEvent;
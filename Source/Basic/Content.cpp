@@ -11,10 +11,17 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "FileSystem/mkdir.h"
 #include "FileSystem/tinydir.h"
 #include "Common/Async.h"
+#include "zlib.h"
 
 #include <fstream>
 using std::ofstream;
 
+#if !BX_PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // !BX_PLATFORM_WINDOWS
+
 #if BX_PLATFORM_WINDOWS
 #include <Shlobj.h>
 #endif // BX_PLATFORM_WINDOWS
@@ -37,6 +44,210 @@ static void releaseFileData(void* _ptr, void* _userData)
 
 NS_DOROTHY_BEGIN
 
+const char* Content::IndexFile = "assets.index";
+
+/* turn "a\\b/./c/../d/" into "a/b/d" keeping the case of the names */
+static string normalizePath(String path)
+{
+	vector<string> parts;
+	string part;
+	auto pushPart = [&]()
+	{
+		if (part == ".." && !parts.empty() && parts.back() != "..")
+		{
+			parts.pop_back();
+		}
+		else if (!part.empty() && part != ".")
+		{
+			parts.push_back(part);
+		}
+		part.clear();
+	};
+	for (size_t i = 0; i < path.size(); i++)
+	{
+		char ch = path[i];
+		if (ch == '/' || ch == '\\') pushPart();
+		else part += ch;
+	}
+	pushPart();
+	string key;
+	for (const string& item : parts)
+	{
+		if (!key.empty()) key += '/';
+		key += item;
+	}
+	return key;
+}
+
+/* keys of the asset index are normalized paths, they are lowercased where
+ the file system ignores case so that scripts spelling a path in another
+ case still find the file as they did before the index */
+static string getAssetKey(String path)
+{
+	string key = normalizePath(path);
+#if BX_PLATFORM_WINDOWS || BX_PLATFORM_OSX
+	for (char& ch : key)
+	{
+		ch = s_cast<char>(std::tolower(s_cast<unsigned char>(ch)));
+	}
+#endif // BX_PLATFORM_WINDOWS || BX_PLATFORM_OSX
+	return key;
+}
+
+/* paths going up out of the indexed folders are probed on disk */
+static bool isOutOfIndex(String path)
+{
+	string key = getAssetKey(path);
+	return key.size() >= 2 && key[0] == '.' && key[1] == '.';
+}
+
+/* Pack layout, all integers are little endian Uint32:
+ header: "DPAK" version count reserved
+ index: count entries of {nameOffset nameSize dataOffset packedSize size compression reserved reserved}
+ followed by the file names and the file data, offsets are from the beginning of the pack.
+ Data of files larger than a page starts at page boundaries, the others are 16 bytes aligned.
+ The pack is mapped once and never written, so reading it from many threads needs no lock. */
+class ContentPack
+{
+public:
+	static const Uint32 Version = 1;
+	enum
+	{
+		Stored = 0,
+		Deflated = 1
+	};
+	~ContentPack()
+	{
+#if !BX_PLATFORM_WINDOWS
+		if (_mapped)
+		{
+			munmap(_mapped, _size);
+		}
+#endif // !BX_PLATFORM_WINDOWS
+	}
+	bool load(const string& fullPath)
+	{
+		const Uint8* data = map(fullPath);
+		if (!data)
+		{
+			// packs in apk or on windows are read into memory once instead
+			Sint64 size = 0;
+			_buffer = OwnArray<Uint8>(SharedContent.loadFileUnsafe(fullPath, size), s_cast<size_t>(size));
+			data = _buffer.get();
+			_size = _buffer.size();
+		}
+		if (!data || _size < 16 || std::memcmp(data, "DPAK", 4) != 0 || readUint32(data + 4) != Version)
+		{
+			return false;
+		}
+		Uint32 count = readUint32(data + 8);
+		if (16 + s_cast<size_t>(count) * 32 > _size)
+		{
+			return false;
+		}
+		for (Uint32 i = 0; i < count; i++)
+		{
+			const Uint8* entry = data + 16 + i * 32;
+			Uint32 dataOffset = readUint32(entry + 8);
+			Uint32 packedSize = readUint32(entry + 12);
+			Uint32 compression = readUint32(entry + 20);
+			if (s_cast<size_t>(readUint32(entry)) + readUint32(entry + 4) > _size
+				|| s_cast<size_t>(dataOffset) + packedSize > _size
+				|| compression > Deflated)
+			{
+				return false;
+			}
+		}
+		_data = data;
+		_count = count;
+		_path = fullPath;
+		return true;
+	}
+	void index(unordered_map<string, Content::Asset>& assets) const
+	{
+		for (Uint32 i = 0; i < _count; i++)
+		{
+			const Uint8* entry = _data + 16 + i * 32;
+			string name(r_cast<const char*>(_data + readUint32(entry)), readUint32(entry + 4));
+			Sint64 offset = readUint32(entry + 8);
+			Sint64 packedSize = readUint32(entry + 12);
+			Sint64 size = readUint32(entry + 16);
+			assets.emplace(getAssetKey(name), Content::Asset{_path + '/' + name, size, offset, false, packedSize, this});
+			for (size_t pos = name.find('/'); pos != string::npos; pos = name.find('/', pos + 1))
+			{
+				string folder = name.substr(0, pos);
+				assets.emplace(getAssetKey(folder), Content::Asset{_path + '/' + folder, -1, 0, true, 0, this});
+			}
+		}
+	}
+	const string& getPath() const
+	{
+		return _path;
+	}
+	const Uint8* getData(const Content::Asset& asset) const
+	{
+		return _data + asset.offset;
+	}
+	Uint8* read(const Content::Asset& asset) const
+	{
+		Uint8* buffer = new Uint8[s_cast<size_t>(asset.size)];
+		if (asset.packedSize == asset.size)
+		{
+			std::memcpy(buffer, _data + asset.offset, s_cast<size_t>(asset.size));
+			return buffer;
+		}
+		uLongf size = s_cast<uLongf>(asset.size);
+		if (uncompress(buffer, &size, _data + asset.offset, s_cast<uLong>(asset.packedSize)) != Z_OK || size != s_cast<uLongf>(asset.size))
+		{
+			Log("fail to inflate \"%s\" from pack \"%s\".", asset.fullPath, _path);
+			delete [] buffer;
+			return nullptr;
+		}
+		return buffer;
+	}
+private:
+	static Uint32 readUint32(const Uint8* data)
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | (s_cast<Uint32>(data[3]) << 24);
+	}
+	const Uint8* map(const string& fullPath)
+	{
+#if !BX_PLATFORM_WINDOWS
+		int fd = open(fullPath.c_str(), O_RDONLY);
+		if (fd < 0) return nullptr;
+		struct stat info;
+		if (fstat(fd, &info) == 0 && info.st_size > 0)
+		{
+			void* mapped = mmap(nullptr, s_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped != MAP_FAILED)
+			{
+				_mapped = mapped;
+				_size = s_cast<size_t>(info.st_size);
+			}
+		}
+		close(fd);
+		return r_cast<const Uint8*>(_mapped);
+#else
+		return nullptr;
+#endif // !BX_PLATFORM_WINDOWS
+	}
+	void* _mapped = nullptr;
+	size_t _size = 0;
+	const Uint8* _data = nullptr;
+	Uint32 _count = 0;
+	string _path;
+	OwnArray<Uint8> _buffer;
+};
+
+/* the mounted packs and their entries, a table is built once when a pack
+ is mounted and then published, it is never changed so it is read without
+ locking, tables replaced by later mounts are kept until exit like the packs */
+struct Content::PackTable
+{
+	vector<const ContentPack*> packs;
+	unordered_map<string, Content::Asset> assets;
+};
+
 Content::~Content()
 { }
 
@@ -51,6 +262,11 @@ OwnArray<Uint8> Content::loadFile(String filename)
 
 const bgfx::Memory* Content::loadFileBX(String filename)
 {
+	Sint64 mappedSize = 0;
+	if (const Uint8* mapped = Content::mapFile(filename, mappedSize))
+	{
+		return bgfx::makeRef(mapped, s_cast<uint32_t>(mappedSize));
+	}
 	SharedAsyncThread.FileIO.pause();
 	Sint64 size = 0;
 	Uint8* data = Content::loadFileUnsafe(filename, size);
@@ -67,20 +283,43 @@ void Content::copyFile(String src, String dst)
 
 void Content::saveToFile(String filename, String content)
 {
-	ofstream stream(Content::getFullPath(filename), std::ios::trunc | std::ios::binary);
-	stream.write(content.rawData(), content.size());
+	string fullPath = Content::getFullPath(filename);
+	{
+		ofstream stream(fullPath, std::ios::trunc | std::ios::binary);
+		stream.write(content.rawData(), content.size());
+	}
+	Content::addToIndex(filename, fullPath, content.size());
 }
 
 void Content::saveToFile(String filename, Uint8* content, Sint64 size)
 {
-	ofstream stream(Content::getFullPath(filename), std::ios::trunc | std::ios::binary);
-	stream.write(r_cast<char*>(content), s_cast<std::streamsize>(size));
+	string fullPath = Content::getFullPath(filename);
+	{
+		ofstream stream(fullPath, std::ios::trunc | std::ios::binary);
+		stream.write(r_cast<char*>(content), s_cast<std::streamsize>(size));
+	}
+	Content::addToIndex(filename, fullPath, size);
+}
+
+void Content::addToIndex(String filename, const string& fullPath, Sint64 size, bool folder)
+{
+	if (!Content::isAbsolutePath(filename))
+	{
+		bx::MutexScope lock(_indexMutex);
+		_assets[getAssetKey(filename)] = {fullPath, size, 0, folder};
+	}
 }
 
 bool Content::removeFile(String filename)
 {
 	string fullpath = Content::getFullPath(filename);
-	return ::remove(fullpath.c_str()) == 0 || RMDIR(fullpath.c_str()) == 0;
+	bool removed = ::remove(fullpath.c_str()) == 0 || RMDIR(fullpath.c_str()) == 0;
+	if (removed && !Content::isAbsolutePath(filename))
+	{
+		bx::MutexScope lock(_indexMutex);
+		_assets.erase(getAssetKey(filename));
+	}
+	return removed;
 }
 
 bool Content::createFolder(String path)
@@ -114,6 +353,7 @@ bool Content::createFolder(String path)
 				{
 					return false;
 				}
+				Content::addToIndex(pszDir, pszDir, -1, true);
 			}
 			pszDir[i] = '/';
 		}
@@ -169,33 +409,271 @@ string Content::getFullPath(String filename)
 		return targetFile;
 	}
 
-	auto it  = _fullPathCache.find(targetFile);
-	if (it != _fullPathCache.end())
+	Asset asset;
+	if (Content::getAsset(targetFile, asset))
 	{
-		return it->second;
+		return asset.fullPath;
 	}
 
-	string path, file, fullPath;
-	for (const string& searchPath : _searchPaths)
+	if (isOutOfIndex(targetFile))
 	{
-		std::tie(path, file) = splitDirectoryAndFilename(searchPath + targetFile);
+		vector<string> searchPaths;
+		{
+			bx::MutexScope lock(_indexMutex);
+			searchPaths = _searchPaths;
+		}
+		string path, file, fullPath;
+		for (const string& searchPath : searchPaths)
+		{
+			std::tie(path, file) = splitDirectoryAndFilename(searchPath + targetFile);
+			fullPath = Content::getFullPathForDirectoryAndFilename(path, file);
+			if (!fullPath.empty())
+			{
+				return fullPath;
+			}
+		}
+		std::tie(path, file) = splitDirectoryAndFilename(targetFile);
 		fullPath = Content::getFullPathForDirectoryAndFilename(path, file);
 		if (!fullPath.empty())
 		{
-			_fullPathCache[targetFile] = fullPath;
 			return fullPath;
 		}
 	}
 
-	std::tie(path, file) = splitDirectoryAndFilename(targetFile);
-	fullPath = Content::getFullPathForDirectoryAndFilename(path, file);
-	if (!fullPath.empty())
+	return targetFile;
+}
+
+bool Content::getAsset(String filename, Asset& asset)
+{
+	string key = getAssetKey(filename);
+	if (const PackTable* table = _packTable.load(std::memory_order_acquire))
+	{
+		auto it = table->assets.find(key);
+		if (it != table->assets.end())
+		{
+			asset = it->second;
+			return true;
+		}
+	}
+	bx::MutexScope lock(_indexMutex);
+	if (_indexDirty)
 	{
-		_fullPathCache[targetFile] = fullPath;
-		return fullPath;
+		_indexDirty = false;
+		Content::buildIndex();
 	}
+	auto it = _assets.find(key);
+	if (it == _assets.end())
+	{
+		return false;
+	}
+	asset = it->second;
+	return true;
+}
 
-	return targetFile;
+bool Content::addPack(String filename)
+{
+	Own<ContentPack> pack = New<ContentPack>();
+	string fullPath = Content::getFullPath(filename);
+	if (!pack->load(fullPath))
+	{
+		Log("fail to load pack \"%s\".", filename);
+		return false;
+	}
+	bx::MutexScope lock(_indexMutex);
+	Own<PackTable> table = New<PackTable>();
+	if (const PackTable* current = _packTable.load(std::memory_order_relaxed))
+	{
+		*table = *current;
+	}
+	table->packs.push_back(pack.get());
+	pack->index(table->assets);
+	_packs.push_back(std::move(pack));
+	_packTable.store(table.get(), std::memory_order_release);
+	_packTables.push_back(std::move(table));
+	return true;
+}
+
+bool Content::getPackedAsset(String filename, Asset& asset)
+{
+	if (!Content::isAbsolutePath(filename))
+	{
+		const PackTable* table = _packTable.load(std::memory_order_acquire);
+		if (!table)
+		{
+			return false;
+		}
+		auto it = table->assets.find(getAssetKey(filename));
+		if (it == table->assets.end())
+		{
+			return false;
+		}
+		asset = it->second;
+		return true;
+	}
+	/* full paths of packed assets are "<pack full path>/<name in pack>" */
+	const PackTable* table = _packTable.load(std::memory_order_acquire);
+	if (!table)
+	{
+		return false;
+	}
+	string path = filename;
+	for (const ContentPack* pack : table->packs)
+	{
+		const string& packPath = pack->getPath();
+		if (path.size() > packPath.size() + 1
+			&& path.compare(0, packPath.size(), packPath) == 0
+			&& (path[packPath.size()] == '/' || path[packPath.size()] == '\\'))
+		{
+			auto it = table->assets.find(getAssetKey(path.substr(packPath.size() + 1)));
+			if (it != table->assets.end() && it->second.pack == pack)
+			{
+				asset = it->second;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+const Uint8* Content::mapFile(String filename, Sint64& size)
+{
+	Asset asset;
+	if (!Content::getPackedAsset(filename, asset) || asset.folder || asset.packedSize != asset.size)
+	{
+		return nullptr;
+	}
+	size = asset.size;
+	return asset.pack->getData(asset);
+}
+
+Uint8* Content::loadFromPack(String filename, Sint64& size)
+{
+	Asset asset;
+	if (!Content::getPackedAsset(filename, asset) || asset.folder)
+	{
+		return nullptr;
+	}
+	Uint8* data = asset.pack->read(asset);
+	if (data)
+	{
+		size = asset.size;
+	}
+	return data;
+}
+
+void Content::buildIndex()
+{
+	/* files in former search paths take precedence, then the asset path,
+	 files in mounted packs are looked up before them in the pack table */
+	_assets.clear();
+	for (const string& searchPath : _searchPaths)
+	{
+		if (!Content::loadIndexFile(searchPath))
+		{
+			Content::indexFolder(searchPath, Slice::Empty);
+		}
+	}
+	_assetPathIndexed = true;
+	if (!Content::loadIndexFile(_assetPath))
+	{
+#if BX_PLATFORM_WINDOWS
+		// the asset path is the working directory which may hold a whole drive,
+		// files under it are only indexed by an index file, or else probed on disk
+		_assetPathIndexed = false;
+#else
+		Content::indexFolder(_assetPath, Slice::Empty);
+#endif // BX_PLATFORM_WINDOWS
+	}
+}
+
+bool Content::loadIndexFile(const string& root)
+{
+	string filename = root + IndexFile;
+	if (!Content::isFileExist(filename))
+	{
+		return false;
+	}
+	Sint64 size = 0;
+	OwnArray<Uint8> data(Content::loadFileUnsafe(filename, size), s_cast<size_t>(size));
+	if (!data)
+	{
+		return false;
+	}
+	/* each line is "<size>\t<path>", with a trailing slash for folders */
+	const char* text = r_cast<const char*>(data.get());
+	const char* end = text + size;
+	while (text < end)
+	{
+		const char* lineEnd = std::find(text, end, '\n');
+		const char* tab = std::find(text, lineEnd, '\t');
+		if (tab != lineEnd)
+		{
+			string path(tab + 1, lineEnd);
+			if (!path.empty() && path.back() == '\r') path.pop_back();
+			bool folder = !path.empty() && path.back() == '/';
+			string name = normalizePath(path);
+			if (!name.empty())
+			{
+				Sint64 fileSize = std::strtoll(string(text, tab).c_str(), nullptr, 10);
+				_assets.emplace(getAssetKey(name), Asset{root + name, fileSize, 0, folder});
+			}
+		}
+		text = lineEnd + 1;
+	}
+	return true;
+}
+
+void Content::indexFolder(const string& root, const string& prefix)
+{
+	string folder = root + prefix;
+#if BX_PLATFORM_ANDROID
+	if (folder[0] != '/')
+	{
+		string path = folder;
+		if (!path.empty() && path.back() == '/') path.pop_back();
+		for (const string& file : g_apkFile->getDirEntries(path, false))
+		{
+			_assets.emplace(getAssetKey(prefix + file), Asset{folder + file, -1, 0, false});
+		}
+		for (const string& dir : g_apkFile->getDirEntries(path, true))
+		{
+			_assets.emplace(getAssetKey(prefix + dir), Asset{folder + dir, -1, 0, true});
+			Content::indexFolder(root, prefix + dir + '/');
+		}
+		return;
+	}
+#endif // BX_PLATFORM_ANDROID
+	tinydir_dir dir;
+	if (tinydir_open(&dir, folder.c_str()) != 0)
+	{
+		return;
+	}
+	vector<string> folders;
+	while (dir.has_next)
+	{
+		tinydir_file file;
+		tinydir_readfile(&dir, &file);
+		if (file.is_dir != 0)
+		{
+			if (std::strcmp(file.name, ".") != 0 && std::strcmp(file.name, "..") != 0)
+			{
+				folders.push_back(file.name);
+			}
+		}
+		else
+		{
+			struct stat buf;
+			Sint64 size = ::stat(file.path, &buf) == 0 ? s_cast<Sint64>(buf.st_size) : -1;
+			_assets.emplace(getAssetKey(prefix + file.name), Asset{folder + file.name, size, 0, false});
+		}
+		tinydir_next(&dir);
+	}
+	tinydir_close(&dir);
+	for (const string& name : folders)
+	{
+		_assets.emplace(getAssetKey(prefix + name), Asset{folder + name, -1, 0, true});
+		Content::indexFolder(root, prefix + name + '/');
+	}
 }
 
 void Content::insertSearchPath(int index, String path)
@@ -205,8 +683,9 @@ void Content::insertSearchPath(int index, String path)
 	{
 		searchPath.append("/");
 	}
+	bx::MutexScope lock(_indexMutex);
 	_searchPaths.insert(_searchPaths.begin() + index, searchPath);
-	_fullPathCache.clear();
+	_indexDirty = true;
 }
 
 void Content::addSearchPath(String path)
@@ -216,7 +695,9 @@ void Content::addSearchPath(String path)
 	{
 		searchPath.append("/");
 	}
+	bx::MutexScope lock(_indexMutex);
 	_searchPaths.push_back(searchPath);
+	_indexDirty = true;
 }
 
 void Content::removeSearchPath(String path)
@@ -226,12 +707,13 @@ void Content::removeSearchPath(String path)
 	{
 		realPath.append("/");
 	}
+	bx::MutexScope lock(_indexMutex);
 	for (auto it = _searchPaths.begin(); it != _searchPaths.end(); ++it)
 	{
 		if (*it == realPath)
 		{
 			_searchPaths.erase(it);
-			_fullPathCache.clear();
+			_indexDirty = true;
 			break;
 		}
 	}
@@ -239,8 +721,11 @@ void Content::removeSearchPath(String path)
 
 void Content::setSearchPaths(const vector<string>& searchPaths)
 {
-	_searchPaths.clear();
-	_fullPathCache.clear();
+	{
+		bx::MutexScope lock(_indexMutex);
+		_searchPaths.clear();
+		_indexDirty = true;
+	}
 	for (const string& searchPath : searchPaths)
 	{
 		Content::addSearchPath(searchPath);
@@ -255,6 +740,7 @@ void Content::copyFileUnsafe(String src, String dst)
 	if (Content::isFolder(srcPath))
 	{
 		string dstPath = dst;
+		Content::addToIndex(dstPath, dstPath, -1, true);
 		auto folders = Content::getDirEntries(src, true);
 		for (const string& folder : folders)
 		{
@@ -269,6 +755,7 @@ void Content::copyFileUnsafe(String src, String dst)
 						Log("Create folder failed! %s", dstFolder);
 					}
 				}
+				Content::addToIndex(dstFolder, dstFolder, -1, true);
 				Content::copyFileUnsafe((srcPath+'/'+folder), dstFolder);
 			}
 		}
@@ -276,26 +763,37 @@ void Content::copyFileUnsafe(String src, String dst)
 		for (const string& file : files)
 		{
 			// Log("now copy file %s",file);
-			ofstream stream((dstPath + '/' + file), std::ios::out | std::ios::trunc | std::ios::binary);
-			Content::loadFileByChunks((srcPath + '/' + file), [&](Uint8* buffer, int size)
+			string dstFile = dstPath + '/' + file;
+			Sint64 fileSize = 0;
 			{
-				if (!stream.write(r_cast<char*>(buffer), size))
+				ofstream stream(dstFile, std::ios::out | std::ios::trunc | std::ios::binary);
+				Content::loadFileByChunks((srcPath + '/' + file), [&](Uint8* buffer, int size)
 				{
-					Log("write file failed! %s", dstPath + '/' + file);
-				}
-			});
+					if (!stream.write(r_cast<char*>(buffer), size))
+					{
+						Log("write file failed! %s", dstFile);
+					}
+					fileSize += size;
+				});
+			}
+			Content::addToIndex(dstFile, dstFile, fileSize);
 		}
 	}
 	else
 	{
-		ofstream stream(dst, std::ios::out | std::ios::trunc | std::ios::binary);
-		Content::loadFileByChunks(src, [&](Uint8* buffer, int size)
+		Sint64 fileSize = 0;
 		{
-			if (!stream.write(r_cast<char*>(buffer), size))
+			ofstream stream(dst, std::ios::out | std::ios::trunc | std::ios::binary);
+			Content::loadFileByChunks(src, [&](Uint8* buffer, int size)
 			{
-				Log("write file failed! %s", dst);
-			}
-		});
+				if (!stream.write(r_cast<char*>(buffer), size))
+				{
+					Log("write file failed! %s", dst);
+				}
+				fileSize += size;
+			});
+		}
+		Content::addToIndex(dst, dst, fileSize);
 	}
 }
 
@@ -328,6 +826,12 @@ void Content::loadFileAsync(String filename, const function<void(String)>& callb
 
 void Content::loadFileAsyncBX(String filename, const function<void(const bgfx::Memory*)>& callback)
 {
+	Sint64 mappedSize = 0;
+	if (const Uint8* mapped = Content::mapFile(filename, mappedSize))
+	{
+		callback(bgfx::makeRef(mapped, s_cast<uint32_t>(mappedSize)));
+		return;
+	}
 	Content::loadFileAsyncUnsafe(filename, [callback](Uint8* buffer, Sint64 size)
 	{
 		callback(bgfx::makeRef(buffer, s_cast<uint32_t>(size), releaseFileData));
@@ -383,6 +887,23 @@ void Content::saveToFileAsync(String filename, OwnArray<Uint8> content, const fu
 
 bool Content::isExist(String filename)
 {
+	Asset asset;
+	if (!Content::isAbsolutePath(filename) && !isOutOfIndex(filename))
+	{
+		if (Content::getAsset(filename, asset))
+		{
+			return true;
+		}
+		bx::MutexScope lock(_indexMutex);
+		if (_assetPathIndexed)
+		{
+			return false;
+		}
+	}
+	if (Content::getPackedAsset(filename, asset))
+	{
+		return true;
+	}
 	return Content::isFileExist(Content::getFullPath(filename));
 }
 
@@ -429,7 +950,10 @@ vector<string> Content::getDirEntries(String path, bool isFolder)
 }
 
 #if BX_PLATFORM_ANDROID
-Content::Content()
+Content::Content():
+_indexDirty(true),
+_assetPathIndexed(true),
+_packTable(nullptr)
 {
 	_assetPath = "assets/";
 	g_apkFile = New<ZipFile>(getAndroidAPKPath(), _assetPath);
@@ -446,6 +970,11 @@ Uint8* Content::loadFileUnsafe(String filename, Sint64& size)
 	{
 		return data;
 	}
+	data = Content::loadFromPack(filename, size);
+	if (data)
+	{
+		return data;
+	}
 	string fullPath = Content::getFullPath(filename);
 	if (fullPath[0] != '/')
 	{
@@ -483,6 +1012,13 @@ void Content::loadFileByChunks(String filename, const std::function<void(Uint8*,
 	{
 		return;
 	}
+	Sint64 packedSize = 0;
+	OwnArray<Uint8> packed(Content::loadFromPack(filename, packedSize), s_cast<size_t>(packedSize));
+	if (packed)
+	{
+		handler(packed.get(), s_cast<int>(packedSize));
+		return;
+	}
 	string fullPath = Content::getFullPath(filename);
 	if (fullPath[0] != '/')
 	{
@@ -546,6 +1082,11 @@ bool Content::isFileExist(String strFilePath)
 
 bool Content::isFolder(String path)
 {
+	Asset asset;
+	if (Content::getPackedAsset(path, asset))
+	{
+		return asset.folder;
+	}
 	return g_apkFile->isFolder(path);
 }
 
@@ -564,7 +1105,10 @@ bool Content::isAbsolutePath(String strPath)
 #endif // BX_PLATFORM_ANDROID
 
 #if BX_PLATFORM_WINDOWS
-Content::Content()
+Content::Content():
+_indexDirty(true),
+_assetPathIndexed(true),
+_packTable(nullptr)
 {
 	char currentPath[MAX_PATH] = {0};
 	GetCurrentDirectory(sizeof(currentPath), currentPath);
@@ -598,7 +1142,10 @@ bool Content::isAbsolutePath(String strPath)
 #endif // BX_PLATFORM_WINDOWS
 
 #if BX_PLATFORM_OSX || BX_PLATFORM_IOS
-Content::Content()
+Content::Content():
+_indexDirty(true),
+_assetPathIndexed(true),
+_packTable(nullptr)
 {
 	char* currentPath = SDL_GetBasePath();
 	_assetPath = currentPath;
@@ -614,6 +1161,8 @@ Content::Content()
 Uint8* Content::loadFileUnsafe(String filename, Sint64& size)
 {
 	if (filename.empty()) return nullptr;
+	Uint8* data = Content::loadFromPack(filename, size);
+	if (data) return data;
 	string fullPath = Content::getFullPath(filename);
 	SDL_RWops* io = SDL_RWFromFile(fullPath.c_str(), "rb");
 	if (io == nullptr)
@@ -631,6 +1180,13 @@ Uint8* Content::loadFileUnsafe(String filename, Sint64& size)
 void Content::loadFileByChunks(String filename, const std::function<void(Uint8*,int)>& handler)
 {
 	if (filename.empty()) return;
+	Sint64 packedSize = 0;
+	OwnArray<Uint8> packed(Content::loadFromPack(filename, packedSize), s_cast<size_t>(packedSize));
+	if (packed)
+	{
+		handler(packed.get(), s_cast<int>(packedSize));
+		return;
+	}
 	string fullPath = Content::getFullPath(filename);
 	SDL_RWops* io = SDL_RWFromFile(fullPath.c_str(), "rb");
 	if (io == nullptr)
@@ -649,6 +1205,11 @@ void Content::loadFileByChunks(String filename, const std::function<void(Uint8*,
 
 bool Content::isFolder(String path)
 {
+	Asset asset;
+	if (Content::getPackedAsset(path, asset))
+	{
+		return asset.folder;
+	}
 	struct stat buf;
 	if (::stat(path.toString().c_str(), &buf) == 0)
 	{
@@ -10,9 +10,23 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 NS_DOROTHY_BEGIN
 
+class ContentPack;
+
 class Content
 {
 public:
+	/** @brief an indexed file or folder found in packs or under the search paths,
+	 entries from packs are stored from offset with packedSize bytes in the pack
+	 and get "<pack full path>/<name>" as full path, which only Content can open. */
+	struct Asset
+	{
+		string fullPath;
+		Sint64 size;
+		Sint64 offset;
+		bool folder;
+		Sint64 packedSize;
+		const ContentPack* pack;
+	};
 	PROPERTY_READONLY_REF(string, AssetPath);
 	PROPERTY_READONLY_REF(string, WritablePath);
 	virtual ~Content();
@@ -20,6 +34,19 @@ public:
 	bool isFolder(String path);
     bool isAbsolutePath(String strPath);
 	string getFullPath(String filename);
+	/** @brief look up a path relative to the search paths in the asset index
+	 without touching the file system, it is safe to call from worker threads. */
+	bool getAsset(String filename, Asset& asset);
+	/** @brief an optional index generated by Tools/AssetIndex and placed under a
+	 search path, the search path is scanned when it is missing. */
+	static const char* IndexFile;
+	/** @brief mount a pack built by Tools/ContentPack, files in packs are found
+	 before the ones in search paths, mounted packs are kept until exit.
+	 Packed files are looked up without locking from any thread. */
+	bool addPack(String filename);
+	/** @brief get data of a file stored uncompressed in a mounted pack without copying,
+	 returns nullptr for other files. It is safe to call from worker threads. */
+	const Uint8* mapFile(String filename, Sint64& size);
 	OwnArray<Uint8> loadFile(String filename);
 	const bgfx::Memory* loadFileBX(String filename);
 	void copyFile(String src, String dst);
@@ -50,11 +77,26 @@ protected:
 	void saveToFileUnsafe(String filename, Uint8* content, Sint64 size);
 	bool isFileExist(String filePath);
 	vector<string> getDirEntries(String path, bool isFolder);
+	void buildIndex();
+	bool loadIndexFile(const string& root);
+	void indexFolder(const string& root, const string& prefix);
+	void addToIndex(String filename, const string& fullPath, Sint64 size, bool folder = false);
+	/** @brief find an entry of a mounted pack by a relative path or by the
+	 "<pack full path>/<name>" full path given to packed assets. */
+	bool getPackedAsset(String filename, Asset& asset);
+	Uint8* loadFromPack(String filename, Sint64& size);
 private:
 	string _assetPath;
 	string _writablePath;
 	vector<string> _searchPaths;
-	unordered_map<string, string> _fullPathCache;
+	bool _indexDirty;
+	bool _assetPathIndexed;
+	bx::Mutex _indexMutex;
+	unordered_map<string, Asset> _assets;
+	struct PackTable;
+	std::atomic<const PackTable*> _packTable;
+	vector<Own<PackTable>> _packTables;
+	vector<Own<ContentPack>> _packs;
 	DORA_TYPE(Content);
 	SINGLETON_REF(Content, Application);
 };
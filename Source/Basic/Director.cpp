@@ -11,6 +11,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Basic/Camera.h"
 #include "Basic/Scheduler.h"
 #include "Node/Node.h"
+#include "Node/Label.h"
+#include "font/font_manager.h"
 #include "Basic/Application.h"
 #include "Basic/Content.h"
 #include "Basic/Renderer.h"
@@ -29,7 +31,12 @@ _systemScheduler(Scheduler::create()),
 _entryStack(Array::create()),
 _camera(Camera2D::create("Default"_slice)),
 _clearColor(0xff1a1a1a),
-_displayStats(false)
+_displayStats(false),
+_updateTime(0),
+_touchTime(0),
+_visitTime(0),
+_gcBudget(0.002),
+_gcTime(0)
 { }
 
 Director::~Director()
@@ -122,18 +129,6 @@ const float* Director::getViewProjection() const
 	return *_viewProjs.top();
 }
 
-void registerTouchHandler(Node* target)
-{
-	target->traverse([](Node* node)
-	{
-		if (node->isTouchEnabled())
-		{
-			SharedTouchDispatcher.add(node->getTouchHandler());
-		}
-		return false;
-	});
-}
-
 bool Director::init()
 {
 	SharedView.reset();
@@ -145,6 +140,7 @@ bool Director::init()
 	{
 		return false;
 	}
+	SharedLueEngine.setManualGC(_gcBudget > 0.0);
 	if (SharedContent.isExist("Script/main.lua"_slice))
 	{
 		SharedLueEngine.executeScriptFile("Script/main.lua"_slice);
@@ -152,6 +148,53 @@ bool Director::init()
 	return true;
 }
 
+double Director::getUpdateTime() const
+{
+	return _updateTime;
+}
+
+double Director::getTouchTime() const
+{
+	return _touchTime;
+}
+
+double Director::getVisitTime() const
+{
+	return _visitTime;
+}
+
+inline double getHPTime()
+{
+	return bx::getHPCounter() / s_cast<double>(bx::getHPFrequency());
+}
+
+void Director::setGCBudget(double var)
+{
+	_gcBudget = std::max(var, 0.0);
+	SharedLueEngine.setManualGC(_gcBudget > 0.0);
+}
+
+double Director::getGCBudget() const
+{
+	return _gcBudget;
+}
+
+double Director::getGCTime() const
+{
+	return _gcTime;
+}
+
+void Director::collectGarbage(double restTime)
+{
+	if (_gcBudget > 0.0)
+	{
+		double time = getHPTime();
+		SharedLueEngine.stepGC(std::min(restTime, _gcBudget));
+		_gcTime = getHPTime() - time;
+	}
+	else _gcTime = 0.0;
+}
+
 void Director::mainLoop()
 {
 	/* push default view projection */
@@ -160,13 +203,16 @@ void Director::mainLoop()
 	pushViewProjection(*viewProj, [&]()
 	{
 		/* update logic */
+		double time = getHPTime();
 		_systemScheduler->update(getDeltaTime());
 
 		SharedImGUI.begin();
 		_scheduler->update(getDeltaTime());
 		SharedImGUI.end();
+		_updateTime = getHPTime() - time;
 
 		/* handle touches */
+		time = getHPTime();
 		SharedTouchDispatcher.add(SharedImGUI.getTarget());
 		SharedTouchDispatcher.dispatch();
 		Matrix ortho;
@@ -174,34 +220,37 @@ void Director::mainLoop()
 			0, s_cast<float>(SharedApplication.getHeight()), -1000.0f, 1000.0f);
 		if (_ui)
 		{
-			registerTouchHandler(_ui);
-			pushViewProjection(ortho, []()
+			pushViewProjection(ortho, [&]()
 			{
-				SharedTouchDispatcher.dispatch();
+				SharedTouchDispatcher.dispatch(_ui);
 			});
 		}
 		Node* currentEntry = nullptr;
 		if (!_entryStack->isEmpty())
 		{
 			currentEntry = _entryStack->getLast().to<Node>();
-			registerTouchHandler(currentEntry);
-			SharedTouchDispatcher.dispatch();
+			SharedTouchDispatcher.dispatch(currentEntry);
 		}
 		SharedTouchDispatcher.clearEvents();
+		_touchTime = getHPTime() - time;
 
 		/* render scene tree */
+		time = getHPTime();
+		SharedRendererManager.beginFrame();
 		SharedView.pushName("Main"_slice, [&]()
 		{
 			Uint8 viewId = SharedView.getId();
 			bgfx::setViewClear(viewId,
 				BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH | BGFX_CLEAR_STENCIL,
 				_clearColor.toRGBA());
-			if (currentEntry)
+			bgfx::setViewTransform(viewId, nullptr, getViewProjection());
+			SharedRendererManager.renderStage([&]()
 			{
-				bgfx::setViewTransform(viewId, nullptr, getViewProjection());
-				currentEntry->visit();
-				SharedRendererManager.flush();
-			}
+				if (currentEntry)
+				{
+					currentEntry->visit();
+				}
+			});
 		});
 		
 		/* render ui nodes */
@@ -210,12 +259,14 @@ void Director::mainLoop()
 			Uint8 viewId = SharedView.getId();
 			pushViewProjection(ortho, [&]()
 			{
-				if (_ui)
+				bgfx::setViewTransform(viewId, nullptr, getViewProjection());
+				SharedRendererManager.renderStage([&]()
 				{
-					bgfx::setViewTransform(viewId, nullptr, getViewProjection());
-					_ui->visit();
-					SharedRendererManager.flush();
-				}
+					if (_ui)
+					{
+						_ui->visit();
+					}
+				});
 				if (_displayStats)
 				{
 					displayStats();
@@ -223,6 +274,12 @@ void Director::mainLoop()
 			});
 		});
 
+		SharedRendererManager.endFrame();
+		_visitTime = getHPTime() - time;
+
+		/* upload glyphs added in this frame */
+		SharedFontManager.commit();
+
 		/* render imgui */
 		SharedImGUI.render();
 		SharedView.clear();
@@ -269,9 +326,16 @@ void Director::displayStats()
 		frames = 0;
 		cpuTime = gpuTime = deltaTime = 0.0;
 	}
-	bgfx::dbgTextPrintf(dbgViewId, 8, 0x0f, "\x1b[14;mC++ Object: \x1b[15;m%d", Object::getObjectCount());
-	bgfx::dbgTextPrintf(dbgViewId, 9, 0x0f, "\x1b[14;mLua Object: \x1b[15;m%d", Object::getLuaRefCount());
-	bgfx::dbgTextPrintf(dbgViewId, 10, 0x0f, "\x1b[14;mCallback: \x1b[15;m%d", Object::getLuaCallbackCount());
+	bgfx::dbgTextPrintf(dbgViewId, 8, 0x0f, "\x1b[14;mFrame time: \x1b[15;m%.1f / %.1f / %.1f ms", 1000.0 * SharedApplication.getFrameTimeMean(), 1000.0 * SharedApplication.getFrameTimeP95(), 1000.0 * SharedApplication.getFrameTimeP99());
+	bgfx::dbgTextPrintf(dbgViewId, 9, 0x0f, "\x1b[14;mMissed frames: \x1b[15;m%d", SharedApplication.getMissedFrames());
+	bgfx::dbgTextPrintf(dbgViewId, 10, 0x0f, "\x1b[14;mUpdate / Touch / Visit: \x1b[15;m%.2f / %.2f / %.2f ms", 1000.0 * _updateTime, 1000.0 * _touchTime, 1000.0 * _visitTime);
+	bgfx::dbgTextPrintf(dbgViewId, 11, 0x0f, "\x1b[14;mSubmit / Build / Wait: \x1b[15;m%.2f / %.2f / %.2f ms", 1000.0 * SharedRendererManager.getSubmitTime(), 1000.0 * SharedRendererManager.getBuildTime(), 1000.0 * SharedRendererManager.getWaitTime());
+	bgfx::dbgTextPrintf(dbgViewId, 12, 0x0f, "\x1b[14;mC++ Object: \x1b[15;m%d", Object::getObjectCount());
+	bgfx::dbgTextPrintf(dbgViewId, 13, 0x0f, "\x1b[14;mLua Object: \x1b[15;m%d", Object::getLuaRefCount());
+	bgfx::dbgTextPrintf(dbgViewId, 14, 0x0f, "\x1b[14;mCallback: \x1b[15;m%d", Object::getLuaCallbackCount());
+	bgfx::dbgTextPrintf(dbgViewId, 15, 0x0f, "\x1b[14;mLua GC / Memory: \x1b[15;m%.2f ms / %d KB", 1000.0 * _gcTime, SharedLueEngine.getMemory());
+	// a stencil clip draws its stencil at least twice, to mark and then to clear
+	bgfx::dbgTextPrintf(dbgViewId, 16, 0x0f, "\x1b[14;mScissor Clips / Saved Draws: \x1b[15;m%d / %d", SharedRendererManager.getScissorCount(), 2 * SharedRendererManager.getScissorCount());
 }
 
 void Director::pushViewProjection(const float* viewProj)
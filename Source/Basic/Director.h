@@ -32,9 +32,19 @@ public:
 	PROPERTY_READONLY(Array*, Entries);
 	PROPERTY_READONLY(Node*, CurrentEntry);
 	PROPERTY_READONLY(const float*, ViewProjection);
+	PROPERTY_READONLY(double, UpdateTime);
+	PROPERTY_READONLY(double, TouchTime);
+	PROPERTY_READONLY(double, VisitTime);
+	/** @brief max time in seconds for the lua collector to run after each frame,
+	 set to zero to let lua collect garbage automatically. */
+	PROPERTY(double, GCBudget);
+	PROPERTY_READONLY(double, GCTime);
 	bool init();
 	void mainLoop();
 	void handleSDLEvent(const SDL_Event& event);
+	/** @brief run the lua collector incrementally within the rest time of
+	 the frame and the budget, called after the frame is submitted. */
+	void collectGarbage(double restTime);
 
 	void setEntry(Node* entry);
 	void pushEntry(Node* entry);
@@ -58,6 +68,11 @@ protected:
 	void popViewProjection();
 private:
 	bool _displayStats;
+	double _updateTime;
+	double _touchTime;
+	double _visitTime;
+	double _gcBudget;
+	double _gcTime;
 	Color _clearColor;
 	Ref<Node> _ui;
 	Ref<Array> _entryStack;
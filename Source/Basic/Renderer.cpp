@@ -8,9 +8,27 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include "Const/Header.h"
 #include "Basic/Renderer.h"
+#include "Basic/Director.h"
+#include "Basic/View.h"
+#include "bx/timer.h"
 
 NS_DOROTHY_BEGIN
 
+inline double getHPTime()
+{
+	return bx::getHPCounter() / s_cast<double>(bx::getHPFrequency());
+}
+
+static void setScissor(const Rect& scissor)
+{
+	if (scissor.size.width > 0.0f)
+	{
+		bgfx::setScissor(
+			s_cast<Uint16>(scissor.origin.x), s_cast<Uint16>(scissor.origin.y),
+			s_cast<Uint16>(scissor.size.width), s_cast<Uint16>(scissor.size.height));
+	}
+}
+
 void Renderer::render()
 {
 	Uint32 stencilState = SharedRendererManager.getCurrentStencilState();
@@ -18,12 +36,97 @@ void Renderer::render()
 	{
 		bgfx::setStencil(stencilState);
 	}
+	setScissor(SharedRendererManager.getCurrentScissor());
+}
+
+/* GeometryBuffer */
+
+GeometryBuffer::GeometryBuffer(const bgfx::VertexDecl& decl, const void* vertices, Uint32 vertexCount,
+	const Uint16* indices, Uint32 indexCount):
+_vertexBuffer(BGFX_INVALID_HANDLE),
+_indexBuffer(BGFX_INVALID_HANDLE),
+_vertexCount(vertexCount),
+_indexCount(indexCount)
+{
+	_vertexBuffer = bgfx::createVertexBuffer(bgfx::copy(vertices, decl.getSize(vertexCount)), decl);
+	if (indices && indexCount > 0)
+	{
+		_indexBuffer = bgfx::createIndexBuffer(bgfx::copy(indices, indexCount * sizeof(Uint16)));
+	}
 }
 
+GeometryBuffer::~GeometryBuffer()
+{
+	if (bgfx::isValid(_vertexBuffer))
+	{
+		bgfx::destroyVertexBuffer(_vertexBuffer);
+	}
+	if (bgfx::isValid(_indexBuffer))
+	{
+		bgfx::destroyIndexBuffer(_indexBuffer);
+	}
+}
+
+bgfx::VertexBufferHandle GeometryBuffer::getVertexBuffer() const
+{
+	return _vertexBuffer;
+}
+
+bgfx::IndexBufferHandle GeometryBuffer::getIndexBuffer() const
+{
+	return _indexBuffer;
+}
+
+Uint32 GeometryBuffer::getVertexCount() const
+{
+	return _vertexCount;
+}
+
+Uint32 GeometryBuffer::getIndexCount() const
+{
+	return _indexCount;
+}
+
+/* RenderCommand */
+
+RenderCommand::RenderCommand():
+decl(nullptr),
+vertexStart(0),
+vertexCount(0),
+indexStart(0),
+indexCount(0),
+transformStart(0),
+transformCount(0),
+stencil(BGFX_STENCIL_NONE),
+textureFlags(UINT32_MAX),
+state(BGFX_STATE_NONE),
+quadIndices(false),
+hasModelWorld(false),
+sampler(BGFX_INVALID_HANDLE)
+{ }
+
+/* RendererManager */
+
 RendererManager::RendererManager():
-_currentRenderer(nullptr)
+_currentRenderer(nullptr),
+_pipelined(false),
+_recording(false),
+_building(false),
+_stage(0),
+_scissorCount(0),
+_submitTime(0),
+_buildTime(0),
+_waitTime(0),
+_workerBuildTime(0),
+_recordList(&_lists[0]),
+_submitList(&_lists[1])
 { }
 
+RendererManager::~RendererManager()
+{
+	setPipelined(false);
+}
+
 void RendererManager::setCurrent(Renderer* var)
 {
 	if (_currentRenderer && _currentRenderer != var)
@@ -62,4 +165,336 @@ void RendererManager::popStencilState()
 	_stencilStates.pop();
 }
 
+const Rect& RendererManager::getCurrentScissor() const
+{
+	return _scissors.empty() ? Rect::zero : _scissors.top();
+}
+
+Size RendererManager::getViewportSize() const
+{
+	return _viewports.empty() ? SharedView.getSize() : _viewports.top();
+}
+
+Uint32 RendererManager::getScissorCount() const
+{
+	return _scissorCount;
+}
+
+void RendererManager::pushScissor(const Rect& scissor)
+{
+	flush();
+	_scissors.push(scissor);
+	if (scissor.size.width > 0.0f)
+	{
+		_scissorCount++;
+	}
+}
+
+void RendererManager::popScissor()
+{
+	flush();
+	_scissors.pop();
+}
+
+void RendererManager::setPipelined(bool var)
+{
+	if (var == _pipelined) return;
+	if (var)
+	{
+		_pipelined = true;
+		_worker.init(RendererManager::work, this);
+	}
+	else
+	{
+		waitForBuild();
+		_pipelined = false;
+		_buildSemaphore.post();
+		_worker.shutdown();
+		_lists[0].clear();
+		_lists[1].clear();
+	}
+}
+
+bool RendererManager::isPipelined() const
+{
+	return _pipelined;
+}
+
+bool RendererManager::isRecording() const
+{
+	return _recording;
+}
+
+double RendererManager::getSubmitTime() const
+{
+	return _submitTime;
+}
+
+double RendererManager::getBuildTime() const
+{
+	return _buildTime;
+}
+
+double RendererManager::getWaitTime() const
+{
+	return _waitTime;
+}
+
+void RendererManager::waitForBuild()
+{
+	if (_building)
+	{
+		_doneSemaphore.wait();
+		_building = false;
+		_buildTime = _workerBuildTime;
+	}
+}
+
+void RendererManager::beginFrame()
+{
+	_stage = 0;
+	_scissorCount = 0;
+	_submitTime = 0;
+	Effect::resetApplied();
+	double time = getHPTime();
+	waitForBuild();
+	_waitTime = getHPTime() - time;
+}
+
+void RendererManager::endFrame()
+{
+	if (_pipelined)
+	{
+		// commands from last frame are all submitted, start building the new ones
+		_submitList->clear();
+		std::swap(_recordList, _submitList);
+		_building = true;
+		_buildSemaphore.post();
+	}
+}
+
+void RendererManager::beginStage()
+{
+	if (!_pipelined) return;
+	flush();
+	double time = getHPTime();
+	const CommandList& list = *_submitList;
+	if (_stage < list.stages.size())
+	{
+		Uint32 start = _stage == 0 ? 0 : list.stages[_stage - 1];
+		Uint32 end = list.stages[_stage];
+		for (Uint32 i = start; i < end; i++)
+		{
+			submit(list, list.commands[i]);
+		}
+	}
+	_submitTime += getHPTime() - time;
+	_recording = true;
+}
+
+void RendererManager::endStage()
+{
+	if (!_pipelined) return;
+	_recording = false;
+	_recordList->stages.push_back(s_cast<Uint32>(_recordList->commands.size()));
+	_stage++;
+}
+
+Uint32 RendererManager::recordViewProjection(const float* viewProj)
+{
+	vector<Matrix>& viewProjs = _recordList->viewProjs;
+	if (viewProjs.empty() || std::memcmp(viewProjs.back().m, viewProj, sizeof(Matrix)) != 0)
+	{
+		viewProjs.push_back(*r_cast<const Matrix*>(viewProj));
+	}
+	return s_cast<Uint32>(viewProjs.size() - 1);
+}
+
+void RendererManager::record(RenderCommand& command, const void* vertices,
+	const Uint16* indices, const vector<RenderTransform>* transforms)
+{
+	CommandList& list = *_recordList;
+	if (command.stencil == BGFX_STENCIL_NONE)
+	{
+		command.stencil = getCurrentStencilState();
+	}
+	command.scissor = getCurrentScissor();
+	if (command.geometry)
+	{
+		list.commands.push_back(command);
+		return;
+	}
+	Uint32 vertexSize = command.decl->getSize(command.vertexCount);
+	command.vertexStart = s_cast<Uint32>(list.vertices.size());
+	list.vertices.resize(list.vertices.size() + vertexSize);
+	std::memcpy(&list.vertices[command.vertexStart], vertices, vertexSize);
+	if (command.quadIndices)
+	{
+		// indices are generated by the worker
+		command.indexCount = command.vertexCount / 4 * 6;
+		command.indexStart = s_cast<Uint32>(list.indices.size());
+		list.indices.resize(list.indices.size() + command.indexCount);
+	}
+	else if (indices)
+	{
+		command.indexStart = s_cast<Uint32>(list.indices.size());
+		list.indices.insert(list.indices.end(), indices, indices + command.indexCount);
+	}
+	if (transforms)
+	{
+		command.transformStart = s_cast<Uint32>(list.transforms.size());
+		command.transformCount = s_cast<Uint32>(transforms->size());
+		list.transforms.insert(list.transforms.end(), transforms->begin(), transforms->end());
+	}
+	list.commands.push_back(command);
+}
+
+void RendererManager::draw(GeometryBuffer* geometry, Effect* effect, Uint64 state, const float* world)
+{
+	flush();
+	RenderCommand command;
+	command.vertexCount = geometry->getVertexCount();
+	command.indexCount = geometry->getIndexCount();
+	command.state = state;
+	command.effect = effect;
+	command.geometry = geometry;
+	command.hasModelWorld = true;
+	command.modelWorld = *r_cast<const Matrix*>(world);
+	if (_recording)
+	{
+		record(command, nullptr);
+	}
+	else
+	{
+		command.stencil = getCurrentStencilState();
+		command.scissor = getCurrentScissor();
+		submit(*_recordList, command);
+	}
+}
+
+void RendererManager::submit(const CommandList& list, const RenderCommand& command)
+{
+	if (command.geometry)
+	{
+		bgfx::setVertexBuffer(command.geometry->getVertexBuffer());
+		if (bgfx::isValid(command.geometry->getIndexBuffer()))
+		{
+			bgfx::setIndexBuffer(command.geometry->getIndexBuffer());
+		}
+		if (command.stencil != BGFX_STENCIL_NONE)
+		{
+			bgfx::setStencil(command.stencil);
+		}
+		setScissor(command.scissor);
+		bgfx::setTransform(command.modelWorld);
+		bgfx::setState(command.state);
+		bgfx::submit(SharedView.getId(), command.effect->apply());
+		return;
+	}
+	bgfx::TransientVertexBuffer vertexBuffer;
+	bgfx::TransientIndexBuffer indexBuffer;
+	if (command.indexCount > 0)
+	{
+		if (!bgfx::allocTransientBuffers(
+			&vertexBuffer, *command.decl, command.vertexCount,
+			&indexBuffer, command.indexCount))
+		{
+			Log("not enough transient buffer for %d vertices, %d indices.", command.vertexCount, command.indexCount);
+			return;
+		}
+		std::memcpy(indexBuffer.data, &list.indices[command.indexStart], command.indexCount * sizeof(Uint16));
+		bgfx::setIndexBuffer(&indexBuffer);
+	}
+	else
+	{
+		if (bgfx::getAvailTransientVertexBuffer(command.vertexCount, *command.decl) < command.vertexCount)
+		{
+			Log("not enough transient buffer for %d vertices.", command.vertexCount);
+			return;
+		}
+		bgfx::allocTransientVertexBuffer(&vertexBuffer, command.vertexCount, *command.decl);
+	}
+	std::memcpy(vertexBuffer.data, &list.vertices[command.vertexStart], command.decl->getSize(command.vertexCount));
+	bgfx::setVertexBuffer(&vertexBuffer);
+	if (command.stencil != BGFX_STENCIL_NONE)
+	{
+		bgfx::setStencil(command.stencil);
+	}
+	setScissor(command.scissor);
+	if (command.hasModelWorld)
+	{
+		bgfx::setTransform(command.modelWorld);
+	}
+	if (command.texture)
+	{
+		bgfx::setTexture(0, command.sampler, command.texture->getHandle(), command.textureFlags);
+	}
+	bgfx::setState(command.state);
+	bgfx::submit(SharedView.getId(), command.effect->apply());
+}
+
+void RendererManager::CommandList::build()
+{
+	for (const RenderCommand& command : commands)
+	{
+		// static geometry is already on gpu
+		if (command.geometry) continue;
+		Uint16 stride = command.decl->getStride();
+		Uint8* data = &vertices[command.vertexStart];
+		// every vertex format starts with a Vec4 position
+		for (Uint32 i = 0; i < command.transformCount; i++)
+		{
+			const RenderTransform& transform = transforms[command.transformStart + i];
+			Matrix mvp;
+			bx::mtxMul(mvp, transform.world, viewProjs[transform.viewProj]);
+			for (Uint32 v = transform.start; v < transform.start + transform.count; v++)
+			{
+				float* pos = r_cast<float*>(data + v * stride);
+				Vec4 local = {pos[0], pos[1], pos[2], pos[3]};
+				bx::vec4MulMtx(pos, local, mvp);
+			}
+		}
+		if (command.quadIndices)
+		{
+			const Uint16 quadIndices[] = {0, 1, 2, 1, 3, 2};
+			Uint16* out = &indices[command.indexStart];
+			for (Uint32 i = 0; i < command.vertexCount / 4; i++)
+			{
+				for (Uint32 j = 0; j < 6; j++)
+				{
+					*out++ = s_cast<Uint16>(quadIndices[j] + i * 4);
+				}
+			}
+		}
+	}
+}
+
+void RendererManager::CommandList::clear()
+{
+	commands.clear();
+	stages.clear();
+	vertices.clear();
+	indices.clear();
+	transforms.clear();
+	viewProjs.clear();
+}
+
+int RendererManager::work(void* userData)
+{
+	RendererManager* manager = r_cast<RendererManager*>(userData);
+	while (true)
+	{
+		manager->_buildSemaphore.wait();
+		if (!manager->_pipelined)
+		{
+			return 0;
+		}
+		double time = getHPTime();
+		manager->_submitList->build();
+		manager->_workerBuildTime = getHPTime() - time;
+		manager->_doneSemaphore.post();
+	}
+	return 0;
+}
+
 NS_DOROTHY_END
@@ -9,6 +9,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #pragma once
 
 #include "Support/Geometry.h"
+#include "Effect/Effect.h"
+#include "Cache/TextureCache.h"
 
 NS_DOROTHY_BEGIN
 
@@ -18,12 +20,91 @@ public:
 	virtual void render();
 };
 
+/** @brief a vertex range in local space to be transformed by
+ world * viewProjection in the render worker. */
+struct RenderTransform
+{
+	Uint32 start;
+	Uint32 count;
+	Uint32 viewProj;
+	Matrix world;
+};
+
+/** @brief vertices and indices uploaded once into static gpu buffers,
+ retained by the render commands drawing them. */
+class GeometryBuffer : public Object
+{
+public:
+	virtual ~GeometryBuffer();
+	PROPERTY_READONLY(bgfx::VertexBufferHandle, VertexBuffer);
+	PROPERTY_READONLY(bgfx::IndexBufferHandle, IndexBuffer);
+	PROPERTY_READONLY(Uint32, VertexCount);
+	PROPERTY_READONLY(Uint32, IndexCount);
+	CREATE_FUNC(GeometryBuffer);
+protected:
+	GeometryBuffer(const bgfx::VertexDecl& decl, const void* vertices, Uint32 vertexCount,
+		const Uint16* indices = nullptr, Uint32 indexCount = 0);
+private:
+	bgfx::VertexBufferHandle _vertexBuffer;
+	bgfx::IndexBufferHandle _indexBuffer;
+	Uint32 _vertexCount;
+	Uint32 _indexCount;
+	DORA_TYPE_OVERRIDE(GeometryBuffer);
+};
+
+/** @brief a batched draw call recorded from node visits. */
+struct RenderCommand
+{
+	RenderCommand();
+	const bgfx::VertexDecl* decl;
+	Uint32 vertexStart;
+	Uint32 vertexCount;
+	Uint32 indexStart;
+	Uint32 indexCount;
+	Uint32 transformStart;
+	Uint32 transformCount;
+	Uint32 stencil;
+	Uint32 textureFlags;
+	Rect scissor;
+	Uint64 state;
+	bool quadIndices;
+	bool hasModelWorld;
+	Matrix modelWorld;
+	bgfx::UniformHandle sampler;
+	Ref<Effect> effect;
+	Ref<Texture2D> texture;
+	Ref<GeometryBuffer> geometry;
+};
+
 class RendererManager
 {
 public:
 	PROPERTY(Renderer*, Current);
 	PROPERTY_READONLY(Uint32, CurrentStencilState);
+	/** @brief scissor rect in pixels of current view, empty for no scissor. */
+	PROPERTY_READONLY_REF(Rect, CurrentScissor);
+	/** @brief pixel size of the frame buffer scissor rects are relative to. */
+	PROPERTY_READONLY(Size, ViewportSize);
+	/** @brief scissor rects pushed in current frame. */
+	PROPERTY_READONLY(Uint32, ScissorCount);
+	/** @brief when pipelined, node visits record render commands that
+	 are built in a worker thread while next logic tick runs and
+	 then get submitted in the next frame. */
+	PROPERTY_BOOL(Pipelined);
+	PROPERTY_READONLY_BOOL(Recording);
+	PROPERTY_READONLY(double, SubmitTime);
+	PROPERTY_READONLY(double, BuildTime);
+	PROPERTY_READONLY(double, WaitTime);
+	virtual ~RendererManager();
 	void flush();
+	void beginFrame();
+	void endFrame();
+	Uint32 recordViewProjection(const float* viewProj);
+	void record(RenderCommand& command, const void* vertices,
+		const Uint16* indices = nullptr, const vector<RenderTransform>* transforms = nullptr);
+	/** @brief draw static geometry right away or record it, with the world
+	 transform applied on gpu, pending batches are flushed first. */
+	void draw(GeometryBuffer* geometry, Effect* effect, Uint64 state, const float* world);
 
 	template <typename Func>
 	void pushStencilState(Uint32 stencilState, const Func& workHere)
@@ -32,12 +113,79 @@ public:
 		workHere();
 		popStencilState();
 	}
+
+	/** @brief render with a scissor rect, the rect is not intersected
+	 with the current one, callers should do it when needed. */
+	template <typename Func>
+	void pushScissor(const Rect& scissor, const Func& workHere)
+	{
+		pushScissor(scissor);
+		workHere();
+		popScissor();
+	}
+
+	/** @brief render into a frame buffer of another size with no scissor. */
+	template <typename Func>
+	void pushViewport(const Size& size, const Func& workHere)
+	{
+		_viewports.push(size);
+		pushScissor(Rect::zero);
+		workHere();
+		popScissor();
+		_viewports.pop();
+	}
+
+	/** @brief render a stage of the scene into current view, in pipelined mode
+	 commands of the same stage from last frame are submitted first. */
+	template <typename Func>
+	void renderStage(const Func& workHere)
+	{
+		beginStage();
+		workHere();
+		flush();
+		endStage();
+	}
 protected:
 	RendererManager();
 	void pushStencilState(Uint32 stencilState);
 	void popStencilState();
+	void pushScissor(const Rect& scissor);
+	void popScissor();
+	void beginStage();
+	void endStage();
+	void waitForBuild();
+	static int work(void* userData);
 private:
+	struct CommandList
+	{
+		vector<RenderCommand> commands;
+		vector<Uint32> stages;
+		vector<Uint8> vertices;
+		vector<Uint16> indices;
+		vector<RenderTransform> transforms;
+		vector<Matrix> viewProjs;
+		void build();
+		void clear();
+	};
+	void submit(const CommandList& list, const RenderCommand& command);
+	bool _pipelined;
+	bool _recording;
+	bool _building;
+	Uint32 _stage;
+	Uint32 _scissorCount;
+	double _submitTime;
+	double _buildTime;
+	double _waitTime;
+	double _workerBuildTime; // written by the worker, read after _doneSemaphore
+	CommandList _lists[2];
+	CommandList* _recordList;
+	CommandList* _submitList;
+	bx::Thread _worker;
+	bx::Semaphore _buildSemaphore;
+	bx::Semaphore _doneSemaphore;
 	stack<Uint32> _stencilStates;
+	stack<Rect> _scissors;
+	stack<Size> _viewports;
 	Renderer* _currentRenderer;
 	SINGLETON_REF(RendererManager, BGFXDora);
 };
@@ -100,6 +100,11 @@ void Scheduler::unschedule(Action* action)
 	}
 }
 
+void Scheduler::scheduleFlush(Object* object)
+{
+	_flushList.push_back(object);
+}
+
 bool Scheduler::update(double deltaTime)
 {
 	// not save _it and _deltaTime on the stack memory
@@ -161,6 +166,17 @@ bool Scheduler::update(double deltaTime)
 		}
 	}
 	_updateItems.clear();
+
+	/* flush batched items, items batched during flushing go to the next frame */
+	if (!_flushList.empty())
+	{
+		RefVector<Object> flushItems;
+		flushItems.swap(_flushList);
+		for (const auto& item : flushItems)
+		{
+			item->update(_deltaTime);
+		}
+	}
 	return false;
 }
 
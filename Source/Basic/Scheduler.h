@@ -25,6 +25,9 @@ public:
 	void schedule(Action* action);
 	void unschedule(Object* object);
 	void unschedule(Action* action);
+	/** @brief update the object once after the scheduled items of the current frame,
+	 used to dispatch the invocations batched during the frame. */
+	void scheduleFlush(Object* object);
 	virtual bool update(double deltaTime) override;
 	CREATE_FUNC(Scheduler);
 protected:
@@ -34,6 +37,7 @@ private:
 	double _deltaTime;
 	UpdateList _updateList;
 	UpdateMap _updateMap;
+	RefVector<Object> _flushList;
 	Ref<Array> _actionList;
 private:
 	static vector<Ref<Object>> _updateItems;
@@ -24,7 +24,7 @@ Sprite* ClipDef::toSprite(String name)
 	if (it != rects.end())
 	{
 		Texture2D* texture = SharedTextureCache.load(textureFile);
-		Sprite* sprite = Sprite::create(texture, *it->second);
+		Sprite* sprite = Sprite::create(texture, it->second);
 		return sprite;
 	}
 	return nullptr;
@@ -40,14 +40,30 @@ string ClipDef::toXml()
 		writer << '<' << char(Xml::Clip::Element::Clip) << ' '
 			<< char(Xml::Clip::Clip::Name) << "=\"" << rect.first << "\" "
 			<< char(Xml::Clip::Clip::Rect) << "=\""
-			<< rect.second->origin.x << ',' << rect.second->origin.y << ','
-			<< rect.second->size.width << ',' << rect.second->size.height
+			<< rect.second.origin.x << ',' << rect.second.origin.y << ','
+			<< rect.second.size.width << ',' << rect.second.size.height
 			<< "\"/>";
 	}
 	writer << "</" << char(Xml::Clip::Element::Dorothy) << '>';
 	return writer.str();
 }
 
+string ClipDef::toBinary()
+{
+	BinaryWriter writer('C', 1);
+	writer.write(Slice(textureFile).getFileName());
+	writer.write(s_cast<Uint32>(rects.size()));
+	for (const auto& rect : rects)
+	{
+		writer.write(rect.first);
+		writer.write(rect.second.getX());
+		writer.write(rect.second.getY());
+		writer.write(rect.second.getWidth());
+		writer.write(rect.second.getHeight());
+	}
+	return writer.getData();
+}
+
 /* ClipCache */
 
 Sprite* ClipCache::loadSprite(String clipStr)
@@ -59,7 +75,7 @@ Sprite* ClipCache::loadSprite(String clipStr)
 	if (it != clipDef->rects.end())
 	{
 		Texture2D* texture = SharedTextureCache.load(clipDef->textureFile);
-		Sprite* sprite = Sprite::create(texture, *it->second);
+		Sprite* sprite = Sprite::create(texture, it->second);
 		return sprite;
 	}
 	return nullptr;
@@ -71,6 +87,24 @@ ValueEx<Own<XmlParser<ClipDef>>>* ClipCache::prepareParser(String filename)
 	return ValueEx<Own<XmlParser<ClipDef>>>::create(std::move(parser));
 }
 
+bool ClipCache::Parser::loadBinary(BinaryReader& reader)
+{
+	if (!reader.check('C', 1)) return false;
+	_item->textureFile = _path + reader.readString();
+	Uint32 count = reader.readCount();
+	_item->rects.reserve(count);
+	for (Uint32 i = 0; i < count && reader.isValid(); i++)
+	{
+		string name = reader.readString();
+		float x = reader.readFloat();
+		float y = reader.readFloat();
+		float w = reader.readFloat();
+		float h = reader.readFloat();
+		_item->rects[name] = Rect(x, y, w, h);
+	}
+	return reader.isValid();
+}
+
 void ClipCache::Parser::xmlSAX2Text(const char *s, size_t len)
 { }
 
@@ -113,7 +147,7 @@ void ClipCache::Parser::xmlSAX2StartElement(const char* name, size_t len, const
 						float y = Slice::stof(*++it);
 						float w = Slice::stof(*++it);
 						float h = Slice::stof(*++it);
-						_item->rects[name] = New<Rect>(x, y, w, h);
+						_item->rects[name] = Rect(x, y, w, h);
 						break;
 					}
 				}
@@ -26,10 +26,11 @@ public:
 	/** Name of the texture file. Name only, not file path. */
 	string textureFile;
 	/** Different areas on this texture. */
-	unordered_map<string, Own<Rect>> rects;
+	unordered_map<string, Rect> rects;
 	/** Get a sprite instance with an name. */
 	Sprite* toSprite(String name);
 	string toXml();
+	string toBinary();
 	CREATE_FUNC(ClipDef);
 protected:
 	ClipDef();
@@ -52,6 +53,7 @@ private:
 	{
 	public:
 		Parser(ClipDef* def, String path):XmlParser<ClipDef>(this, def),_path(path) { }
+		virtual bool loadBinary(BinaryReader& reader) override;
 		virtual void xmlSAX2StartElement(const char* name, size_t len, const vector<AttrSlice>& attrs) override;
 		virtual void xmlSAX2EndElement(const char* name, size_t len) override;
 		virtual void xmlSAX2Text(const char* s, size_t len) override;
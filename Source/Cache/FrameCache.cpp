@@ -15,12 +15,95 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 NS_DOROTHY_BEGIN
 
+Texture2D* FrameActionDef::getTexture()
+{
+	if (!_texture && !textureFile.empty())
+	{
+		_texture = SharedTextureCache.load(textureFile);
+	}
+	return _texture;
+}
+
+const vector<FrameQuad>& FrameActionDef::getFrames()
+{
+	if (_frames.empty() && !rects.empty())
+	{
+		Texture2D* texture = FrameActionDef::getTexture();
+		if (!texture) return _frames;
+		const bgfx::TextureInfo& info = texture->getInfo();
+		_frames.reserve(rects.size());
+		for (const Rect& rect : rects)
+		{
+			_frames.push_back({rect,
+				rect.getX() / info.width,
+				rect.getY() / info.height,
+				(rect.getX() + rect.getWidth()) / info.width,
+				(rect.getY() + rect.getHeight()) / info.height});
+		}
+	}
+	return _frames;
+}
+
+string FrameActionDef::toXml()
+{
+	fmt::MemoryWriter writer;
+	writer << '<' << char(Xml::Frame::Element::Dorothy) << ' '
+		<< char(Xml::Frame::Dorothy::File) << "=\"" << Slice(textureFile).getFileName() << "\" "
+		<< char(Xml::Frame::Dorothy::Duration) << "=\"" << duration << "\">";
+	for (const Rect& rect : rects)
+	{
+		writer << '<' << char(Xml::Frame::Element::Clip) << ' '
+			<< char(Xml::Frame::Clip::Rect) << "=\""
+			<< rect.origin.x << ',' << rect.origin.y << ','
+			<< rect.size.width << ',' << rect.size.height
+			<< "\"/>";
+	}
+	writer << "</" << char(Xml::Frame::Element::Dorothy) << '>';
+	return writer.str();
+}
+
+string FrameActionDef::toBinary()
+{
+	BinaryWriter writer('F', 1);
+	writer.write(Slice(textureFile).getFileName());
+	writer.write(duration);
+	writer.write(s_cast<Uint32>(rects.size()));
+	for (const Rect& rect : rects)
+	{
+		writer.write(rect.getX());
+		writer.write(rect.getY());
+		writer.write(rect.getWidth());
+		writer.write(rect.getHeight());
+	}
+	return writer.getData();
+}
+
+/* FrameCache */
+
 ValueEx<Own<XmlParser<FrameActionDef>>>* FrameCache::prepareParser(String filename)
 {
 	Own<XmlParser<FrameActionDef>> parser(new Parser(FrameActionDef::create(), filename.getFilePath()));
 	return ValueEx<Own<XmlParser<FrameActionDef>>>::create(std::move(parser));
 }
 
+bool FrameCache::Parser::loadBinary(BinaryReader& reader)
+{
+	if (!reader.check('F', 1)) return false;
+	_item->textureFile = _path + reader.readString();
+	_item->duration = reader.readFloat();
+	Uint32 count = reader.readCount();
+	_item->rects.reserve(count);
+	for (Uint32 i = 0; i < count && reader.isValid(); i++)
+	{
+		float x = reader.readFloat();
+		float y = reader.readFloat();
+		float w = reader.readFloat();
+		float h = reader.readFloat();
+		_item->rects.push_back(Rect(x, y, w, h));
+	}
+	return reader.isValid();
+}
+
 void FrameCache::Parser::xmlSAX2Text(const char* s, size_t len)
 { }
 
@@ -60,7 +143,7 @@ void FrameCache::Parser::xmlSAX2StartElement(const char* name, size_t len, const
 						float y = Slice::stof(*++it);
 						float w = Slice::stof(*++it);
 						float h = Slice::stof(*++it);
-						_item->rects.push_back(New<Rect>(x, y, w, h));
+						_item->rects.push_back(Rect(x, y, w, h));
 						break;
 					}
 				}
@@ -11,21 +11,42 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Basic/Object.h"
 #include "Cache/XmlItemCache.h"
 #include "Common/Singleton.h"
+#include "Support/Geometry.h"
 
 NS_DOROTHY_BEGIN
 
 class FrameAction;
-struct Rect;
+class Texture2D;
+
+/** @brief A frame rect with its texture coordinates computed ahead. */
+struct FrameQuad
+{
+	Rect rect;
+	float left;
+	float top;
+	float right;
+	float bottom;
+};
 
 class FrameActionDef : public Object
 {
 public:
 	string textureFile;
 	float duration;
-	OwnVector<Rect> rects;
+	vector<Rect> rects;
+	/** @brief Texture of the frames, loaded at the first call. */
+	Texture2D* getTexture();
+	/** @brief Quads for the rects, built once and shared by all the actions
+	 playing this define so that switching frames is a table lookup. */
+	const vector<FrameQuad>& getFrames();
+	string toXml();
+	string toBinary();
 	CREATE_FUNC(FrameActionDef);
 protected:
 	FrameActionDef():duration(0) { }
+private:
+	Ref<Texture2D> _texture;
+	vector<FrameQuad> _frames;
 };
 
 /** @brief Load frame animations from ".frame" files and cache them. */
@@ -39,6 +60,7 @@ private:
 	{
 	public:
 		Parser(FrameActionDef* def, String path):XmlParser<FrameActionDef>(this, def),_path(path) { }
+		virtual bool loadBinary(BinaryReader& reader) override;
 		virtual void xmlSAX2StartElement(const char* name, size_t len, const vector<AttrSlice>& attrs) override;
 		virtual void xmlSAX2EndElement(const char* name, size_t len) override;
 		virtual void xmlSAX2Text(const char* s, size_t len) override;
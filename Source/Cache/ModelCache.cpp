@@ -24,17 +24,163 @@ ValueEx<Own<XmlParser<ModelDef>>>* ModelCache::prepareParser(String filename)
 ModelCache::Parser::Parser(ModelDef* def, String path):
 XmlParser<ModelDef>(this, def),
 _path(path),
-_currentAnimationDef(nullptr)
+_currentAnimation(-1),
+_currentFirstFrame(0)
 { }
 
-KeyAnimationDef* ModelCache::Parser::getCurrentKeyAnimation()
+void ModelCache::Parser::linkDefs()
 {
-	// lazy alloc
-	if (!_currentAnimationDef)
+	vector<SpriteDef>& spriteDefs = _item->_spriteDefs;
+	for (const auto& link : _childLinks)
 	{
-		_currentAnimationDef.reset(new KeyAnimationDef());
+		spriteDefs[link.first].children.push_back(&spriteDefs[link.second]);
 	}
-	return s_cast<KeyAnimationDef*>(_currentAnimationDef.get());
+	for (const AnimationLink& link : _animationLinks)
+	{
+		AnimationDef* animationDef = nullptr;
+		switch (link.type)
+		{
+			case AnimationDef::Key:
+			{
+				KeyAnimationDef* keyAnimationDef = &_item->_keyAnimationDefs[link.index];
+				KeyFrameDef* frames = link.frameCount > 0 ? &_item->_keyFrameDefs[link.firstFrame] : nullptr;
+				keyAnimationDef->setFrames(frames, link.frameCount);
+				animationDef = keyAnimationDef;
+				break;
+			}
+			case AnimationDef::Frame:
+				animationDef = &_item->_frameAnimationDefs[link.index];
+				break;
+		}
+		spriteDefs[link.sprite].animationDefs.push_back(animationDef);
+	}
+	_childLinks.clear();
+	_animationLinks.clear();
+	_item->_tracks = nullptr;
+}
+
+Uint32 ModelCache::Parser::readSprite(BinaryReader& reader)
+{
+	Uint32 index = s_cast<Uint32>(_item->_spriteDefs.size());
+	_item->_spriteDefs.emplace_back();
+	SpriteDef& spriteDef = _item->_spriteDefs.back();
+	spriteDef.front = reader.readByte() != 0;
+	spriteDef.x = reader.readFloat();
+	spriteDef.y = reader.readFloat();
+	spriteDef.rotation = reader.readFloat();
+	spriteDef.anchorX = reader.readFloat();
+	spriteDef.anchorY = reader.readFloat();
+	spriteDef.scaleX = reader.readFloat();
+	spriteDef.scaleY = reader.readFloat();
+	spriteDef.skewX = reader.readFloat();
+	spriteDef.skewY = reader.readFloat();
+	spriteDef.opacity = reader.readFloat();
+	spriteDef.name = reader.readString();
+	spriteDef.clip = reader.readString();
+	Uint32 animationCount = reader.readUint32();
+	for (Uint32 i = 0; i < animationCount && reader.isValid(); i++)
+	{
+		switch (reader.readByte())
+		{
+			case AnimationDef::Key:
+			{
+				AnimationLink link = {index, AnimationDef::Key,
+					s_cast<Uint32>(_item->_keyAnimationDefs.size()),
+					s_cast<Uint32>(_item->_keyFrameDefs.size()), 0};
+				_item->_keyAnimationDefs.emplace_back();
+				Uint32 frameCount = reader.readUint32();
+				for (Uint32 n = 0; n < frameCount && reader.isValid(); n++, link.frameCount++)
+				{
+					_item->_keyFrameDefs.emplace_back();
+					KeyFrameDef& keyFrameDef = _item->_keyFrameDefs.back();
+					keyFrameDef.duration = reader.readFloat();
+					keyFrameDef.visible = reader.readByte() != 0;
+					keyFrameDef.opacity = reader.readFloat();
+					keyFrameDef.x = reader.readFloat();
+					keyFrameDef.y = reader.readFloat();
+					keyFrameDef.scaleX = reader.readFloat();
+					keyFrameDef.scaleY = reader.readFloat();
+					keyFrameDef.rotation = reader.readFloat();
+					keyFrameDef.skewX = reader.readFloat();
+					keyFrameDef.skewY = reader.readFloat();
+					keyFrameDef.easePos = Ease::Enum(reader.readByte());
+					keyFrameDef.easeScale = Ease::Enum(reader.readByte());
+					keyFrameDef.easeOpacity = Ease::Enum(reader.readByte());
+					keyFrameDef.easeRotation = Ease::Enum(reader.readByte());
+					keyFrameDef.easeSkew = Ease::Enum(reader.readByte());
+				}
+				_animationLinks.push_back(link);
+				break;
+			}
+			case AnimationDef::Frame:
+			{
+				_animationLinks.push_back({index, AnimationDef::Frame,
+					s_cast<Uint32>(_item->_frameAnimationDefs.size()), 0, 0});
+				_item->_frameAnimationDefs.emplace_back();
+				FrameAnimationDef& animationDef = _item->_frameAnimationDefs.back();
+				animationDef.setFile(reader.readString());
+				animationDef.delay = reader.readFloat();
+				break;
+			}
+			default:
+				_animationLinks.push_back({index, AnimationDef::None, 0, 0, 0});
+				break;
+		}
+	}
+	Uint32 lookCount = reader.readCount();
+	spriteDef.looks.reserve(lookCount);
+	for (Uint32 i = 0; i < lookCount && reader.isValid(); i++)
+	{
+		spriteDef.looks.push_back(reader.readInt());
+	}
+	// the sprite array may grow while reading the children
+	Uint32 childCount = reader.readUint32();
+	for (Uint32 i = 0; i < childCount && reader.isValid(); i++)
+	{
+		Uint32 child = readSprite(reader);
+		_childLinks.push_back(std::make_pair(index, child));
+	}
+	return index;
+}
+
+bool ModelCache::Parser::loadBinary(BinaryReader& reader)
+{
+	if (!reader.check('M', 2)) return false;
+	_item->_clip = _path + reader.readString();
+	_item->_isFaceRight = reader.readByte() != 0;
+	_item->_size.width = reader.readFloat();
+	_item->_size.height = reader.readFloat();
+	Uint32 spriteCount = reader.readCount();
+	_item->_spriteDefs.reserve(spriteCount);
+	_item->_keyAnimationDefs.reserve(reader.readCount());
+	_item->_frameAnimationDefs.reserve(reader.readCount());
+	_item->_keyFrameDefs.reserve(reader.readCount());
+	if (spriteCount > 0)
+	{
+		readSprite(reader);
+		linkDefs();
+	}
+	Uint32 count = reader.readUint32();
+	for (Uint32 i = 0; i < count && reader.isValid(); i++)
+	{
+		string name = reader.readString();
+		_item->_animationIndex[name] = reader.readInt();
+	}
+	count = reader.readUint32();
+	for (Uint32 i = 0; i < count && reader.isValid(); i++)
+	{
+		string name = reader.readString();
+		_item->_lookIndex[name] = reader.readInt();
+	}
+	count = reader.readUint32();
+	for (Uint32 i = 0; i < count && reader.isValid(); i++)
+	{
+		string key = reader.readString();
+		float x = reader.readFloat();
+		float y = reader.readFloat();
+		_item->addKeyPoint(key, Vec2{x, y});
+	}
+	return reader.isValid();
 }
 
 void ModelCache::Parser::getPosFromStr(String str, float& x, float& y)
@@ -71,47 +217,59 @@ void ModelCache::Parser::xmlSAX2StartElement(const char* name, size_t len, const
 		}
 		case Xml::Model::Element::Sprite:
 		{
-			SpriteDef* spriteDef = new SpriteDef();
+			Uint32 index = s_cast<Uint32>(_item->_spriteDefs.size());
+			_item->_spriteDefs.emplace_back();
+			SpriteDef& spriteDef = _item->_spriteDefs.back();
 			for (int i = 0; attrs[i].first != nullptr; i++)
 			{
 				switch (Xml::Model::Sprite(attrs[i].first[0]))
 				{
 					case Xml::Model::Sprite::Key:
-						getPosFromStr(attrs[++i], spriteDef->anchorX, spriteDef->anchorY);
+						getPosFromStr(attrs[++i], spriteDef.anchorX, spriteDef.anchorY);
 						break;
 					case Xml::Model::Sprite::Opacity:
-						spriteDef->opacity = s_cast<float>(std::atof(attrs[++i].first));
+						spriteDef.opacity = s_cast<float>(std::atof(attrs[++i].first));
 						break;
 					case Xml::Model::Sprite::Position:
-						getPosFromStr(attrs[++i], spriteDef->x, spriteDef->y);
+						getPosFromStr(attrs[++i], spriteDef.x, spriteDef.y);
 						break;
 					case Xml::Model::Sprite::Scale:
-						getPosFromStr(attrs[++i], spriteDef->scaleX, spriteDef->scaleY);
+						getPosFromStr(attrs[++i], spriteDef.scaleX, spriteDef.scaleY);
 						break;
 					case Xml::Model::Sprite::Rotation:
-						spriteDef->rotation = s_cast<float>(std::atof(attrs[++i].first));
+						spriteDef.rotation = s_cast<float>(std::atof(attrs[++i].first));
 						break;
 					case Xml::Model::Sprite::Skew:
-						getPosFromStr(attrs[++i], spriteDef->skewX, spriteDef->skewY);
+						getPosFromStr(attrs[++i], spriteDef.skewX, spriteDef.skewY);
 						break;
 					case Xml::Model::Sprite::Name:
-						spriteDef->name = Slice(attrs[++i]);
+						spriteDef.name = Slice(attrs[++i]);
 						break;
 					case Xml::Model::Sprite::Clip:
-						spriteDef->clip = Slice(attrs[++i]);
+						spriteDef.clip = Slice(attrs[++i]);
 						break;
 					case Xml::Model::Sprite::Front:
-						spriteDef->front = std::atoi(attrs[++i].first) != 0;
+						spriteDef.front = std::atoi(attrs[++i].first) != 0;
 						break;
 				}
 			}
-			_nodeStack.push(MakeOwn(spriteDef));
+			if (!_nodeStack.empty())
+			{
+				_childLinks.push_back(std::make_pair(_nodeStack.top(), index));
+			}
+			_nodeStack.push(index);
 			break;
 		}
 		case Xml::Model::Element::KeyFrame:
 		{
-			KeyFrameDef* keyFrameDef = new KeyFrameDef();
-			KeyAnimationDef* animationDef = getCurrentKeyAnimation();
+			// lazy alloc
+			if (_currentAnimation < 0)
+			{
+				_currentAnimation = s_cast<int>(_item->_keyAnimationDefs.size());
+				_currentFirstFrame = s_cast<Uint32>(_item->_keyFrameDefs.size());
+				_item->_keyAnimationDefs.emplace_back();
+			}
+			KeyFrameDef keyFrameDef;
 			Slice duration;
 			Slice position;
 			Slice rotation;
@@ -145,102 +303,104 @@ void ModelCache::Parser::xmlSAX2StartElement(const char* name, size_t len, const
 						visible = attrs[++i];
 						break;
 					case Xml::Model::KeyFrame::EasePos:
-						keyFrameDef->easePos = Ease::Enum(std::atoi(attrs[++i].first));
+						keyFrameDef.easePos = Ease::Enum(std::atoi(attrs[++i].first));
 						break;
 					case Xml::Model::KeyFrame::EaseScale:
-						keyFrameDef->easeScale = Ease::Enum(std::atoi(attrs[++i].first));
+						keyFrameDef.easeScale = Ease::Enum(std::atoi(attrs[++i].first));
 						break;
 					case Xml::Model::KeyFrame::EaseSkew:
-						keyFrameDef->easeSkew = Ease::Enum(std::atoi(attrs[++i].first));
+						keyFrameDef.easeSkew = Ease::Enum(std::atoi(attrs[++i].first));
 						break;
 					case Xml::Model::KeyFrame::EaseRotate:
-						keyFrameDef->easeRotation = Ease::Enum(std::atoi(attrs[++i].first));
+						keyFrameDef.easeRotation = Ease::Enum(std::atoi(attrs[++i].first));
 						break;
 					case Xml::Model::KeyFrame::EaseOpacity:
-						keyFrameDef->easeOpacity = Ease::Enum(std::atoi(attrs[++i].first));
+						keyFrameDef.easeOpacity = Ease::Enum(std::atoi(attrs[++i].first));
 						break;
 				}
 			}
-			KeyFrameDef* lastDef = animationDef->getLastFrameDef();
+			vector<KeyFrameDef>& keyFrameDefs = _item->_keyFrameDefs;
+			const KeyFrameDef* lastDef = keyFrameDefs.size() > _currentFirstFrame ? &keyFrameDefs.back() : nullptr;
 			if (!duration.empty())
 			{
-				keyFrameDef->duration = std::atoi(duration.rawData()) / 60.0f;
+				keyFrameDef.duration = std::atoi(duration.rawData()) / 60.0f;
 			}
 			else if (lastDef)
 			{
-				keyFrameDef->duration = lastDef->duration;
+				keyFrameDef.duration = lastDef->duration;
 			}
 			if (!position.empty())
 			{
-				getPosFromStr(position, keyFrameDef->x, keyFrameDef->y);
+				getPosFromStr(position, keyFrameDef.x, keyFrameDef.y);
 			}
 			else if (lastDef)
 			{
-				keyFrameDef->x = lastDef->x;
-				keyFrameDef->y = lastDef->y;
+				keyFrameDef.x = lastDef->x;
+				keyFrameDef.y = lastDef->y;
 			}
 			if (!rotation.empty())
 			{
-				keyFrameDef->rotation = s_cast<float>(std::atof(rotation.rawData()));
+				keyFrameDef.rotation = s_cast<float>(std::atof(rotation.rawData()));
 			}
 			else if (lastDef)
 			{
-				keyFrameDef->rotation = lastDef->rotation;
+				keyFrameDef.rotation = lastDef->rotation;
 			}
 			if (!scale.empty())
 			{
-				getPosFromStr(scale, keyFrameDef->scaleX, keyFrameDef->scaleY);
+				getPosFromStr(scale, keyFrameDef.scaleX, keyFrameDef.scaleY);
 			}
 			else if (lastDef)
 			{
-				keyFrameDef->scaleX = lastDef->scaleX;
-				keyFrameDef->scaleY = lastDef->scaleY;
+				keyFrameDef.scaleX = lastDef->scaleX;
+				keyFrameDef.scaleY = lastDef->scaleY;
 			}
 			if (!skew.empty())
 			{
-				getPosFromStr(skew, keyFrameDef->skewX, keyFrameDef->skewY);
+				getPosFromStr(skew, keyFrameDef.skewX, keyFrameDef.skewY);
 			}
 			else if (lastDef)
 			{
-				keyFrameDef->skewX = lastDef->skewX;
-				keyFrameDef->skewY = lastDef->skewY;
+				keyFrameDef.skewX = lastDef->skewX;
+				keyFrameDef.skewY = lastDef->skewY;
 			}
 			if (!opacity.empty())
 			{
-				keyFrameDef->opacity = Math::clamp(s_cast<float>(std::atof(opacity.rawData())), 0.0f, 1.0f);
+				keyFrameDef.opacity = Math::clamp(s_cast<float>(std::atof(opacity.rawData())), 0.0f, 1.0f);
 			}
 			else if (lastDef)
 			{
-				keyFrameDef->opacity = lastDef->opacity;
+				keyFrameDef.opacity = lastDef->opacity;
 			}
 			if (!visible.empty())
 			{
-				keyFrameDef->visible = std::atoi(visible.rawData()) != 0;
+				keyFrameDef.visible = std::atoi(visible.rawData()) != 0;
 			}
 			else if (lastDef)
 			{
-				keyFrameDef->visible = lastDef->visible;
+				keyFrameDef.visible = lastDef->visible;
 			}
-			animationDef->add(MakeOwn(keyFrameDef));
+			keyFrameDefs.push_back(keyFrameDef);
 			break;
 		}
 		case Xml::Model::Element::FrameAnimation:
 		{
-			FrameAnimationDef* frameAnimationDef = new FrameAnimationDef();
+			_animationLinks.push_back({_nodeStack.top(), AnimationDef::Frame,
+				s_cast<Uint32>(_item->_frameAnimationDefs.size()), 0, 0});
+			_item->_frameAnimationDefs.emplace_back();
+			FrameAnimationDef& frameAnimationDef = _item->_frameAnimationDefs.back();
 			for (int i = 0; attrs[i].first != nullptr; i++)
 			{
 				switch (Xml::Model::FrameAnimation(attrs[i].first[0]))
 				{
 					case Xml::Model::FrameAnimation::File:
-						frameAnimationDef->setFile(attrs[++i]);
+						frameAnimationDef.setFile(attrs[++i]);
 						break;
 					case Xml::Model::FrameAnimation::Delay:
-						frameAnimationDef->delay = s_cast<float>(std::atof(attrs[++i].first));
+						frameAnimationDef.delay = s_cast<float>(std::atof(attrs[++i].first));
 						break;
 				}
 			}
-			SpriteDef* nodeDef = _nodeStack.top();
-			nodeDef->animationDefs.push_back(Own<AnimationDef>(frameAnimationDef));
 			break;
 		}
 		case Xml::Model::Element::Look:
@@ -251,12 +411,12 @@ void ModelCache::Parser::xmlSAX2StartElement(const char* name, size_t len, const
 				{
 					case Xml::Model::Look::Name:
 					{
-						SpriteDef* nodeDef = _nodeStack.top();
+						SpriteDef& nodeDef = _item->_spriteDefs[_nodeStack.top()];
 						Slice attr(attrs[++i]);
 						auto tokens = attr.split(",");
 						for (const auto& token : tokens)
 						{
-							nodeDef->looks.push_back(Slice::stoi(token));
+							nodeDef.looks.push_back(Slice::stoi(token));
 						}
 					}
 					break;
@@ -336,23 +496,26 @@ void ModelCache::Parser::xmlSAX2EndElement(const char* name, size_t len)
 	{
 		case Xml::Model::Element::Sprite:
 		{
-			Own<SpriteDef> nodeDef = std::move(_nodeStack.top());
 			_nodeStack.pop();
 			if (_nodeStack.empty())
 			{
-				_item->setRoot(std::move(nodeDef));
-			}
-			else
-			{
-				SpriteDef* parentDef = _nodeStack.top();
-				parentDef->children.push_back(std::move(nodeDef));
+				linkDefs();
 			}
 			break;
 		}
 		case Xml::Model::Element::KeyAnimation:
 		{
-			SpriteDef* nodeDef = _nodeStack.top();
-			nodeDef->animationDefs.push_back(std::move(_currentAnimationDef));
+			if (_currentAnimation < 0)
+			{
+				_animationLinks.push_back({_nodeStack.top(), AnimationDef::None, 0, 0, 0});
+			}
+			else
+			{
+				Uint32 frameCount = s_cast<Uint32>(_item->_keyFrameDefs.size()) - _currentFirstFrame;
+				_animationLinks.push_back({_nodeStack.top(), AnimationDef::Key,
+					s_cast<Uint32>(_currentAnimation), _currentFirstFrame, frameCount});
+				_currentAnimation = -1;
+			}
 			break;
 		}
 		default:
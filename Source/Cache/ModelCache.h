@@ -30,15 +30,29 @@ private:
 	{
 	public:
 		Parser(ModelDef* def, String path);
+		virtual bool loadBinary(BinaryReader& reader) override;
 		virtual void xmlSAX2StartElement(const char* name, size_t len, const vector<AttrSlice>& attrs) override;
 		virtual void xmlSAX2EndElement(const char* name, size_t len) override;
 		virtual void xmlSAX2Text(const char* s, size_t len) override;
 	private:
+		/* defines are linked by their indices while the arrays of the model may still grow */
+		struct AnimationLink
+		{
+			Uint32 sprite;
+			Uint8 type;
+			Uint32 index;
+			Uint32 firstFrame;
+			Uint32 frameCount;
+		};
 		string _path;
 		void getPosFromStr(String str, float& x, float& y);
-		KeyAnimationDef* getCurrentKeyAnimation();
-		stack<Own<SpriteDef>> _nodeStack;
-		Own<AnimationDef> _currentAnimationDef;
+		Uint32 readSprite(BinaryReader& reader);
+		void linkDefs();
+		stack<Uint32> _nodeStack;
+		int _currentAnimation;
+		Uint32 _currentFirstFrame;
+		vector<std::pair<Uint32, Uint32>> _childLinks;
+		vector<AnimationLink> _animationLinks;
 	};
 	SINGLETON_REF(ModelCache, Director, AsyncThread);
 };
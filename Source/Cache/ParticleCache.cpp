@@ -21,6 +21,67 @@ ValueEx<Own<XmlParser<ParticleDef>>>* ParticleCache::prepareParser(String filena
 	return ValueEx<Own<XmlParser<ParticleDef>>>::create(std::move(parser));
 }
 
+bool ParticleCache::Parser::loadBinary(BinaryReader& reader)
+{
+	if (!reader.check('P', 1)) return false;
+	_item->angle = reader.readFloat();
+	_item->angleVariance = reader.readFloat();
+	_item->blendFuncDestination = reader.readUint32();
+	_item->blendFuncSource = reader.readUint32();
+	_item->duration = reader.readFloat();
+	_item->emissionRate = reader.readFloat();
+	get(reader, _item->finishColor);
+	get(reader, _item->finishColorVariance);
+	_item->rotationStart = reader.readFloat();
+	_item->rotationStartVariance = reader.readFloat();
+	_item->rotationEnd = reader.readFloat();
+	_item->rotationEndVariance = reader.readFloat();
+	_item->finishParticleSize = reader.readFloat();
+	_item->finishParticleSizeVariance = reader.readFloat();
+	_item->maxParticles = reader.readUint32();
+	_item->particleLifespan = reader.readFloat();
+	_item->particleLifespanVariance = reader.readFloat();
+	_item->startPosition.x = reader.readFloat();
+	_item->startPosition.y = reader.readFloat();
+	_item->startPositionVariance.x = reader.readFloat();
+	_item->startPositionVariance.y = reader.readFloat();
+	get(reader, _item->startColor);
+	get(reader, _item->startColorVariance);
+	_item->startParticleSize = reader.readFloat();
+	_item->startParticleSizeVariance = reader.readFloat();
+	_item->textureName = reader.readString();
+	_item->textureRect.origin.x = reader.readFloat();
+	_item->textureRect.origin.y = reader.readFloat();
+	_item->textureRect.size.width = reader.readFloat();
+	_item->textureRect.size.height = reader.readFloat();
+	_item->emitterType = EmitterType(reader.readByte());
+	switch (_item->emitterType)
+	{
+		case EmitterType::Gravity:
+			_item->mode.gravity.rotationIsDir = reader.readByte() != 0;
+			_item->mode.gravity.gravity.x = reader.readFloat();
+			_item->mode.gravity.gravity.y = reader.readFloat();
+			_item->mode.gravity.speed = reader.readFloat();
+			_item->mode.gravity.speedVariance = reader.readFloat();
+			_item->mode.gravity.radialAcceleration = reader.readFloat();
+			_item->mode.gravity.radialAccelVariance = reader.readFloat();
+			_item->mode.gravity.tangentialAcceleration = reader.readFloat();
+			_item->mode.gravity.tangentialAccelVariance = reader.readFloat();
+			break;
+		case EmitterType::Radius:
+			_item->mode.radius.startRadius = reader.readFloat();
+			_item->mode.radius.startRadiusVariance = reader.readFloat();
+			_item->mode.radius.finishRadius = reader.readFloat();
+			_item->mode.radius.finishRadiusVariance = reader.readFloat();
+			_item->mode.radius.rotatePerSecond = reader.readFloat();
+			_item->mode.radius.rotatePerSecondVariance = reader.readFloat();
+			break;
+		default:
+			return false;
+	}
+	return reader.isValid();
+}
+
 void ParticleCache::Parser::xmlSAX2Text(const char *s, size_t len)
 { }
 
@@ -171,6 +232,14 @@ void ParticleCache::Parser::get(String value, Vec4& vec)
 	vec.w = Slice::stof(*++it);
 }
 
+void ParticleCache::Parser::get(BinaryReader& reader, Vec4& vec)
+{
+	vec.x = reader.readFloat();
+	vec.y = reader.readFloat();
+	vec.z = reader.readFloat();
+	vec.w = reader.readFloat();
+}
+
 void ParticleCache::Parser::get(String value, Vec2& vec)
 {
 	auto tokens = value.split(",");
@@ -28,6 +28,7 @@ private:
 	{
 	public:
 		Parser(ParticleDef* def):XmlParser<ParticleDef>(this, def) { }
+		virtual bool loadBinary(BinaryReader& reader) override;
 		virtual void xmlSAX2StartElement(const char* name, size_t len, const vector<AttrSlice>& attrs) override;
 		virtual void xmlSAX2EndElement(const char* name, size_t len) override;
 		virtual void xmlSAX2Text(const char* s, size_t len) override;
@@ -35,6 +36,7 @@ private:
 		void get(String value, Vec4& vec);
 		void get(String value, Vec2& vec);
 		void get(String value, Rect& rect);
+		void get(BinaryReader& reader, Vec4& vec);
 	};
 private:
 	SINGLETON_REF(ParticleCache, Director, AsyncThread);
@@ -10,6 +10,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Cache/SoundCache.h"
 #include "Audio/Sound.h"
 #include "Basic/Content.h"
+#include "Common/Async.h"
 
 NS_DOROTHY_BEGIN
 
@@ -75,11 +76,55 @@ void SoundCache::loadAsync(String filename, const function<void(SoundFile*)>& ha
 		case "ogg"_hash:
 		{
 			string fullPath = SharedContent.getFullPath(filename);
-			SharedContent.loadFileAsyncUnsafe(fullPath, [this, fullPath, handler](Uint8* data, Sint64 size)
+			auto it = _soundFiles.find(fullPath);
+			if (it != _soundFiles.end())
 			{
-				SoundFile* soundFile = SoundFile::create(MakeOwnArray(data, s_cast<size_t>(size)));
-				_soundFiles[fullPath] = soundFile;
-				handler(soundFile);
+				handler(it->second);
+				break;
+			}
+			auto loading = _loadings.find(fullPath);
+			if (loading != _loadings.end())
+			{
+				loading->second.push_back(handler);
+				break;
+			}
+			_loadings[fullPath].push_back(handler);
+			auto finish = [this, fullPath](SoundFile* soundFile)
+			{
+				auto handlers = std::move(_loadings[fullPath]);
+				_loadings.erase(fullPath);
+				if (soundFile)
+				{
+					auto it = _soundFiles.find(fullPath);
+					if (it == _soundFiles.end()) _soundFiles[fullPath] = soundFile;
+					else soundFile = it->second;
+				}
+				for (const auto& handler : handlers)
+				{
+					handler(soundFile);
+				}
+			};
+			SharedContent.loadFileAsyncUnsafe(fullPath, [this, finish](Uint8* data, Sint64 size)
+			{
+				if (!data)
+				{
+					finish(nullptr);
+					return;
+				}
+				Ref<SoundFile> soundFile(SoundFile::create());
+				SoundFile* file = soundFile;
+				// spread decoding over two workers so that sounds are decoded in parallel
+				Async& decoder = _decodeCount++ % 2 == 0 ? SharedAsyncThread.Process : SharedAsyncThread.Loader;
+				decoder.run([file, data, size]()
+				{
+					bool result = file->decode(MakeOwnArray(data, s_cast<size_t>(size)));
+					return Values::create(result);
+				}, [soundFile, finish](Values* values)
+				{
+					bool result = false;
+					values->get(result);
+					finish(result ? soundFile.get() : nullptr);
+				});
 			});
 			break;
 		}
@@ -92,6 +137,27 @@ void SoundCache::loadAsync(String filename, const function<void(SoundFile*)>& ha
 	}
 }
 
+void SoundCache::preload(const vector<string>& filenames, const function<void()>& handler)
+{
+	if (filenames.empty())
+	{
+		if (handler) handler();
+		return;
+	}
+	Uint32* count = new Uint32(s_cast<Uint32>(filenames.size()));
+	for (const string& filename : filenames)
+	{
+		SoundCache::loadAsync(filename, [count, handler](SoundFile*)
+		{
+			if (--(*count) == 0)
+			{
+				delete count;
+				if (handler) handler();
+			}
+		});
+	}
+}
+
 bool SoundCache::unload(SoundFile* soundFile)
 {
 	for (const auto& it : _soundFiles)
@@ -22,15 +22,21 @@ public:
 	SoundFile* get(String filename);
 	/** @brief support format .wav .ogg */
 	SoundFile* load(String filename);
+	/** @brief load in the file thread and decode in one of the worker threads,
+	 handlers waiting for the same file are called together when it is done. */
 	void loadAsync(String filename, const function<void(SoundFile*)>& handler);
+	/** @brief decode a list of sounds in parallel, handler is called when all are done. */
+	void preload(const vector<string>& filenames, const function<void()>& handler);
     bool unload(SoundFile* soundFile);
     bool unload(String filename);
     bool unload();
     void removeUnused();
 protected:
-	SoundCache() { }
+	SoundCache():_decodeCount(0) { }
 private:
+	Uint32 _decodeCount;
 	unordered_map<string, Ref<SoundFile>> _soundFiles;
+	unordered_map<string, vector<function<void(SoundFile*)>>> _loadings;
 	DORA_TYPE(SoundCache);
 	SINGLETON_REF(SoundCache, SoLoudPlayer);
 };
@@ -14,6 +14,138 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 NS_DOROTHY_BEGIN
 
+/** @brief Cached items can be stored in a binary form that skips the xml parsing.
+ A binary file starts with the "DORB" tag, a kind char, a version byte and two
+ reserved bytes, then the values of the item follow as little endian numbers and
+ length prefixed strings, in the order the item writes them.
+*/
+class BinaryWriter
+{
+public:
+	BinaryWriter(char kind, Uint8 version)
+	{
+		_data.append("DORB", 4);
+		_data.push_back(kind);
+		_data.push_back(s_cast<char>(version));
+		_data.append(2, '\0');
+	}
+	void write(Uint8 value)
+	{
+		_data.push_back(s_cast<char>(value));
+	}
+	void write(Uint32 value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			_data.push_back(s_cast<char>((value >> (i * 8)) & 0xff));
+		}
+	}
+	void write(int value)
+	{
+		write(s_cast<Uint32>(value));
+	}
+	void write(float value)
+	{
+		Uint32 bits;
+		std::memcpy(&bits, &value, sizeof(float));
+		write(bits);
+	}
+	void write(String value)
+	{
+		write(s_cast<Uint32>(value.size()));
+		_data.append(value.rawData(), value.size());
+	}
+	const string& getData() const
+	{
+		return _data;
+	}
+private:
+	string _data;
+};
+
+class BinaryReader
+{
+public:
+	BinaryReader(const char* data, size_t size):
+	_data(data),
+	_size(size),
+	_pos(HeaderSize),
+	_valid(isBinary(data, size))
+	{ }
+	static bool isBinary(const char* data, size_t size)
+	{
+		return size >= HeaderSize && std::memcmp(data, "DORB", 4) == 0;
+	}
+	/** Check the kind and the version written by BinaryWriter. */
+	bool check(char kind, Uint8 version)
+	{
+		_valid = _valid && _data[4] == kind && s_cast<Uint8>(_data[5]) == version;
+		return _valid;
+	}
+	bool isValid() const
+	{
+		return _valid;
+	}
+	size_t getPosition() const
+	{
+		return _pos;
+	}
+	Uint8 readByte()
+	{
+		if (!require(1)) return 0;
+		return s_cast<Uint8>(_data[_pos++]);
+	}
+	Uint32 readUint32()
+	{
+		if (!require(4)) return 0;
+		Uint32 value = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			value |= s_cast<Uint32>(s_cast<Uint8>(_data[_pos++])) << (i * 8);
+		}
+		return value;
+	}
+	int readInt()
+	{
+		return s_cast<int>(readUint32());
+	}
+	float readFloat()
+	{
+		Uint32 bits = readUint32();
+		float value;
+		std::memcpy(&value, &bits, sizeof(float));
+		return value;
+	}
+	/** Read the size of an array whose items take at least one byte each,
+	 so that a broken size is not used to allocate the array. */
+	Uint32 readCount()
+	{
+		Uint32 count = readUint32();
+		if (!require(count)) return 0;
+		return count;
+	}
+	/** The returned slice points into the data being read. */
+	Slice readString()
+	{
+		Uint32 length = readUint32();
+		if (!require(length)) return Slice();
+		Slice value(_data + _pos, length);
+		_pos += length;
+		return value;
+	}
+private:
+	enum { HeaderSize = 8 };
+	bool require(size_t size)
+	{
+		_valid = _valid && _pos + size <= _size;
+		return _valid;
+	}
+	const char* _data;
+	size_t _size;
+	size_t _pos;
+	bool _valid;
+};
+
 template <class T>
 class XmlParser
 {
@@ -23,10 +155,21 @@ public:
 	_item(item)
 	{ }
 	virtual ~XmlParser() { }
+	/** Parse xml text or load the binary form of the item. */
 	void parse(char* text, int length)
 	{
-		_parser.parse<>(text, length);
+		if (BinaryReader::isBinary(text, s_cast<size_t>(length)))
+		{
+			BinaryReader reader(text, s_cast<size_t>(length));
+			if (!loadBinary(reader) || !reader.isValid())
+			{
+				throw rapidxml::parse_error("invalid binary data", r_cast<void*>(text + reader.getPosition()));
+			}
+		}
+		else _parser.parse<>(text, length);
 	}
+	/** Implement it to read the binary form written by the item. */
+	virtual bool loadBinary(BinaryReader& reader) = 0;
 	T* getItem() const
 	{
 		return _item;
@@ -25,6 +25,7 @@ using std::unordered_set;
 #include <list>
 using std::list;
 #include <memory>
+#include <atomic>
 #include <tuple>
 using std::tuple;
 #include <algorithm>
@@ -39,6 +40,7 @@ using Acf::Delegate;
 #include "bgfx/embedded_shader.h"
 #include "bx/thread.h"
 #include "bx/semaphore.h"
+#include "bx/mutex.h"
 #include "bx/fpumath.h"
 #include "Box2D/Box2D.h"
 #include "silly/Slice.h"
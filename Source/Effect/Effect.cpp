@@ -14,96 +14,108 @@ NS_DOROTHY_BEGIN
 
 /* Effect */
 
-Effect::Uniform::~Uniform()
-{
-	if (bgfx::isValid(_handle))
-	{
-		bgfx::destroyUniform(_handle);
-	}
-}
+const Uint32 Effect::InvalidIndex = UINT32_MAX;
 
-Effect::Uniform::Uniform(bgfx::UniformHandle handle, Value* value):
-_handle(handle),
-_value(value)
-{ }
+Effect* Effect::_lastApplied = nullptr;
 
-bgfx::UniformHandle Effect::Uniform::getHandle() const
-{
-	return _handle;
-}
+Effect::Effect(Shader* vertShader, Shader* fragShader):
+_vertShader(vertShader),
+_fragShader(fragShader),
+_dirty(false)
+{ }
 
-Value* Effect::Uniform::getValue() const
-{
-	return _value;
-}
+Effect::Effect(String vertShader, String fragShader):
+_vertShader(SharedShaderCache.load(vertShader)),
+_fragShader(SharedShaderCache.load(fragShader)),
+_dirty(false)
+{ }
 
-void Effect::Uniform::apply()
+Effect::~Effect()
 {
-	if (_value->as<float>())
+	if (_lastApplied == this)
 	{
-		float value = _value->as<float>()->get();
-		bgfx::setUniform(_handle, Vec4{value});
+		_lastApplied = nullptr;
 	}
-	else if (_value->as<Vec4>())
+	for (const Uniform& uniform : _uniforms)
 	{
-		const Vec4& value = _value->as<Vec4>()->get();
-		bgfx::setUniform(_handle, value);
+		bgfx::destroyUniform(uniform.handle);
 	}
-	else if (_value->as<Matrix>())
+	if (bgfx::isValid(_program))
 	{
-		const Matrix& value = _value->as<Matrix>()->get();
-		bgfx::setUniform(_handle, value);
+		bgfx::destroyProgram(_program);
 	}
 }
 
+bool Effect::init()
+{
+	_program = bgfx::createProgram(_vertShader->getHandle(), _fragShader->getHandle());
+	return bgfx::isValid(_program);
+}
+
 bgfx::ProgramHandle Effect::apply()
 {
-	for (const auto& pair : _uniforms)
+	// bgfx keeps uniform values between draw calls, but uniforms of the same
+	// name are shared by effects, so all of them are set again after another
+	// effect was applied and only the changed ones are set otherwise
+	bool applyAll = _lastApplied != this;
+	if (applyAll || _dirty)
 	{
-		pair.second->apply();
+		for (Uniform& uniform : _uniforms)
+		{
+			if (applyAll || uniform.dirty)
+			{
+				bgfx::setUniform(uniform.handle, uniform.value);
+				uniform.dirty = false;
+			}
+		}
+		_dirty = false;
+		_lastApplied = this;
 	}
 	return _program;
 }
 
-Effect::Effect(Shader* vertShader, Shader* fragShader):
-_vertShader(vertShader),
-_fragShader(fragShader)
-{ }
-
-Effect::Effect(String vertShader, String fragShader):
-_vertShader(SharedShaderCache.load(vertShader)),
-_fragShader(SharedShaderCache.load(fragShader))
-{ }
-
-Effect::~Effect()
+void Effect::resetApplied()
 {
-	if (bgfx::isValid(_program))
-	{
-		bgfx::destroyProgram(_program);
-	}
+	_lastApplied = nullptr;
 }
 
-bool Effect::init()
+Uint32 Effect::add(String name, bgfx::UniformType::Enum type)
 {
-	_program = bgfx::createProgram(_vertShader->getHandle(), _fragShader->getHandle());
-	return bgfx::isValid(_program);
+	string uname(name);
+	auto it = _uniformIndex.find(uname);
+	if (it != _uniformIndex.end())
+	{
+		return it->second;
+	}
+	Uint32 index = s_cast<Uint32>(_uniforms.size());
+	_uniforms.push_back({bgfx::createUniform(uname.c_str(), type), type, true, Matrix{}});
+	_uniformIndex[uname] = index;
+	return index;
 }
 
-void Effect::set(String name, float var)
+void Effect::set(Uint32 index, bgfx::UniformType::Enum type, const float* data)
 {
-	string uname(name);
-	auto it = _uniforms.find(uname);
-	if (it != _uniforms.end())
+	if (index >= _uniforms.size()) return;
+	Uniform& uniform = _uniforms[index];
+	if (uniform.type != type)
 	{
-		it->second->getValue()->as<float>()->set(var);
+		Log("uniform type mismatched for index %d.", index);
+		return;
 	}
-	else
+	size_t size = (type == bgfx::UniformType::Mat4 ? 16 : 4) * sizeof(float);
+	if (std::memcmp(uniform.value.m, data, size) != 0)
 	{
-		bgfx::UniformHandle handle = bgfx::createUniform(uname.c_str(), bgfx::UniformType::Vec4);
-		_uniforms[uname] = Uniform::create(handle, Value::create(var));
+		std::memcpy(uniform.value.m, data, size);
+		uniform.dirty = true;
+		_dirty = true;
 	}
 }
 
+void Effect::set(String name, float var)
+{
+	set(name, Vec4{var});
+}
+
 void Effect::set(String name, float var1, float var2, float var3, float var4)
 {
 	set(name, Vec4{var1, var2, var3, var4});
@@ -111,40 +123,43 @@ void Effect::set(String name, float var1, float var2, float var3, float var4)
 
 void Effect::set(String name, const Vec4& var)
 {
-	string uname(name);
-	auto it = _uniforms.find(uname);
-	if (it != _uniforms.end())
-	{
-		it->second->getValue()->as<Vec4>()->set(var);
-	}
-	else
-	{
-		bgfx::UniformHandle handle = bgfx::createUniform(uname.c_str(), bgfx::UniformType::Vec4);
-		_uniforms[uname] = Uniform::create(handle, Value::create(var));
-	}
+	Uint32 index = add(name, bgfx::UniformType::Vec4);
+	set(index, bgfx::UniformType::Vec4, var);
 }
 
 void Effect::set(String name, const Matrix& var)
 {
-	string uname(name);
-	auto it = _uniforms.find(uname);
-	if (it != _uniforms.end())
-	{
-		it->second->getValue()->as<Matrix>()->set(var);
-	}
-	else
-	{
-		bgfx::UniformHandle handle = bgfx::createUniform(uname.c_str(), bgfx::UniformType::Mat4);
-		_uniforms[uname] = Uniform::create(handle, Value::create(var));
-	}
+	Uint32 index = add(name, bgfx::UniformType::Mat4);
+	set(index, bgfx::UniformType::Mat4, var);
+}
+
+Uint32 Effect::getIndex(String name) const
+{
+	auto it = _uniformIndex.find(name);
+	return it != _uniformIndex.end() ? it->second : Effect::InvalidIndex;
+}
+
+void Effect::set(Uint32 index, float var1, float var2, float var3, float var4)
+{
+	set(index, Vec4{var1, var2, var3, var4});
+}
+
+void Effect::set(Uint32 index, const Vec4& var)
+{
+	set(index, bgfx::UniformType::Vec4, var);
+}
+
+void Effect::set(Uint32 index, const Matrix& var)
+{
+	set(index, bgfx::UniformType::Mat4, var);
 }
 
-Value* Effect::get(String name) const
+const float* Effect::get(String name) const
 {
-	auto it = _uniforms.find(name);
-	if (it != _uniforms.end())
+	auto it = _uniformIndex.find(name);
+	if (it != _uniformIndex.end())
 	{
-		return it->second->getValue();
+		return _uniforms[it->second].value;
 	}
 	return nullptr;
 }
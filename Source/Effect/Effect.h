@@ -24,31 +24,44 @@ public:
 	void set(String name, float var1, float var2, float var3, float var4);
 	void set(String name, const Vec4& var);
 	void set(String name, const Matrix& var);
-	Value* get(String name) const;
+	/** @brief Get the index of a uniform added by the setters above, look it
+	 up once and use it with the index setters to change parameters between
+	 batches without string hashing. Returns Effect::InvalidIndex for names not set. */
+	Uint32 getIndex(String name) const;
+	void set(Uint32 index, float var1, float var2, float var3, float var4);
+	void set(Uint32 index, const Vec4& var);
+	void set(Uint32 index, const Matrix& var);
+	/** @brief Get the uniform data, 4 floats for vectors and 16 for matrices,
+	 returns nullptr for names not set. */
+	const float* get(String name) const;
+	/** @brief Set the changed uniforms and get the program for a submit,
+	 values are read when a batch is submitted. */
 	bgfx::ProgramHandle apply();
+	/** @brief Make the next apply of every effect set all its uniforms,
+	 called when a frame begins. */
+	static void resetApplied();
+	static const Uint32 InvalidIndex;
 	CREATE_FUNC(Effect);
 protected:
 	Effect(Shader* vertShader, Shader* fragShader);
 	Effect(String vertShader, String fragShader);
 private:
-	class Uniform : public Object
+	struct Uniform
 	{
-	public:
-		PROPERTY_READONLY(bgfx::UniformHandle, Handle);
-		PROPERTY_READONLY(Value*, Value);
-		virtual ~Uniform();
-		void apply();
-		CREATE_FUNC(Uniform);
-	protected:
-		Uniform(bgfx::UniformHandle handle, Value* value);
-	private:
-		bgfx::UniformHandle _handle;
-		Ref<Value> _value;
+		bgfx::UniformHandle handle;
+		bgfx::UniformType::Enum type;
+		bool dirty;
+		Matrix value;
 	};
+	Uint32 add(String name, bgfx::UniformType::Enum type);
+	void set(Uint32 index, bgfx::UniformType::Enum type, const float* data);
 	Ref<Shader> _fragShader;
 	Ref<Shader> _vertShader;
 	bgfx::ProgramHandle _program;
-	unordered_map<string, Ref<Uniform>> _uniforms;
+	bool _dirty;
+	vector<Uniform> _uniforms;
+	unordered_map<string, Uint32> _uniformIndex;
+	static Effect* _lastApplied;
 	DORA_TYPE_OVERRIDE(Effect);
 };
 
@@ -13,6 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Effect/Effect.h"
 #include "Basic/Content.h"
 #include "Basic/Director.h"
+#include "Basic/Renderer.h"
 #include "Basic/Scheduler.h"
 #include "Basic/View.h"
 #include "Cache/TextureCache.h"
@@ -147,8 +148,10 @@ void ImGUIDora::setClipboardText(void*, const char* text)
 
 void ImGUIDora::setImePositionHint(int x, int y)
 {
+	SDL_Window* window = SharedApplication.getSDLWindow();
+	if (!window) return;
 	int w;
-	SDL_GetWindowSize(SharedApplication.getSDLWindow(), &w, nullptr);
+	SDL_GetWindowSize(window, &w, nullptr);
 	float scale = s_cast<float>(w) / SharedApplication.getWidth();
 	int offset =
 #if BX_PLATFORM_IOS
@@ -297,6 +300,21 @@ void ImGUIDora::showStats()
 		frames = 0;
 		cpuTime = gpuTime = deltaTime = 0.0;
 	}
+	ImGui::TextColored(Color(0xff00ffff).toVec4(), "Frame time:");
+	ImGui::SameLine();
+	ImGui::Text("%.1f ms", 1000.0 * SharedApplication.getFrameTimeMean());
+	ImGui::TextColored(Color(0xff00ffff).toVec4(), "P95 / P99:");
+	ImGui::SameLine();
+	ImGui::Text("%.1f / %.1f ms", 1000.0 * SharedApplication.getFrameTimeP95(), 1000.0 * SharedApplication.getFrameTimeP99());
+	ImGui::TextColored(Color(0xff00ffff).toVec4(), "Missed frames:");
+	ImGui::SameLine();
+	ImGui::Text("%d", SharedApplication.getMissedFrames());
+	ImGui::TextColored(Color(0xff00ffff).toVec4(), "Update / Touch / Visit:");
+	ImGui::SameLine();
+	ImGui::Text("%.2f / %.2f / %.2f ms", 1000.0 * SharedDirector.getUpdateTime(), 1000.0 * SharedDirector.getTouchTime(), 1000.0 * SharedDirector.getVisitTime());
+	ImGui::TextColored(Color(0xff00ffff).toVec4(), "Submit / Build / Wait:");
+	ImGui::SameLine();
+	ImGui::Text("%.2f / %.2f / %.2f ms", 1000.0 * SharedRendererManager.getSubmitTime(), 1000.0 * SharedRendererManager.getBuildTime(), 1000.0 * SharedRendererManager.getWaitTime());
 	ImGui::TextColored(Color(0xff00ffff).toVec4(), "C++ Object:");
 	ImGui::SameLine();
 	ImGui::Text("%d", Object::getObjectCount());
@@ -486,26 +504,30 @@ void ImGUIDora::begin()
 		});
 	}
 
-	int mx, my;
-	Uint32 mouseMask = SDL_GetMouseState(&mx, &my);
-	int w, h;
 	SDL_Window* window = SharedApplication.getSDLWindow();
-	SDL_GetWindowSize(window, &w, &h);
-	mx = s_cast<int>(io.DisplaySize.x * (s_cast<float>(mx) / w));
-	my = s_cast<int>(io.DisplaySize.y * (s_cast<float>(my) / h));
-	bool hasMousePos = (SDL_GetWindowFlags(window) & SDL_WINDOW_MOUSE_FOCUS) != 0;
-	io.MousePos = hasMousePos ? ImVec2((float)mx, (float)my) : ImVec2(-1, -1);
-	io.MouseDown[0] = _mousePressed[0] || (mouseMask & SDL_BUTTON(SDL_BUTTON_LEFT)) != 0;
-	io.MouseDown[1] = _mousePressed[1] || (mouseMask & SDL_BUTTON(SDL_BUTTON_RIGHT)) != 0;
-	io.MouseDown[2] = _mousePressed[2] || (mouseMask & SDL_BUTTON(SDL_BUTTON_MIDDLE)) != 0;
+	if (window)
+	{
+		int mx, my;
+		Uint32 mouseMask = SDL_GetMouseState(&mx, &my);
+		int w, h;
+		SDL_GetWindowSize(window, &w, &h);
+		mx = s_cast<int>(io.DisplaySize.x * (s_cast<float>(mx) / w));
+		my = s_cast<int>(io.DisplaySize.y * (s_cast<float>(my) / h));
+		bool hasMousePos = (SDL_GetWindowFlags(window) & SDL_WINDOW_MOUSE_FOCUS) != 0;
+		io.MousePos = hasMousePos ? ImVec2((float)mx, (float)my) : ImVec2(-1, -1);
+		io.MouseDown[0] = _mousePressed[0] || (mouseMask & SDL_BUTTON(SDL_BUTTON_LEFT)) != 0;
+		io.MouseDown[1] = _mousePressed[1] || (mouseMask & SDL_BUTTON(SDL_BUTTON_RIGHT)) != 0;
+		io.MouseDown[2] = _mousePressed[2] || (mouseMask & SDL_BUTTON(SDL_BUTTON_MIDDLE)) != 0;
+
+		// Hide OS mouse cursor if ImGui is drawing it
+		SDL_ShowCursor(io.MouseDrawCursor ? 0 : 1);
+	}
+	else io.MousePos = ImVec2(-1, -1);
 	_mousePressed[0] = _mousePressed[1] = _mousePressed[2] = false;
 
 	io.MouseWheel = _mouseWheel;
 	_mouseWheel = 0.0f;
 
-	// Hide OS mouse cursor if ImGui is drawing it
-	SDL_ShowCursor(io.MouseDrawCursor ? 0 : 1);
-
 	// Start the frame
 	ImGui::NewFrame();
 }
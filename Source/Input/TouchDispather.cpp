@@ -93,6 +93,16 @@ NodeTouchHandler::NodeTouchHandler(Node* target):
 _target(target)
 { }
 
+Node* NodeTouchHandler::getTarget() const
+{
+	return _target;
+}
+
+bool NodeTouchHandler::hasTouches() const
+{
+	return !_touchMap.empty();
+}
+
 bool NodeTouchHandler::handle(const SDL_Event& event)
 {
 	switch (event.type)
@@ -174,26 +184,31 @@ int unProject(float winx, float winy, float winz, const float* invTransform, con
 	return 1;
 }
 
-Vec2 NodeTouchHandler::getPos(const SDL_Event& event)
+static Vec2 getScreenPos(const SDL_Event& event)
 {
-	Vec3 pos{-1.0f, -1.0f, 0.0f};
 	switch (event.type)
 	{
 		case SDL_MOUSEBUTTONUP:
 		case SDL_MOUSEBUTTONDOWN:
-			pos = {s_cast<float>(event.button.x), s_cast<float>(SharedApplication.getHeight() - event.button.y), 0.0f};
-			break;
+			return {s_cast<float>(event.button.x), s_cast<float>(SharedApplication.getHeight() - event.button.y)};
 		case SDL_MOUSEMOTION:
-			pos = {s_cast<float>(event.motion.x), s_cast<float>(SharedApplication.getHeight() - event.motion.y), 0.0f};
-			break;
+			return {s_cast<float>(event.motion.x), s_cast<float>(SharedApplication.getHeight() - event.motion.y)};
 		case SDL_FINGERUP:
 		case SDL_FINGERDOWN:
 		case SDL_FINGERMOTION:
+		{
 			Vec2 ratio{event.tfinger.x, 1.0f - event.tfinger.y};
-			pos = {ratio.x * SharedApplication.getWidth(), ratio.y * SharedApplication.getHeight(), 0.0f};
-			break;
+			return {ratio.x * SharedApplication.getWidth(), ratio.y * SharedApplication.getHeight()};
+		}
 	}
-	
+	return {-1.0f, -1.0f};
+}
+
+Vec2 NodeTouchHandler::getPos(const SDL_Event& event)
+{
+	Vec2 screenPos = getScreenPos(event);
+	Vec3 pos{screenPos.x, screenPos.y, 0.0f};
+
 	float invMVP[16];
 	{
 		float MVP[16];
@@ -346,6 +361,174 @@ bool NodeTouchHandler::move(const SDL_Event& event)
 	return false;
 }
 
+/* TouchGrid */
+
+const float TouchGrid::CellSize = 64.0f;
+
+TouchGrid::TouchGrid(Node* root):
+_root(root),
+_handlerVersion(TouchDispatcher::handlerVersion - 1),
+_transformVersion(TouchDispatcher::transformVersion - 1),
+_viewProj{},
+_width(0),
+_height(0),
+_columns(0),
+_rows(0)
+{ }
+
+Node* TouchGrid::getRoot() const
+{
+	return _root;
+}
+
+/* worlds are updated lazily and children only get dirty when their parent
+ recomputes its world in visit, touches are dispatched before visit, so
+ update the ancestors first to pick up the ones moved in this frame */
+static const float* getUpdatedWorld(Node* node)
+{
+	Node* parent = node->getParent();
+	if (parent) getUpdatedWorld(parent);
+	return node->getWorld();
+}
+
+void TouchGrid::update()
+{
+	bool handlerChanged = _handlerVersion != TouchDispatcher::handlerVersion;
+	if (handlerChanged)
+	{
+		_handlerVersion = TouchDispatcher::handlerVersion;
+		_handlers.clear();
+		_indices.clear();
+		_root->traverse([&](Node* node)
+		{
+			if (node->isTouchEnabled())
+			{
+				_indices[node->getTouchHandler()] = s_cast<int>(_handlers.size());
+				_handlers.push_back(node->getTouchHandler());
+			}
+			return false;
+		});
+	}
+
+	const float* viewProj = SharedDirector.getViewProjection();
+	int width = SharedApplication.getWidth();
+	int height = SharedApplication.getHeight();
+	if (!handlerChanged &&
+		_transformVersion == TouchDispatcher::transformVersion &&
+		_width == width && _height == height &&
+		std::memcmp(_viewProj.m, viewProj, sizeof(_viewProj.m)) == 0)
+	{
+		return;
+	}
+	_transformVersion = TouchDispatcher::transformVersion;
+	std::memcpy(_viewProj.m, viewProj, sizeof(_viewProj.m));
+	if (_width != width || _height != height)
+	{
+		_width = width;
+		_height = height;
+		_columns = std::max(1, s_cast<int>(std::ceil(width / CellSize)));
+		_rows = std::max(1, s_cast<int>(std::ceil(height / CellSize)));
+		_cells.resize(_columns * _rows);
+	}
+	for (auto& cell : _cells)
+	{
+		cell.clear();
+	}
+	_unbounded.clear();
+
+	/* insert handlers by the screen bounds of their projected target rects */
+	for (int index = 0; index < s_cast<int>(_handlers.size()); index++)
+	{
+		Node* node = _handlers[index]->getTarget();
+		const Size& size = node->getSize();
+		if (size == Size::zero)
+		{
+			_unbounded.push_back(index);
+			continue;
+		}
+		float MVP[16];
+		bx::mtxMul(MVP, getUpdatedWorld(node), viewProj);
+		const float corners[4][4] = {
+			{0.0f, 0.0f, 0.0f, 1.0f},
+			{size.width, 0.0f, 0.0f, 1.0f},
+			{0.0f, size.height, 0.0f, 1.0f},
+			{size.width, size.height, 0.0f, 1.0f}
+		};
+		float left = FLT_MAX, right = -FLT_MAX, bottom = FLT_MAX, top = -FLT_MAX;
+		bool projected = true;
+		for (const auto& corner : corners)
+		{
+			float clip[4];
+			bx::vec4MulMtx(clip, corner, MVP);
+			if (clip[3] <= FLT_EPSILON)
+			{
+				projected = false;
+				break;
+			}
+			float x = (clip[0] / clip[3] * 0.5f + 0.5f) * width;
+			float y = (clip[1] / clip[3] * 0.5f + 0.5f) * height;
+			left = std::min(left, x);
+			right = std::max(right, x);
+			bottom = std::min(bottom, y);
+			top = std::max(top, y);
+		}
+		if (!projected)
+		{
+			// rect crossing the camera plane, let the handler test it
+			_unbounded.push_back(index);
+			continue;
+		}
+		// one pixel margin for the edges of the rect
+		int minX = s_cast<int>(std::floor((left - 1.0f) / CellSize));
+		int maxX = s_cast<int>(std::floor((right + 1.0f) / CellSize));
+		int minY = s_cast<int>(std::floor((bottom - 1.0f) / CellSize));
+		int maxY = s_cast<int>(std::floor((top + 1.0f) / CellSize));
+		if (maxX < 0 || maxY < 0 || minX >= _columns || minY >= _rows)
+		{
+			continue;
+		}
+		minX = std::max(minX, 0);
+		minY = std::max(minY, 0);
+		maxX = std::min(maxX, _columns - 1);
+		maxY = std::min(maxY, _rows - 1);
+		for (int y = minY; y <= maxY; y++)
+		{
+			for (int x = minX; x <= maxX; x++)
+			{
+				_cells[y * _columns + x].push_back(index);
+			}
+		}
+	}
+}
+
+void TouchGrid::query(const Vec2& pos, vector<int>& indices) const
+{
+	indices.insert(indices.end(), _unbounded.begin(), _unbounded.end());
+	int x = s_cast<int>(std::floor(pos.x / CellSize));
+	int y = s_cast<int>(std::floor(pos.y / CellSize));
+	if (0 <= x && x < _columns && 0 <= y && y < _rows)
+	{
+		const auto& cell = _cells[y * _columns + x];
+		indices.insert(indices.end(), cell.begin(), cell.end());
+	}
+}
+
+int TouchGrid::indexOf(NodeTouchHandler* handler) const
+{
+	auto it = _indices.find(handler);
+	return it == _indices.end() ? -1 : it->second;
+}
+
+NodeTouchHandler* TouchGrid::get(int index) const
+{
+	return _handlers[index];
+}
+
+/* TouchDispatcher */
+
+Uint32 TouchDispatcher::handlerVersion = 0;
+Uint32 TouchDispatcher::transformVersion = 0;
+
 void TouchDispatcher::add(const SDL_Event& event)
 {
 	_events.push_back(event);
@@ -384,6 +567,80 @@ void TouchDispatcher::dispatch()
 	clearHandlers();
 }
 
+TouchGrid* TouchDispatcher::getGrid(Node* root)
+{
+	for (const auto& grid : _grids)
+	{
+		if (grid->getRoot() == root)
+		{
+			return grid;
+		}
+	}
+	// keep grids for the ui and the few recent entries
+	if (_grids.size() >= 4)
+	{
+		_grids.erase(_grids.begin());
+	}
+	_grids.push_back(New<TouchGrid>(root));
+	return _grids.back();
+}
+
+void TouchDispatcher::dispatch(Node* root)
+{
+	if (_events.empty() || !root)
+	{
+		return;
+	}
+	TouchGrid* grid = getGrid(root);
+	grid->update();
+	RefVector<Node> targets;
+	for (auto eit = _events.begin(); eit != _events.end();)
+	{
+		/* handlers that may contain the touch or are tracking touches, top most first */
+		_candidates.clear();
+		grid->query(getScreenPos(*eit), _candidates);
+		for (const auto& node : _activeNodes)
+		{
+			if (node)
+			{
+				int index = grid->indexOf(node->getTouchHandler());
+				if (index >= 0) _candidates.push_back(index);
+			}
+		}
+		std::sort(_candidates.begin(), _candidates.end(), std::greater<int>());
+		_candidates.erase(std::unique(_candidates.begin(), _candidates.end()), _candidates.end());
+
+		// retain targets since touch events may remove them
+		targets.clear();
+		for (int index : _candidates)
+		{
+			targets.push_back(grid->get(index)->getTarget());
+		}
+		bool swallowed = false;
+		for (const auto& target : targets)
+		{
+			if (!target->isTouchEnabled()) continue;
+			NodeTouchHandler* handler = target->getTouchHandler();
+			bool result = handler->handle(*eit);
+			if (handler->hasTouches() && std::find(_activeNodes.begin(), _activeNodes.end(), target) == _activeNodes.end())
+			{
+				_activeNodes.push_back(target.get());
+			}
+			if (result && handler->isSwallowTouches())
+			{
+				swallowed = true;
+				break;
+			}
+		}
+		if (swallowed) eit = _events.erase(eit);
+		else ++eit;
+	}
+	_activeNodes.erase(std::remove_if(_activeNodes.begin(), _activeNodes.end(), [](const WRef<Node>& node)
+	{
+		return !node || !node->getTouchHandler()->hasTouches();
+	}), _activeNodes.end());
+}
+
 void TouchDispatcher::clearHandlers()
 {
 	_handlers.clear();
@@ -65,6 +65,9 @@ class NodeTouchHandler : public TouchHandler
 {
 public:
 	NodeTouchHandler(Node* target);
+	PROPERTY_READONLY(Node*, Target);
+	/** @brief whether any touch started on the target is not ended yet. */
+	bool hasTouches() const;
 	virtual bool handle(const SDL_Event& event) override;
 protected:
 	Touch* alloc(SDL_FingerID fingerId);
@@ -80,19 +83,60 @@ private:
 	unordered_map<SDL_FingerID, Ref<Touch>> _touchMap;
 };
 
+/** @brief Screen space uniform grid of the touch enabled nodes under a root node,
+ the handlers are collected again only when touch enabled nodes enter, exit or
+ are reordered, and the grid is rebuilt only when transforms or the view change.
+*/
+class TouchGrid
+{
+public:
+	TouchGrid(Node* root);
+	PROPERTY_READONLY(Node*, Root);
+	void update();
+	/** @brief get the indices of handlers that may contain the screen position. */
+	void query(const Vec2& pos, vector<int>& indices) const;
+	int indexOf(NodeTouchHandler* handler) const;
+	NodeTouchHandler* get(int index) const;
+	static const float CellSize;
+private:
+	Node* _root;
+	Uint32 _handlerVersion;
+	Uint32 _transformVersion;
+	Matrix _viewProj;
+	int _width;
+	int _height;
+	int _columns;
+	int _rows;
+	vector<NodeTouchHandler*> _handlers;
+	unordered_map<NodeTouchHandler*, int> _indices;
+	vector<int> _unbounded;
+	vector<vector<int>> _cells;
+};
+
 class TouchDispatcher
 {
 public:
 	void add(const SDL_Event& event);
 	void add(TouchHandler* handler);
 	void dispatch();
+	/** @brief dispatch events to the touch enabled nodes under root
+	 with the current view projection. */
+	void dispatch(Node* root);
 	void clearHandlers();
 	void clearEvents();
+	/** @brief bumped when touch enabled nodes enter, exit or are reordered. */
+	static Uint32 handlerVersion;
+	/** @brief bumped when any node transform changes. */
+	static Uint32 transformVersion;
 protected:
 	TouchDispatcher() { }
+	TouchGrid* getGrid(Node* root);
 private:
 	vector<TouchHandler*> _handlers;
 	list<SDL_Event> _events;
+	vector<Own<TouchGrid>> _grids;
+	WRefVector<Node> _activeNodes;
+	vector<int> _candidates;
 	SINGLETON_REF(TouchDispatcher, Director);
 };
 
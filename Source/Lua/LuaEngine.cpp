@@ -10,6 +10,14 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Lua/LuaEngine.h"
 #include "Lua/LuaBinding.h"
 #include "Lua/LuaManual.h"
+#include "bx/timer.h"
+
+#if !BX_PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // !BX_PLATFORM_WINDOWS
 
 extern int luaopen_lpeg(lua_State* L);
 
@@ -17,6 +25,117 @@ NS_DOROTHY_BEGIN
 
 int LuaEngine::_callFromLua = 0;
 
+/* Bytecode bundle layout, all integers are little endian Uint32:
+ header: "DLBC" version count
+ index: count entries of {nameOffset nameSize dataOffset dataSize}
+ followed by the module names and the bytecode chunks,
+ offsets are from the beginning of the file. */
+class LuaBundle
+{
+public:
+	static const Uint32 Version = 1;
+	struct Chunk
+	{
+		const char* data;
+		size_t size;
+	};
+	~LuaBundle()
+	{
+#if !BX_PLATFORM_WINDOWS
+		if (_mapped)
+		{
+			munmap(_mapped, _size);
+		}
+#endif // !BX_PLATFORM_WINDOWS
+	}
+	bool load(String filename)
+	{
+		string fullPath = SharedContent.getFullPath(filename);
+		Sint64 packedSize = 0;
+		const Uint8* data = SharedContent.mapFile(fullPath, packedSize);
+		if (data)
+		{
+			_size = s_cast<size_t>(packedSize);
+		}
+		else
+		{
+			data = map(fullPath);
+		}
+		if (!data)
+		{
+			_buffer = SharedContent.loadFile(fullPath);
+			data = _buffer.get();
+			_size = _buffer.size();
+		}
+		if (!data || _size < 12 || memcmp(data, "DLBC", 4) != 0 || readUint32(data + 4) != Version)
+		{
+			return false;
+		}
+		Uint32 count = readUint32(data + 8);
+		if (12 + s_cast<size_t>(count) * 16 > _size)
+		{
+			return false;
+		}
+		_index.reserve(count);
+		for (Uint32 i = 0; i < count; i++)
+		{
+			const Uint8* entry = data + 12 + i * 16;
+			Uint32 nameOffset = readUint32(entry);
+			Uint32 nameSize = readUint32(entry + 4);
+			Uint32 dataOffset = readUint32(entry + 8);
+			Uint32 dataSize = readUint32(entry + 12);
+			if (s_cast<size_t>(nameOffset) + nameSize > _size || s_cast<size_t>(dataOffset) + dataSize > _size)
+			{
+				_index.clear();
+				return false;
+			}
+			string name(r_cast<const char*>(data + nameOffset), nameSize);
+			_index[name] = {r_cast<const char*>(data + dataOffset), dataSize};
+		}
+		return true;
+	}
+	const Chunk* find(const string& moduleName) const
+	{
+		auto it = _index.find(moduleName);
+		return it == _index.end() ? nullptr : &it->second;
+	}
+	size_t getCount() const
+	{
+		return _index.size();
+	}
+private:
+	static Uint32 readUint32(const Uint8* data)
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | (s_cast<Uint32>(data[3]) << 24);
+	}
+	const Uint8* map(const string& fullPath)
+	{
+#if !BX_PLATFORM_WINDOWS
+		// files packed in apk or missing can not be mapped, load them by content instead
+		int fd = open(fullPath.c_str(), O_RDONLY);
+		if (fd < 0) return nullptr;
+		struct stat info;
+		if (fstat(fd, &info) == 0 && info.st_size > 0)
+		{
+			void* mapped = mmap(nullptr, s_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped != MAP_FAILED)
+			{
+				_mapped = mapped;
+				_size = s_cast<size_t>(info.st_size);
+			}
+		}
+		close(fd);
+		return r_cast<const Uint8*>(_mapped);
+#else
+		return nullptr;
+#endif // !BX_PLATFORM_WINDOWS
+	}
+	void* _mapped = nullptr;
+	size_t _size = 0;
+	OwnArray<Uint8> _buffer;
+	unordered_map<string, Chunk> _index;
+};
+
 static int dora_print(lua_State* L)
 {
 	int nargs = lua_gettop(L);
@@ -165,9 +284,20 @@ static int dora_loader(lua_State* L)
 	{
 		filename[pos] = '/';
 	}
+	if (SharedLueEngine.loadModuleFromBundle(L, filename))
+	{
+		return 1;
+	}
 	return dora_loadfile(L, filename);
 }
 
+static int dora_loadbundle(lua_State* L)
+{
+	string filename(luaL_checkstring(L, 1));
+	lua_pushboolean(L, SharedLueEngine.loadBundle(filename) ? 1 : 0);
+	return 1;
+}
+
 /*
 static int cclua_doXml(lua_State* L)
 {
@@ -234,7 +364,9 @@ lua_State* LuaEngine::getState() const
 	return L;
 }
 
-LuaEngine::LuaEngine()
+LuaEngine::LuaEngine():
+_manualGC(false),
+_gcLimit(0)
 {
 	L = luaL_newstate();
 	dora_loadlibs(L);
@@ -247,6 +379,7 @@ LuaEngine::LuaEngine()
 		{ "print", dora_print },
 		{ "loadfile", dora_loadfile },
 		{ "dofile", dora_dofile },
+		{ "loadbundle", dora_loadbundle },
 		/*
 		{ "doXml", olua_doXml },
 		{ "xmlToLua", olua_xmlToLua },
@@ -269,6 +402,11 @@ LuaEngine::LuaEngine()
 			tolua_function(L, "gslot", Node_gslot);
 			tolua_function(L, "slot", Node_slot);
 			tolua_function(L, "emit", Node_emit);
+			tolua_function(L, "schedule", Node_schedule);
+		tolua_endmodule(L);
+
+		tolua_beginmodule(L, "Batch");
+			tolua_call(L, MT_CALL, LuaBatch_create);
 		tolua_endmodule(L);
 
 		tolua_beginmodule(L, "Action");
@@ -290,6 +428,81 @@ LuaEngine::LuaEngine()
 LuaEngine::~LuaEngine()
 { }
 
+bool LuaEngine::loadBundle(String filename)
+{
+	Uint64 time = bx::getHPCounter();
+	Own<LuaBundle> bundle = New<LuaBundle>();
+	if (!bundle->load(filename))
+	{
+		Log("fail to load lua bundle \"%s\".", filename);
+		return false;
+	}
+	_bundle = std::move(bundle);
+	double deltaTime = s_cast<double>(bx::getHPCounter() - time) / s_cast<double>(bx::getHPFrequency());
+	Log("lua bundle \"%s\" with %d modules loaded in %.2f ms.",
+		filename, s_cast<int>(_bundle->getCount()), deltaTime * 1000.0);
+	return true;
+}
+
+void LuaEngine::unloadBundle()
+{
+	_bundle = nullptr;
+}
+
+bool LuaEngine::loadModuleFromBundle(lua_State* L, String moduleName)
+{
+	if (!_bundle) return false;
+	const LuaBundle::Chunk* chunk = _bundle->find(moduleName);
+	if (!chunk) return false;
+	string name = moduleName;
+	if (luaL_loadbuffer(L, chunk->data, chunk->size, name.c_str()) != 0)
+	{
+		luaL_error(L, "error loading module \"%s\" from bundle :\n\t%s",
+			name.c_str(), lua_tostring(L, -1));
+	}
+	return true;
+}
+
+// collect a whole cycle at once when lua memory grows over this limit
+// in KB, the limit is doubled from the memory in use after each cycle
+static const int MinGCLimit = 16 * 1024;
+
+void LuaEngine::setManualGC(bool var)
+{
+	if (_manualGC == var) return;
+	_manualGC = var;
+	if (_manualGC)
+	{
+		_gcLimit = std::max(lua_gc(L, LUA_GCCOUNT, 0) * 2, MinGCLimit);
+		lua_gc(L, LUA_GCSTOP, 0);
+	}
+	else lua_gc(L, LUA_GCRESTART, 0);
+}
+
+void LuaEngine::stepGC(double budget)
+{
+	if (!_manualGC) return;
+	int64_t endTime = bx::getHPCounter() + s_cast<int64_t>(budget * bx::getHPFrequency());
+	// garbage piles up faster than the budget allows, finish the cycle now
+	bool force = lua_gc(L, LUA_GCCOUNT, 0) > _gcLimit;
+	do
+	{
+		if (lua_gc(L, LUA_GCSTEP, 0) != 0)
+		{
+			_gcLimit = std::max(lua_gc(L, LUA_GCCOUNT, 0) * 2, MinGCLimit);
+			break;
+		}
+	}
+	while (force || bx::getHPCounter() < endTime);
+	// a finished step resets the collector threshold, stop it again
+	lua_gc(L, LUA_GCSTOP, 0);
+}
+
+int LuaEngine::getMemory() const
+{
+	return lua_gc(L, LUA_GCCOUNT, 0);
+}
+
 void LuaEngine::addLuaLoader(lua_CFunction func)
 {
 	if (!func) return;
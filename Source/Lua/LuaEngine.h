@@ -9,9 +9,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #pragma once
 
 #include "Lua/ToLua/tolua++.h"
+#include "Common/Own.h"
 
 NS_DOROTHY_BEGIN
 
+class LuaBundle;
+
 class LuaEngine
 {
 public:
@@ -27,6 +30,23 @@ public:
 	int executeScriptFile(String filename);
 	int executeFunction(int handler, int paramCount = 0);
 
+	/** @brief serve require from a precompiled bytecode bundle built by
+	 Tools/LuaBundle, modules not in the bundle are still loaded from files. */
+	bool loadBundle(String filename);
+	void unloadBundle();
+	/** @brief push the chunk of a module from the bundle onto the stack of L,
+	 the state requiring it which can be a coroutine, return false when not found. */
+	bool loadModuleFromBundle(lua_State* L, String moduleName);
+
+	/** @brief stop the automatic lua collector and drive it with stepGC(),
+	 or give the control back to lua. */
+	void setManualGC(bool var);
+	/** @brief run at least one incremental collector step and keep stepping
+	 until the cycle ends or the time budget in seconds is used up. */
+	void stepGC(double budget);
+	/** @brief memory in use by lua in KB. */
+	int getMemory() const;
+
 	void push(int value);
 	void push(float value);
 	void push(double value);
@@ -35,11 +55,17 @@ public:
 	void push(std::nullptr_t);
 
 	template<typename T>
-	typename std::enable_if<!std::is_pointer<T>::value>::type push(const T& t)
+	typename std::enable_if<!std::is_pointer<T>::value && !tolua_isvaluetype<T>::value>::type push(const T& t)
 	{
 		tolua_pushusertype(L, new T(t), LuaType<T>());
 	}
 
+	template<typename T>
+	typename std::enable_if<tolua_isvaluetype<T>::value>::type push(const T& t)
+	{
+		tolua_pushvaluetype(L, t);
+	}
+
 	template<typename T>
 	typename std::enable_if<!std::is_base_of<Object, T>::value>::type push(T* t)
 	{
@@ -66,6 +92,9 @@ protected:
 	LuaEngine();
 	static int _callFromLua;
 	lua_State* L;
+	Own<LuaBundle> _bundle;
+	bool _manualGC;
+	int _gcLimit;
 	SINGLETON_REF(LuaEngine, ObjectBase);
 };
 
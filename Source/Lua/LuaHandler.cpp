@@ -9,6 +9,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Const/Header.h"
 #include "Lua/LuaHandler.h"
 #include "Event/Event.h"
+#include "Basic/Scheduler.h"
+#include "Basic/Director.h"
+#include "Node/Node.h"
 
 NS_DOROTHY_BEGIN
 
@@ -47,4 +50,102 @@ void LuaFunction::operator()(Event* event) const
 	}
 }
 
+/* LuaBatch */
+
+LuaBatch::LuaBatch(int handler):
+_handler(LuaHandler::create(handler)),
+_columns(LUA_NOREF),
+_columnCount(0),
+_count(0)
+{ }
+
+LuaBatch::~LuaBatch()
+{
+	if (_columns != LUA_NOREF)
+	{
+		luaL_unref(SharedLueEngine.getState(), LUA_REGISTRYINDEX, _columns);
+	}
+}
+
+int LuaBatch::getCount() const
+{
+	return _count;
+}
+
+void LuaBatch::collect(Scheduler* scheduler, Object* target, int paramCount)
+{
+	lua_State* L = SharedLueEngine.getState();
+	int base = lua_gettop(L) - paramCount;
+	tolua_pushobject(L, target); // args... target
+	lua_insert(L, base + 1); // target args...
+	if (_columns == LUA_NOREF)
+	{
+		lua_newtable(L);
+		_columns = luaL_ref(L, LUA_REGISTRYINDEX);
+	}
+	lua_rawgeti(L, LUA_REGISTRYINDEX, _columns); // target args... columns
+	_count++;
+	for (int i = 1; i <= paramCount + 1; i++)
+	{
+		lua_rawgeti(L, -1, i); // columns column
+		if (lua_isnil(L, -1))
+		{
+			lua_pop(L, 1); // columns
+			lua_newtable(L); // columns column
+			lua_pushvalue(L, -1); // columns column column
+			lua_rawseti(L, -3, i); // columns[i] = column, columns column
+		}
+		lua_pushvalue(L, base + i); // columns column arg
+		lua_rawseti(L, -2, _count); // column[count] = arg, columns column
+		lua_pop(L, 1); // columns
+	}
+	_columnCount = std::max(_columnCount, paramCount + 1);
+	lua_settop(L, base);
+	if (_count == 1)
+	{
+		scheduler->scheduleFlush(this);
+	}
+}
+
+void LuaBatch::flush()
+{
+	if (_count == 0) return;
+	Ref<LuaBatch> self(this);
+	int count = _count;
+	int columnCount = _columnCount;
+	int columns = _columns;
+	// handler may keep the arrays, start new ones for the next invocations
+	_count = 0;
+	_columnCount = 0;
+	_columns = LUA_NOREF;
+	lua_State* L = SharedLueEngine.getState();
+	lua_pushinteger(L, count); // count
+	lua_rawgeti(L, LUA_REGISTRYINDEX, columns); // count columns
+	for (int i = 1; i <= columnCount; i++)
+	{
+		lua_rawgeti(L, -i, i); // count columns column...
+	}
+	lua_remove(L, -(columnCount + 1)); // count column...
+	luaL_unref(L, LUA_REGISTRYINDEX, columns);
+	SharedLueEngine.executeFunction(_handler->get(), columnCount + 1);
+}
+
+bool LuaBatch::update(double deltaTime)
+{
+	flush();
+	return false;
+}
+
+void LuaBatchFunction::operator()(Event* event) const
+{
+	_batch->collect(SharedDirector.getScheduler(), _target, event->pushArgsToLua());
+}
+
+bool LuaBatchFunction::operator()(double deltaTime) const
+{
+	SharedLueEngine.push(deltaTime);
+	_batch->collect(_target->getScheduler(), _target, 1);
+	return false;
+}
+
 NS_DOROTHY_END
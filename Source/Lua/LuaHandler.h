@@ -79,4 +79,52 @@ private:
 	Ref<LuaHandler> _handler;
 };
 
+class Node;
+class Scheduler;
+
+/** @brief Collect the invocations of one lua handler within a frame and
+ call the handler once after the scheduler update with the invocation count
+ followed by an array for the target and each argument.
+ @example Batched node updates and events in Lua.
+ local batch = Batch(function(count, nodes, deltaTimes) end)
+ node:schedule(batch)
+ local contacts = Batch(function(count, bodies, others, points, normals) end)
+ body:slot("ContactStart", contacts)
+ */
+class LuaBatch : public Object
+{
+public:
+	virtual ~LuaBatch();
+	PROPERTY_READONLY(int, Count);
+	/** @brief collect the target and the arguments on lua stack top as one
+	 invocation and pop the arguments. */
+	void collect(Scheduler* scheduler, Object* target, int paramCount);
+	void flush();
+	virtual bool update(double deltaTime) override;
+	CREATE_FUNC(LuaBatch);
+protected:
+	LuaBatch(int handler);
+private:
+	Ref<LuaHandler> _handler;
+	int _columns;
+	int _columnCount;
+	int _count;
+	DORA_TYPE_OVERRIDE(LuaBatch);
+};
+
+class LuaBatchFunction
+{
+public:
+	LuaBatchFunction(LuaBatch* batch, Node* target):_batch(batch), _target(target) { }
+	inline bool operator==(const LuaBatchFunction& other) const
+	{
+		return _batch == other._batch && _target == other._target;
+	}
+	void operator()(Event* event) const;
+	bool operator()(double deltaTime) const;
+private:
+	Ref<LuaBatch> _batch;
+	Node* _target;
+};
+
 NS_DOROTHY_END
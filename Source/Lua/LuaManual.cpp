@@ -10,6 +10,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Dorothy.h"
 #include "Lua/ToLua/tolua++.h"
 #include "LuaManual.h"
+#include "Other/utf8.h"
 
 NS_DOROTHY_BEGIN
 
@@ -77,7 +78,7 @@ int Node_emit(lua_State* L)
 {
 #ifndef TOLUA_RELEASE
 	tolua_Error tolua_err;
-	if (!tolua_isusertype(L, 1, "Node", 0, &tolua_err) ||
+	if (!tolua_isusertype(L, 1, LuaType<Node>(), 0, &tolua_err) ||
 		!tolua_isstring(L, 2, 0, &tolua_err))
 	{
 		goto tolua_lerror;
@@ -107,9 +108,10 @@ int Node_slot(lua_State* L)
 #ifndef TOLUA_RELEASE
 	tolua_Error tolua_err;
 	if (
-		!tolua_isusertype(L, 1, "Node", 0, &tolua_err) ||
+		!tolua_isusertype(L, 1, LuaType<Node>(), 0, &tolua_err) ||
 		!tolua_isstring(L, 2, 0, &tolua_err) ||
 		!(tolua_isfunction(L, 3, &tolua_err) ||
+			tolua_isusertype(L, 3, LuaType<LuaBatch>(), 0, &tolua_err) ||
 			lua_isnil(L, 3) ||
 			tolua_isnoobj(L, 3, &tolua_err)) ||
 		!tolua_isnoobj(L, 4, &tolua_err)
@@ -131,6 +133,12 @@ int Node_slot(lua_State* L)
 			self->slot(name, LuaFunction(handler));
 			return 0;
 		}
+		else if (tolua_istype(L, 3, LuaType<LuaBatch>()))
+		{
+			LuaBatch* batch = r_cast<LuaBatch*>(tolua_tousertype(L, 3, 0));
+			self->slot(name, LuaBatchFunction(batch, self));
+			return 0;
+		}
 		else if (lua_isnil(L, 3))
 		{
 			self->slot(name, nullptr);
@@ -150,8 +158,8 @@ int Node_gslot(lua_State* L)
 {
 #ifndef TOLUA_RELEASE
 	tolua_Error tolua_err;
-	if (!tolua_isusertype(L, 1, "Node", 0, &tolua_err) ||
-		!(tolua_isstring(L, 2, 0, &tolua_err) || tolua_isusertype(L, 2, "GSlot", 0, &tolua_err)) ||
+	if (!tolua_isusertype(L, 1, LuaType<Node>(), 0, &tolua_err) ||
+		!(tolua_isstring(L, 2, 0, &tolua_err) || tolua_isusertype(L, 2, LuaType<Listener>(), 0, &tolua_err)) ||
 		!(tolua_isfunction(L, 3, &tolua_err) || lua_isnil(L, 3) || tolua_isnoobj(L, 3, &tolua_err)) ||
 		!tolua_isnoobj(L, 4, &tolua_err))
 	{
@@ -210,6 +218,68 @@ tolua_lerror :
 	return 0;
 }
 
+int Node_schedule(lua_State* L)
+{
+#ifndef TOLUA_RELEASE
+	tolua_Error tolua_err;
+	if (!tolua_isusertype(L, 1, LuaType<Node>(), 0, &tolua_err) ||
+		!(tolua_isfunction(L, 2, &tolua_err) || tolua_isusertype(L, 2, LuaType<LuaBatch>(), 0, &tolua_err)) ||
+		!tolua_isnoobj(L, 3, &tolua_err))
+	{
+		goto tolua_lerror;
+	}
+	else
+#endif
+	{
+		Node* self = r_cast<Node*>(tolua_tousertype(L, 1, 0));
+#ifndef TOLUA_RELEASE
+		if (!self) tolua_error(L, "invalid 'self' in function 'Node_schedule'", NULL);
+#endif
+		if (lua_isfunction(L, 2))
+		{
+			int handler = tolua_ref_function(L, 2);
+			self->schedule(LuaFunctionBool(handler));
+		}
+		else
+		{
+			LuaBatch* batch = r_cast<LuaBatch*>(tolua_tousertype(L, 2, 0));
+			self->schedule(LuaBatchFunction(batch, self));
+		}
+	}
+	return 0;
+#ifndef TOLUA_RELEASE
+tolua_lerror:
+	tolua_error(L, "#ferror in function 'schedule'.", &tolua_err);
+	return 0;
+#endif
+}
+
+/* LuaBatch */
+
+int LuaBatch_create(lua_State* L)
+{
+#ifndef TOLUA_RELEASE
+	tolua_Error tolua_err;
+	if (!tolua_isusertable(L, 1, "Batch", 0, &tolua_err) ||
+		!tolua_isfunction(L, 2, &tolua_err) ||
+		!tolua_isnoobj(L, 3, &tolua_err))
+	{
+		goto tolua_lerror;
+	}
+	else
+#endif
+	{
+		int handler = tolua_ref_function(L, 2);
+		tolua_pushobject(L, LuaBatch::create(handler));
+		return 1;
+	}
+#ifndef TOLUA_RELEASE
+tolua_lerror:
+	tolua_error(L, "#ferror in function 'Batch_create'.", &tolua_err);
+	return 0;
+#endif
+}
+
 bool Cache::load(String filename)
 {
 	string ext = filename.getFileExtension();
@@ -276,6 +346,27 @@ void Cache::loadAsync(String filename, const function<void()>& callback)
 	}
 }
 
+void Cache::prewarmFont(String fontName, Uint32 fontSize, String text, const function<void()>& callback, bool sdf)
+{
+	vector<Uint32> codes = utf8_get_characters(text.toString().c_str());
+	SharedFontCache.loadAync(fontName, fontSize, [codes, callback](Font* font)
+	{
+		if (font)
+		{
+			font->loadGlyphsAsync(codes, callback);
+		}
+		else
+		{
+			callback();
+		}
+	}, sdf);
+}
+
+Uint32 Cache::getFontAtlasCount()
+{
+	return SharedFontManager.getAtlasCount();
+}
+
 void Cache::update(String filename, String content)
 {
 	string ext = filename.getFileExtension();
@@ -304,6 +395,46 @@ void Cache::update(String filename, Texture2D* texture)
 	SharedTextureCache.update(filename, texture);
 }
 
+bool Cache::convert(String filename, String target)
+{
+	string ext = filename.getFileExtension();
+	string data;
+	switch (Switch::hash(ext))
+	{
+		case "clip"_hash:
+		{
+			ClipDef* clipDef = SharedClipCache.load(filename);
+			if (clipDef) data = clipDef->toBinary();
+			break;
+		}
+		case "frame"_hash:
+		{
+			FrameActionDef* frameActionDef = SharedFrameCache.load(filename);
+			if (frameActionDef) data = frameActionDef->toBinary();
+			break;
+		}
+		case "model"_hash:
+		{
+			ModelDef* modelDef = SharedModelCache.load(filename);
+			if (modelDef) data = modelDef->toBinary();
+			break;
+		}
+		case "par"_hash:
+		{
+			ParticleDef* particleDef = SharedParticleCache.load(filename);
+			if (particleDef) data = particleDef->toBinary();
+			break;
+		}
+	}
+	if (data.empty())
+	{
+		Log("fail to convert \"%s\" to binary.", filename);
+		return false;
+	}
+	SharedContent.saveToFile(target, data);
+	return true;
+}
+
 bool Cache::unload(String name)
 {
 	string ext = name.getFileExtension();
@@ -354,12 +485,12 @@ bool Cache::unload(String name)
 			default:
 			{
 				auto tokens = name.split(":");
-				if (tokens.size() == 2)
+				if (tokens.size() == 2 || (tokens.size() == 3 && tokens.back() == "sdf"_slice))
 				{
 					auto it = tokens.begin();
 					Slice fontName = *it;
 					int fontSize = Slice::stoi(*(++it));
-					return SharedFontCache.unload(fontName, fontSize);
+					return SharedFontCache.unload(fontName, fontSize, tokens.size() == 3);
 				}
 				break;
 			}
@@ -439,23 +570,23 @@ Sprite* Sprite_create(String clipStr)
 
 /* Vec2 */
 
-Vec2* Vec2_create(float x, float y)
+Vec2 Vec2_create(float x, float y)
 {
-	return Mtolua_new((Vec2)({x, y}));
+	return Vec2{x, y};
 }
 
 /* Size */
 
-Size* Size_create(float width, float height)
+Size Size_create(float width, float height)
 {
-	return Mtolua_new((Size)({width, height}));
+	return Size{width, height};
 }
 
 /* BlendFunc */
 
-BlendFunc* BlendFunc_create(Uint32 src, Uint32 dst)
+BlendFunc BlendFunc_create(Uint32 src, Uint32 dst)
 {
-	return Mtolua_new((BlendFunc)({src, dst}));
+	return BlendFunc{src, dst};
 }
 
 namespace LuaAction
@@ -756,7 +887,7 @@ int Dictionary_get(lua_State* L)
 	/* 1 self, 2 key */
 #ifndef TOLUA_RELEASE
 	tolua_Error tolua_err;
-	if (!tolua_isusertype(L, 1, "Dictionary", 0, &tolua_err) || !tolua_isslice(L, 2, 0, &tolua_err))
+	if (!tolua_isusertype(L, 1, LuaType<Dictionary>(), 0, &tolua_err) || !tolua_isslice(L, 2, 0, &tolua_err))
 	{
 		goto tolua_lerror;
 	}
@@ -809,7 +940,7 @@ int Dictionary_set(lua_State* L)
 	/* 1 self, 2 key, 3 value */
 #ifndef TOLUA_RELEASE
 	tolua_Error tolua_err;
-	if (!tolua_isusertype(L, 1, "Dictionary", 0, &tolua_err) || !tolua_isslice(L, 2, 0, &tolua_err))
+	if (!tolua_isusertype(L, 1, LuaType<Dictionary>(), 0, &tolua_err) || !tolua_isslice(L, 2, 0, &tolua_err))
 	{
 		goto tolua_lerror;
 	}
@@ -1506,3 +1637,63 @@ namespace ImGui { namespace Binding
 		return ImGuiSetCond_(0);
 	}
 } }
+
+/* LuaJIT FFI accessors, the lua side is in Assets/Script/Lib/FFI.lua */
+
+#if BX_PLATFORM_WINDOWS
+	#define DORA_FFI_API extern "C" __declspec(dllexport)
+#else
+	#define DORA_FFI_API extern "C" __attribute__((visibility("default")))
+#endif // BX_PLATFORM_WINDOWS
+
+// self is the tolua++ userdata which holds the object pointer
+#define DORA_FFI_GETTER(cls, type, name, getter) \
+	DORA_FFI_API type dora_##cls##_get_##name(void* self) \
+	{ \
+		return s_cast<cls*>(*r_cast<void**>(self))->getter(); \
+	}
+
+#define DORA_FFI_SETTER(cls, type, name, setter) \
+	DORA_FFI_API void dora_##cls##_set_##name(void* self, type value) \
+	{ \
+		s_cast<cls*>(*r_cast<void**>(self))->setter(value); \
+	}
+
+#define DORA_FFI_PROPERTY(cls, type, name, Name) \
+	DORA_FFI_GETTER(cls, type, name, get##Name) \
+	DORA_FFI_SETTER(cls, type, name, set##Name)
+
+#define DORA_FFI_PROPERTY_BOOL(cls, name, Name) \
+	DORA_FFI_GETTER(cls, bool, name, is##Name) \
+	DORA_FFI_SETTER(cls, bool, name, set##Name)
+
+DORA_FFI_PROPERTY(Node, int, order, Order)
+DORA_FFI_PROPERTY(Node, float, angle, Angle)
+DORA_FFI_PROPERTY(Node, float, angleX, AngleX)
+DORA_FFI_PROPERTY(Node, float, angleY, AngleY)
+DORA_FFI_PROPERTY(Node, float, scaleX, ScaleX)
+DORA_FFI_PROPERTY(Node, float, scaleY, ScaleY)
+DORA_FFI_PROPERTY(Node, float, x, X)
+DORA_FFI_PROPERTY(Node, float, y, Y)
+DORA_FFI_PROPERTY(Node, float, z, Z)
+DORA_FFI_PROPERTY(Node, float, skewX, SkewX)
+DORA_FFI_PROPERTY(Node, float, skewY, SkewY)
+DORA_FFI_PROPERTY_BOOL(Node, visible, Visible)
+DORA_FFI_PROPERTY(Node, float, width, Width)
+DORA_FFI_PROPERTY(Node, float, height, Height)
+DORA_FFI_PROPERTY(Node, float, opacity, Opacity)
+
+DORA_FFI_PROPERTY(Sprite, float, alphaRef, AlphaRef)
+
+DORA_FFI_GETTER(Body, float, mass, getMass)
+DORA_FFI_PROPERTY(Body, float, velocityX, VelocityX)
+DORA_FFI_PROPERTY(Body, float, velocityY, VelocityY)
+DORA_FFI_PROPERTY(Body, float, angularRate, AngularRate)
+DORA_FFI_PROPERTY(Body, float, linearDamping, LinearDamping)
+DORA_FFI_PROPERTY(Body, float, angularDamping, AngularDamping)
+
+DORA_FFI_GETTER(Action, float, duration, getDuration)
+DORA_FFI_GETTER(Action, bool, running, isRunning)
+DORA_FFI_GETTER(Action, bool, paused, isPaused)
+DORA_FFI_PROPERTY_BOOL(Action, reversed, Reversed)
+DORA_FFI_PROPERTY(Action, float, speed, Speed)
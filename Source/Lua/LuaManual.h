@@ -30,6 +30,8 @@ inline Content* Content_shared() { return &SharedContent; }
 
 /* Director */
 inline Director* Director_shared() { return &SharedDirector; }
+inline void Director_setPipelined(Director* self, bool var) { SharedRendererManager.setPipelined(var); }
+inline bool Director_isPipelined(Director* self) { return SharedRendererManager.isPipelined(); }
 
 /* View */
 inline View* View_shared() { return &SharedView; }
@@ -41,14 +43,21 @@ inline void Dora_Log(String msg) { Log("%s", msg); }
 int Node_emit(lua_State* L);
 int Node_slot(lua_State* L);
 int Node_gslot(lua_State* L);
+int Node_schedule(lua_State* L);
+
+/* LuaBatch */
+int LuaBatch_create(lua_State* L);
 
 /* Cache */
 struct Cache
 {
 	static bool load(String filename);
 	static void loadAsync(String filename, const function<void()>& callback);
+	static void prewarmFont(String fontName, Uint32 fontSize, String text, const function<void()>& callback, bool sdf = false);
+	static Uint32 getFontAtlasCount();
 	static void update(String filename, String content);
 	static void update(String filename, Texture2D* texture);
+	static bool convert(String filename, String target);
 	static void unload();
 	static bool unload(String name);
 	static void removeUnused();
@@ -59,13 +68,13 @@ struct Cache
 Sprite* Sprite_create(String clipStr);
 
 /* Vec2 */
-Vec2* Vec2_create(float x, float y);
+Vec2 Vec2_create(float x, float y);
 
 /* Size */
-Size* Size_create(float width, float height);
+Size Size_create(float width, float height);
 
 /* BlendFunc */
-BlendFunc* BlendFunc_create(Uint32 src, Uint32 dst);
+BlendFunc BlendFunc_create(Uint32 src, Uint32 dst);
 
 /* Action */
 int Action_create(lua_State* L);
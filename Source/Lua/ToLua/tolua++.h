@@ -39,6 +39,7 @@ NS_DOROTHY_BEGIN
 #define MT_DIV 10
 #define MT_LT 11
 #define MT_LE 12
+#define MT_TYPE 13
 
 #define TOLUA_REG_INDEX_UBOX 1
 #define TOLUA_REG_INDEX_CALLBACK 2
@@ -57,6 +58,24 @@ typedef struct tolua_Error tolua_Error;
 #define TOLUA_NOPEER LUA_REGISTRYINDEX /* for lua 5.1 */
 
 class Object;
+struct Vec2;
+struct Size;
+struct Rect;
+struct Color3;
+struct Color;
+struct BlendFunc;
+
+/* Small value types passed to lua by copy, stored inline in the userdata
+ without C++ heap allocation. They are registered without collector,
+ keep in sync with the _value_types in Tools/tolua++/basic.lua. */
+template <typename T>
+struct tolua_isvaluetype : std::false_type { };
+template <> struct tolua_isvaluetype<Vec2> : std::true_type { };
+template <> struct tolua_isvaluetype<Size> : std::true_type { };
+template <> struct tolua_isvaluetype<Rect> : std::true_type { };
+template <> struct tolua_isvaluetype<Color3> : std::true_type { };
+template <> struct tolua_isvaluetype<Color> : std::true_type { };
+template <> struct tolua_isvaluetype<BlendFunc> : std::true_type { };
 
 Slice tolua_typename(lua_State* L, int lo);
 void tolua_error(lua_State* L, const char* msg, tolua_Error* err);
@@ -70,7 +89,9 @@ int tolua_istable(lua_State* L, int lo, int def, tolua_Error* err);
 int tolua_isusertable(lua_State* L, int lo, const char* type, int def, tolua_Error* err);
 int tolua_isuserdata(lua_State* L, int lo, int def, tolua_Error* err);
 int tolua_istype(lua_State* L, int lo, const char* type);
+int tolua_istype(lua_State* L, int lo, int typeId);
 int tolua_isusertype(lua_State* L, int lo, const char* type, int def, tolua_Error* err);
+int tolua_isusertype(lua_State* L, int lo, int typeId, int def, tolua_Error* err);
 int tolua_isvaluearray(lua_State* L, int lo, int dim, int def, tolua_Error* err);
 int tolua_isbooleanarray(lua_State* L, int lo, int dim, int def, tolua_Error* err);
 int tolua_isnumberarray(lua_State* L, int lo, int dim, int def, tolua_Error* err);
@@ -104,6 +125,7 @@ void tolua_pushnumber(lua_State* L, lua_Number value);
 void tolua_pushstring(lua_State* L, const char* value);
 void tolua_pushstring(lua_State* L, const char* value, size_t len);
 void tolua_pushusertype(lua_State* L, void* value, int typeId);
+void* tolua_newvaluetype(lua_State* L, size_t size, int typeId);
 void tolua_pushfieldvalue(lua_State* L, int lo, int index, int v);
 void tolua_pushfieldboolean(lua_State* L, int lo, int index, int v);
 void tolua_pushfieldnumber(lua_State* L, int lo, int index, lua_Number v);
@@ -145,6 +167,13 @@ int tolua_fast_isa(lua_State *L, int mt_indexa, int mt_indexb);
 int tolua_isobject(lua_State* L, int mt_idx);
 void tolua_typeid(lua_State *L, int typeId, const char* className);
 
+/* type id based class hierarchy */
+void tolua_registertype(int typeId, const char* className);
+void tolua_setsupertype(int typeId, int superTypeId);
+bool tolua_isa(int typeId, int superTypeId);
+int tolua_gettypeid(lua_State* L, const char* className);
+const char* tolua_typeidname(int typeId);
+
 /* tolua_fix */
 int tolua_ref_function(lua_State* L, int lo);
 void tolua_get_function_by_refid(lua_State* L, int refid);
@@ -159,6 +188,15 @@ void tolua_pushslice(lua_State* L, String str);
 #define tolua_isslicearray tolua_isstringarray
 Slice tolua_tofieldslice(lua_State* L, int lo, int index, const char* def);
 
+template <typename T>
+void tolua_pushvaluetype(lua_State* L, const T& value)
+{
+	static_assert(tolua_isvaluetype<T>::value && std::is_trivially_destructible<T>::value,
+		"only trivially destructible value type can be stored inline.");
+	void* data = tolua_newvaluetype(L, sizeof(T), LuaType<T>());
+	if (data) ::new (data) T(value);
+}
+
 #ifndef Mtolua_new
 	#define Mtolua_new(EXP) new EXP
 #endif
@@ -86,23 +86,15 @@ void tolua_pushobject(lua_State* L, Object* object)
 void tolua_typeid(lua_State* L, int typeId, const char* className)
 {
 	lua_getfield(L, LUA_REGISTRYINDEX, className); // mt
+	lua_pushinteger(L, typeId); // mt id
+	lua_rawseti(L, -2, MT_TYPE); // mt[MT_TYPE] = id, mt
 	lua_rawseti(L, LUA_REGISTRYINDEX, typeId); // empty
+	tolua_registertype(typeId, className);
 }
 
 int tolua_isobject(lua_State* L, int lo)
 {
-	if (lua_isuserdata(L, lo))
-	{
-		lua_getmetatable(L, lo); // mt
-		lua_rawgeti(L, -1, MT_SUPER); // mt super
-		lua_rawgeti(L, LUA_REGISTRYINDEX, LuaType<Object>()); // mt super objmt
-		lua_rawget(L, LUA_REGISTRYINDEX); // reg[objmt], mt super "Object"
-		lua_rawget(L, -2); // super["Object"], mt super flag
-		int result = lua_toboolean(L, -1);
-		lua_pop(L, 3); // empty
-		return result;
-	}
-	return 0;
+	return tolua_istype(L, lo, LuaType<Object>());
 }
 
 void tolua_dobuffer(lua_State* L, char* codes, unsigned int size, const char* name)
@@ -17,6 +17,82 @@
 
 NS_DOROTHY_BEGIN
 
+/* Registered types indexed by type id, each type holds flags
+ of itself and all its super classes indexed by type id. */
+struct tolua_TypeInfo
+{
+	string name;
+	vector<bool> supers;
+};
+static vector<tolua_TypeInfo> g_types;
+
+static void tolua_reservetype(int typeId)
+{
+	if (s_cast<int>(g_types.size()) <= typeId)
+	{
+		g_types.resize(typeId + 1);
+	}
+}
+
+void tolua_registertype(int typeId, const char* className)
+{
+	tolua_reservetype(typeId);
+	g_types[typeId].name = className;
+	tolua_setsupertype(typeId, typeId);
+}
+
+void tolua_setsupertype(int typeId, int superTypeId)
+{
+	if (typeId <= 0 || superTypeId <= 0) return;
+	tolua_reservetype(std::max(typeId, superTypeId));
+	vector<bool>& supers = g_types[typeId].supers;
+	const vector<bool>& superSupers = g_types[superTypeId].supers;
+	if (supers.size() < superSupers.size())
+	{
+		supers.resize(superSupers.size(), false);
+	}
+	if (s_cast<int>(supers.size()) <= superTypeId)
+	{
+		supers.resize(superTypeId + 1, false);
+	}
+	supers[superTypeId] = true;
+	if (typeId == superTypeId) return;
+	for (size_t i = 0; i < superSupers.size(); i++)
+	{
+		if (superSupers[i]) supers[i] = true;
+	}
+}
+
+bool tolua_isa(int typeId, int superTypeId)
+{
+	if (typeId <= 0 || typeId >= s_cast<int>(g_types.size())) return false;
+	const vector<bool>& supers = g_types[typeId].supers;
+	return superTypeId > 0 && superTypeId < s_cast<int>(supers.size()) && supers[superTypeId];
+}
+
+int tolua_gettypeid(lua_State* L, const char* className)
+{
+	luaL_getmetatable(L, className);// mt
+	if (!lua_istable(L, -1))
+	{
+		lua_pop(L, 1);// empty
+		return 0;
+	}
+	lua_rawgeti(L, -1, MT_TYPE);// mt id
+	int typeId = s_cast<int>(lua_tointeger(L, -1));
+	lua_pop(L, 2);// empty
+	return typeId;
+}
+
+const char* tolua_typeidname(int typeId)
+{
+	if (typeId > 0 && typeId < s_cast<int>(g_types.size()))
+	{
+		return g_types[typeId].name.c_str();
+	}
+	return "[undefined]";
+}
+
 /* a fast check if a is b, without parameter validation
  i.e. if b is equal to a or a superclass of a. */
 int tolua_fast_isa(lua_State *L, int mt_indexa, int mt_indexb)
@@ -135,36 +211,20 @@ static int lua_isusertable(lua_State* L, int lo, const char* type)
 }
 
 /* the equivalent of lua_is* for usertype */
+int tolua_istype(lua_State* L, int lo, int typeId)
+{
+	if (!lua_isuserdata(L, lo)) return 0;
+	if (!lua_getmetatable(L, lo)) return 0;// mt
+	lua_rawgeti(L, -1, MT_TYPE);// mt id
+	int id = s_cast<int>(lua_tointeger(L, -1));
+	lua_pop(L, 2);// empty
+	return tolua_isa(id, typeId) ? 1 : 0;
+}
+
 int tolua_istype(lua_State* L, int lo, const char* type)
 {
 	if (!lua_isuserdata(L, lo)) return 0;
-	/* check if it is of the same type */
-	int r;
-	const char* tn;
-	if (lua_getmetatable(L, lo))/* if metatable? */
-	{
-		lua_rawget(L, LUA_REGISTRYINDEX);/* get registry[mt] */
-		tn = lua_tostring(L, -1);
-		r = tn && (strcmp(tn, type) == 0);
-		lua_pop(L, 1);
-		if (r) return 1;
-		else
-		{
-			/* check if it is a specialized class */
-			lua_getmetatable(L, lo);// mt
-			lua_rawgeti(L, -1, MT_SUPER);// mt tb
-			if (lua_istable(L, -1))
-			{
-				int b;
-				lua_pushstring(L, type);// mt tb type
-				lua_rawget(L, -2);// tb[type], mt tb flag
-				b = lua_toboolean(L, -1);
-				lua_pop(L, 3);
-				if (b) return 1;
-			}
-		}
-	}
-	return 0;
+	return tolua_istype(L, lo, tolua_gettypeid(L, type));
 }
 
 int tolua_isnoobj(lua_State* L, int lo, tolua_Error* err)
@@ -266,6 +326,16 @@ int tolua_isusertype(lua_State* L, int lo, const char* type, int def, tolua_Erro
 	return 0;
 }
 
+int tolua_isusertype(lua_State* L, int lo, int typeId, int def, tolua_Error* err)
+{
+	if (def && lua_gettop(L) < abs(lo)) return 1;
+	if (lua_isnil(L, lo) || tolua_istype(L, lo, typeId)) return 1;
+	err->index = lo;
+	err->array = 0;
+	err->type = tolua_typeidname(typeId);
+	return 0;
+}
+
 int tolua_isvaluearray(lua_State* L, int lo, int dim, int def, tolua_Error* err)
 {
 	if (!tolua_istable(L, lo, def, err)) return 0;
@@ -55,6 +55,9 @@ static void mapsuper(lua_State* L, const char* name, const char* base)
 		lua_pushboolean(L, 1);// mt tb base true
 		lua_rawset(L, -3);// tb[base] = true, mt tb
 
+		/* set base and its super classes as super types of name by type id */
+		tolua_setsupertype(tolua_gettypeid(L, name), tolua_gettypeid(L, base));
+
 		/* set all super class of base as super class of name */
 		luaL_getmetatable(L, base);// mt tb basemt
 		lua_rawgeti(L, -1, MT_SUPER);// mt tb basemt basetb
@@ -328,7 +331,14 @@ void tolua_module(lua_State* L, const char* name, int hasvar)
 static void push_collector(lua_State* L, lua_CFunction col)
 {
 	/* mt */
-	if (!col) return;
+	if (!col)
+	{
+		/* no finalizer for objects without collector */
+		lua_pushliteral(L, "__gc");// mt "__gc"
+		lua_pushnil(L);// mt "__gc" nil
+		lua_rawset(L, -3);// mt["__gc"] = nil, mt
+		return;
+	}
 	lua_pushcfunction(L, col);// mt cfunc
 	lua_rawseti(L, -2, MT_DEL);// mt[MT_DEL] = cfunc, mt
 }
@@ -66,6 +66,25 @@ void tolua_pushusertype(lua_State* L, void* value, int typeId)
 	lua_setfenv(L, -2);
 }
 
+/* Push a userdata holding the value inline after its pointer, so that
+ the value is converted by tolua_tousertype as other usertypes. */
+void* tolua_newvaluetype(lua_State* L, size_t size, int typeId)
+{
+	lua_rawgeti(L, LUA_REGISTRYINDEX, typeId);// mt
+	if (lua_isnil(L, -1))// mt == nil
+	{
+		Log("value pushed to lua is not registered with its class!");
+		return nullptr;// nil
+	}
+	void** ud = r_cast<void**>(lua_newuserdata(L, sizeof(void*) + size));// mt newud
+	*ud = ud + 1;
+	lua_insert(L, -2);// newud mt
+	lua_setmetatable(L, -2);// newud<mt>, newud
+	lua_pushvalue(L, TOLUA_NOPEER);
+	lua_setfenv(L, -2);
+	return *ud;
+}
+
 void tolua_pushfieldvalue(lua_State* L, int lo, int index, int v)
 {
 	lua_pushnumber(L, index);
@@ -14,6 +14,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Effect/Effect.h"
 #include "Node/Sprite.h"
 #include "Basic/View.h"
+#include "Basic/Director.h"
 
 NS_DOROTHY_BEGIN
 
@@ -111,32 +112,44 @@ void ClipNode::cleanup()
 void ClipNode::drawFullScreenStencil(Uint8 maskLayer, bool value)
 {
 	SharedRendererManager.flush();
+	float width = s_cast<float>(SharedApplication.getWidth());
+	float height = s_cast<float>(SharedApplication.getHeight());
+	Vec4 pos[4] = {
+		{0, height, 0, 1},
+		{width, height, 0, 1},
+		{0, 0, 0, 1},
+		{width, 0, 0, 1}
+	};
+	PosColorVertex vertices[4] = {};
+	Matrix ortho;
+	bx::mtxOrtho(ortho, 0, width, 0, height, 0, 1000.0f);
+	for (int i = 0; i < 4; i++)
+	{
+		bx::vec4MulMtx(&vertices[i].x, pos[i], ortho);
+	}
+	const uint16_t indices[] = {0, 1, 2, 1, 3, 2};
+	Uint32 func = BGFX_STENCIL_TEST_NEVER |
+		BGFX_STENCIL_FUNC_REF(maskLayer) | BGFX_STENCIL_FUNC_RMASK(maskLayer);
+	Uint32 fail = value ? BGFX_STENCIL_OP_FAIL_S_REPLACE : BGFX_STENCIL_OP_FAIL_S_ZERO;
+	Uint32 op = fail | BGFX_STENCIL_OP_FAIL_Z_KEEP | BGFX_STENCIL_OP_PASS_Z_KEEP;
+	Uint32 stencil = func | op;
+	if (SharedRendererManager.isRecording())
+	{
+		RenderCommand command;
+		command.decl = &PosColorVertex::ms_decl;
+		command.vertexCount = 4;
+		command.indexCount = 6;
+		command.stencil = stencil;
+		command.effect = SharedLineRenderer.getDefaultEffect();
+		SharedRendererManager.record(command, vertices, indices);
+		return;
+	}
 	bgfx::TransientVertexBuffer vertexBuffer;
 	bgfx::TransientIndexBuffer indexBuffer;
 	if (bgfx::allocTransientBuffers(&vertexBuffer, PosColorVertex::ms_decl, 4, &indexBuffer, 6))
 	{
-		float width = s_cast<float>(SharedApplication.getWidth());
-		float height = s_cast<float>(SharedApplication.getHeight());
-		Vec4 pos[4] = {
-			{0, height, 0, 1},
-			{width, height, 0, 1},
-			{0, 0, 0, 1},
-			{width, 0, 0, 1}
-		};
-		PosColorVertex* vertices = r_cast<PosColorVertex*>(vertexBuffer.data);
-		Matrix ortho;
-		bx::mtxOrtho(ortho, 0, width, 0, height, 0, 1000.0f);
-		for (int i = 0; i < 4; i++)
-		{
-			bx::vec4MulMtx(&vertices[i].x, pos[i], ortho);
-		}
-		const uint16_t indices[] = {0, 1, 2, 1, 3, 2};
+		std::memcpy(vertexBuffer.data, vertices, sizeof(PosColorVertex) * 4);
 		std::memcpy(indexBuffer.data, indices, sizeof(uint16_t) * 6);
-		Uint32 func = BGFX_STENCIL_TEST_NEVER |
-			BGFX_STENCIL_FUNC_REF(maskLayer) | BGFX_STENCIL_FUNC_RMASK(maskLayer);
-		Uint32 fail = value ? BGFX_STENCIL_OP_FAIL_S_REPLACE : BGFX_STENCIL_OP_FAIL_S_ZERO;
-		Uint32 op = fail | BGFX_STENCIL_OP_FAIL_Z_KEEP | BGFX_STENCIL_OP_PASS_Z_KEEP;
-		Uint32 stencil = func | op;
 		bgfx::setStencil(stencil);
 		bgfx::setVertexBuffer(&vertexBuffer);
 		bgfx::setIndexBuffer(&indexBuffer);
@@ -159,6 +172,73 @@ void ClipNode::drawStencil(Uint8 maskLayer, bool value)
 	});
 }
 
+bool ClipNode::getScissor(Rect& scissor)
+{
+	DrawNode* drawNode = DoraCast<DrawNode>(_stencil.get());
+	if (!drawNode) return false;
+	Array* children = drawNode->getChildren();
+	if (children && !children->isEmpty()) return false;
+	Rect bounds;
+	if (!drawNode->getRectangle(bounds)) return false;
+
+	Matrix mvp;
+	bx::mtxMul(mvp, drawNode->getWorld(), SharedDirector.getViewProjection());
+	const Vec2 corners[] = {
+		{bounds.getLeft(), bounds.getBottom()},
+		{bounds.getRight(), bounds.getBottom()},
+		{bounds.getRight(), bounds.getTop()},
+		{bounds.getLeft(), bounds.getTop()}
+	};
+	Vec2 points[4];
+	for (int i = 0; i < 4; i++)
+	{
+		Vec4 pos = {corners[i].x, corners[i].y, 0, 1};
+		Vec4 clip;
+		bx::vec4MulMtx(&clip.x, &pos.x, mvp);
+		if (clip.w <= FLT_EPSILON) return false;
+		points[i] = {clip.x / clip.w, clip.y / clip.w};
+	}
+
+	/* the rect must stay axis-aligned on screen, mirrored or rotated by 90 degrees is fine */
+	const float epsilon = 1e-4f;
+	auto equal = [epsilon](float a, float b) { return std::abs(a - b) < epsilon; };
+	bool aligned = equal(points[0].y, points[1].y) && equal(points[1].x, points[2].x)
+		&& equal(points[2].y, points[3].y) && equal(points[3].x, points[0].x);
+	bool turned = equal(points[0].x, points[1].x) && equal(points[1].y, points[2].y)
+		&& equal(points[2].x, points[3].x) && equal(points[3].y, points[0].y);
+	if (!aligned && !turned) return false;
+
+	/* map from normalized device coordinates to pixels with origin at top-left */
+	Size viewport = SharedRendererManager.getViewportSize();
+	float left = std::min(points[0].x, points[2].x);
+	float right = std::max(points[0].x, points[2].x);
+	float bottom = std::min(points[0].y, points[2].y);
+	float top = std::max(points[0].y, points[2].y);
+	left = std::floor((left + 1.0f) * 0.5f * viewport.width);
+	right = std::ceil((right + 1.0f) * 0.5f * viewport.width);
+	float upper = std::floor((1.0f - top) * 0.5f * viewport.height);
+	float lower = std::ceil((1.0f - bottom) * 0.5f * viewport.height);
+
+	/* intersect with the scissor of outer clip nodes or the viewport */
+	const Rect& current = SharedRendererManager.getCurrentScissor();
+	if (current.size.width > 0.0f)
+	{
+		left = std::max(left, current.getLeft());
+		right = std::min(right, current.getRight());
+		upper = std::max(upper, current.getBottom());
+		lower = std::min(lower, current.getTop());
+	}
+	else
+	{
+		left = std::max(left, 0.0f);
+		right = std::min(right, viewport.width);
+		upper = std::max(upper, 0.0f);
+		lower = std::min(lower, viewport.height);
+	}
+	scissor = Rect(left, upper, std::max(right - left, 0.0f), std::max(lower - upper, 0.0f));
+	return true;
+}
+
 void ClipNode::setupAlphaTest()
 {
 	if (_stencil)
@@ -188,6 +268,20 @@ void ClipNode::visit()
 		}
 		return;
 	}
+	/* rectangular clips need no stencil layers */
+	Rect scissor;
+	if (!isInverted() && getScissor(scissor))
+	{
+		/* nothing is visible when the clipped area is empty */
+		if (scissor.size.width > 0.0f && scissor.size.height > 0.0f)
+		{
+			SharedRendererManager.pushScissor(scissor, [&]()
+			{
+				Node::visit();
+			});
+		}
+		return;
+	}
 	if (_layer + 1 == 8)
 	{
 		static bool once = true;
@@ -30,6 +30,9 @@ protected:
 	ClipNode(Node* stencil);
 	void drawFullScreenStencil(Uint8 maskLayer, bool value);
 	void drawStencil(Uint8 maskLayer, bool value);
+	/** @brief get the screen rect in pixels of a stencil that is an axis-aligned
+	 rectangle on screen, so that clipping can be done with scissor test. */
+	bool getScissor(Rect& scissor);
 	void setupAlphaTest();
 private:
 	float _alphaThreshold;
@@ -21,6 +21,8 @@ NS_DOROTHY_BEGIN
 bgfx::VertexDecl DrawVertex::ms_decl;
 DrawVertex::Init DrawVertex::init;
 
+const Uint32 DrawNode::StaticVertexCount = 64;
+
 DrawNode::DrawNode():
 _blendFunc(BlendFunc::Default)
 { }
@@ -97,8 +99,40 @@ void DrawNode::render()
 			bx::vec3Mul(color, acolor, ucolor);
 			_vertices[i].abgr = Color(color).toABGR();
 		}
+		_flags.setOn(DrawNode::GeometryDirty);
 	}
 
+	_renderState = BGFX_STATE_RGB_WRITE | BGFX_STATE_ALPHA_WRITE |
+		_blendFunc.toValue();
+	if (_flags.isOn(DrawNode::DepthWrite))
+	{
+		_renderState |= (BGFX_STATE_DEPTH_WRITE | BGFX_STATE_DEPTH_TEST_LESS);
+	}
+
+	if (_vertices.size() >= DrawNode::StaticVertexCount)
+	{
+		/* upload local vertices only after edits and transform them on gpu */
+		if (_flags.isOn(DrawNode::GeometryDirty))
+		{
+			_flags.setOff(DrawNode::GeometryDirty);
+			vector<DrawVertex> vertices(_vertices);
+			for (size_t i = 0; i < vertices.size(); i++)
+			{
+				const Vec4& pos = _posColors[i].pos;
+				vertices[i].x = pos.x;
+				vertices[i].y = pos.y;
+				vertices[i].z = pos.z;
+				vertices[i].w = pos.w;
+			}
+			_geometry = GeometryBuffer::create(DrawVertex::ms_decl,
+				vertices.data(), s_cast<Uint32>(vertices.size()),
+				_indices.data(), s_cast<Uint32>(_indices.size()));
+		}
+		SharedRendererManager.draw(_geometry, SharedDrawRenderer.getDefaultModelEffect(), _renderState, _world);
+		return;
+	}
+	_geometry = nullptr;
+
 	if (_flags.isOn(DrawNode::VertexPosDirty))
 	{
 		_flags.setOff(DrawNode::VertexPosDirty);
@@ -110,13 +144,6 @@ void DrawNode::render()
 		}
 	}
 
-	_renderState = BGFX_STATE_RGB_WRITE | BGFX_STATE_ALPHA_WRITE |
-		_blendFunc.toValue();
-	if (_flags.isOn(DrawNode::DepthWrite))
-	{
-		_renderState |= (BGFX_STATE_DEPTH_WRITE | BGFX_STATE_DEPTH_TEST_LESS);
-	}
-
 	SharedDrawRenderer.push(this);
 	SharedRendererManager.setCurrent(SharedDrawRenderer.getTarget());
 }
@@ -151,6 +178,8 @@ void DrawNode::drawDot(const Vec2& pos, float radius, Color color)
 
 	_flags.setOn(DrawNode::VertexColorDirty);
 	_flags.setOn(DrawNode::VertexPosDirty);
+	_flags.setOn(DrawNode::GeometryDirty);
+	_flags.setOff(DrawNode::Rectangle);
 }
 
 void DrawNode::drawSegment(const Vec2& from, const Vec2& to, float radius, Color color)
@@ -212,6 +241,8 @@ void DrawNode::drawSegment(const Vec2& from, const Vec2& to, float radius, Color
 
 	_flags.setOn(DrawNode::VertexColorDirty);
 	_flags.setOn(DrawNode::VertexPosDirty);
+	_flags.setOn(DrawNode::GeometryDirty);
+	_flags.setOff(DrawNode::Rectangle);
 }
 
 void DrawNode::drawPolygon(const vector<Vec2>& verts, Color fillColor, float borderWidth, Color borderColor)
@@ -309,8 +340,19 @@ void DrawNode::drawPolygon(const Vec2* verts, Uint32 count, Color fillColor, flo
 		_indices.push_back(start + i);
 	}
 
+	bool rectangle = start == 0 && fillPoly && count == 4;
+	for (Uint32 i = 0; rectangle && i < count; i++)
+	{
+		Vec2 edge = verts[(i + 1) % count] - verts[i];
+		Vec2 next = verts[(i + 2) % count] - verts[(i + 1) % count];
+		// edges should alternate between horizontal and vertical ones
+		rectangle = (edge.x == 0.0f) != (edge.y == 0.0f) && (edge.x == 0.0f) == (next.y == 0.0f);
+	}
+	_flags.setFlag(DrawNode::Rectangle, rectangle);
+
 	_flags.setOn(DrawNode::VertexColorDirty);
 	_flags.setOn(DrawNode::VertexPosDirty);
+	_flags.setOn(DrawNode::GeometryDirty);
 }
 
 void DrawNode::clear()
@@ -318,12 +360,32 @@ void DrawNode::clear()
 	_posColors.clear();
 	_vertices.clear();
 	_indices.clear();
+	_geometry = nullptr;
+	_flags.setOn(DrawNode::GeometryDirty);
+	_flags.setOff(DrawNode::Rectangle);
+}
+
+bool DrawNode::getRectangle(Rect& bounds) const
+{
+	if (_flags.isOff(DrawNode::Rectangle)) return false;
+	// include the antialiased fringe that gets drawn around the shape
+	Vec2 lower = {FLT_MAX, FLT_MAX}, upper = {-FLT_MAX, -FLT_MAX};
+	for (const auto& posColor : _posColors)
+	{
+		lower.x = std::min(lower.x, posColor.pos.x);
+		lower.y = std::min(lower.y, posColor.pos.y);
+		upper.x = std::max(upper.x, posColor.pos.x);
+		upper.y = std::max(upper.y, posColor.pos.y);
+	}
+	bounds = Rect(lower, Size{upper.x - lower.x, upper.y - lower.y});
+	return true;
 }
 
 /* DrawRenderer */
 
 DrawRenderer::DrawRenderer():
 _defaultEffect(Effect::create("built-in/vs_draw.bin"_slice, "built-in/fs_draw.bin"_slice)),
+_defaultModelEffect(Effect::create("built-in/vs_spritemodel.bin"_slice, "built-in/fs_draw.bin"_slice)),
 _lastState(BGFX_STATE_NONE)
 { }
 
@@ -332,6 +394,11 @@ Effect* DrawRenderer::getDefaultEffect() const
 	return _defaultEffect;
 }
 
+Effect* DrawRenderer::getDefaultModelEffect() const
+{
+	return _defaultModelEffect;
+}
+
 void DrawRenderer::push(DrawNode* node)
 {
 	Uint64 state = node->getRenderState();
@@ -356,7 +423,20 @@ void DrawRenderer::push(DrawNode* node)
 
 void DrawRenderer::render()
 {
-	if (!_vertices.empty())
+	if (!_vertices.empty() && SharedRendererManager.isRecording())
+	{
+		RenderCommand command;
+		command.decl = &DrawVertex::ms_decl;
+		command.vertexCount = s_cast<Uint32>(_vertices.size());
+		command.indexCount = s_cast<Uint32>(_indices.size());
+		command.state = _lastState;
+		command.effect = _defaultEffect;
+		SharedRendererManager.record(command, _vertices.data(), _indices.data());
+		_vertices.clear();
+		_indices.clear();
+		_lastState = BGFX_STATE_NONE;
+	}
+	else if (!_vertices.empty())
 	{
 		bgfx::TransientVertexBuffer vertexBuffer;
 		bgfx::TransientIndexBuffer indexBuffer;
@@ -390,6 +470,8 @@ void DrawRenderer::render()
 bgfx::VertexDecl PosColorVertex::ms_decl;
 PosColorVertex::Init PosColorVertex::init;
 
+const Uint32 Line::StaticVertexCount = 64;
+
 Line::Line():
 _blendFunc{BlendFunc::One, BlendFunc::InvSrcAlpha},
 _renderState(BGFX_STATE_NONE)
@@ -558,7 +640,47 @@ void Line::render()
 			bx::vec3Mul(color, acolor, ucolor);
 			_vertices[i].abgr = Color(color).toABGR();
 		}
+		_flags.setOn(Line::GeometryDirty);
+	}
+
+	_renderState = BGFX_STATE_RGB_WRITE | BGFX_STATE_ALPHA_WRITE |
+		BGFX_STATE_PT_LINESTRIP | _blendFunc.toValue();
+	if (_flags.isOn(Line::DepthWrite))
+	{
+		_renderState |= (BGFX_STATE_DEPTH_WRITE | BGFX_STATE_DEPTH_TEST_LESS);
+	}
+
+	if (_vertices.size() >= Line::StaticVertexCount)
+	{
+		/* upload local vertices only after edits and transform them on gpu */
+		if (_flags.isOn(Line::GeometryDirty))
+		{
+			_flags.setOff(Line::GeometryDirty);
+			Vec4 ucolor = _realColor.toVec4();
+			vector<DrawVertex> vertices(_posColors.size());
+			for (size_t i = 0; i < vertices.size(); i++)
+			{
+				const PosColor& posColor = _posColors[i];
+				// premultiply alpha here as vs_poscolor does for the batched path
+				float alpha = posColor.color.w * ucolor.w;
+				Vec4 color {0, 0, 0, alpha};
+				bx::vec3Mul(color, posColor.color, ucolor);
+				bx::vec3Mul(color, color, alpha);
+				DrawVertex& vertex = vertices[i];
+				vertex.x = posColor.pos.x;
+				vertex.y = posColor.pos.y;
+				vertex.z = posColor.pos.z;
+				vertex.w = posColor.pos.w;
+				vertex.abgr = Color(color).toABGR();
+				vertex.u = vertex.v = 0.0f;
+			}
+			_geometry = GeometryBuffer::create(DrawVertex::ms_decl,
+				vertices.data(), s_cast<Uint32>(vertices.size()));
+		}
+		SharedRendererManager.draw(_geometry, SharedLineRenderer.getDefaultModelEffect(), _renderState, _world);
+		return;
 	}
+	_geometry = nullptr;
 
 	if (_flags.isOn(Line::VertexPosDirty))
 	{
@@ -571,13 +693,6 @@ void Line::render()
 		}
 	}
 
-	_renderState = BGFX_STATE_RGB_WRITE | BGFX_STATE_ALPHA_WRITE |
-		BGFX_STATE_PT_LINESTRIP | _blendFunc.toValue();
-	if (_flags.isOn(Line::DepthWrite))
-	{
-		_renderState |= (BGFX_STATE_DEPTH_WRITE | BGFX_STATE_DEPTH_TEST_LESS);
-	}
-
 	SharedLineRenderer.push(this);
 	SharedRendererManager.setCurrent(SharedLineRenderer.getTarget());
 }
@@ -586,6 +701,7 @@ void Line::render()
 
 LineRenderer::LineRenderer():
 _defaultEffect(Effect::create("built-in/vs_poscolor.bin"_slice, "built-in/fs_poscolor.bin"_slice)),
+_defaultModelEffect(Effect::create("built-in/vs_spritemodel.bin"_slice, "built-in/fs_draw.bin"_slice)),
 _lastState(BGFX_STATE_NONE)
 { }
 
@@ -594,6 +710,11 @@ Effect* LineRenderer::getDefaultEffect() const
 	return _defaultEffect;
 }
 
+Effect* LineRenderer::getDefaultModelEffect() const
+{
+	return _defaultModelEffect;
+}
+
 void LineRenderer::push(Line* line)
 {
 	Uint64 state = line->getRenderState();
@@ -616,7 +737,18 @@ void LineRenderer::push(Line* line)
 
 void LineRenderer::render()
 {
-	if (!_vertices.empty())
+	if (!_vertices.empty() && SharedRendererManager.isRecording())
+	{
+		RenderCommand command;
+		command.decl = &PosColorVertex::ms_decl;
+		command.vertexCount = s_cast<Uint32>(_vertices.size());
+		command.state = _lastState;
+		command.effect = _defaultEffect;
+		SharedRendererManager.record(command, _vertices.data());
+		_vertices.clear();
+		_lastState = BGFX_STATE_NONE;
+	}
+	else if (!_vertices.empty())
 	{
 		bgfx::TransientVertexBuffer vertexBuffer;
 		Uint32 vertexCount = s_cast<Uint32>(_vertices.size());
@@ -55,6 +55,12 @@ public:
 	void drawPolygon(const vector<Vec2>& verts, Color fillColor, float borderWidth, Color borderColor);
 	void drawPolygon(const Vec2* verts, Uint32 count, Color fillColor, float borderWidth = 0.0f, Color borderColor = Color());
 	void clear();
+	/** @brief get the local bounds when everything drawn is a single filled
+	 axis-aligned rectangle, returns false otherwise. */
+	bool getRectangle(Rect& bounds) const;
+	/** @brief shapes with at least this many vertices are kept in static gpu buffers
+	 and transformed on gpu, smaller ones are batched with others. */
+	static const Uint32 StaticVertexCount;
 	CREATE_FUNC(DrawNode);
 protected:
 	DrawNode();
@@ -72,11 +78,14 @@ private:
 	vector<DrawVertex> _vertices;
 	vector<PosColor> _posColors;
 	vector<Uint16> _indices;
+	Ref<GeometryBuffer> _geometry;
 	enum
 	{
 		VertexColorDirty = Node::UserFlag,
 		VertexPosDirty = Node::UserFlag << 1,
 		DepthWrite = Node::UserFlag << 2,
+		GeometryDirty = Node::UserFlag << 3,
+		Rectangle = Node::UserFlag << 4,
 	};
 	DORA_TYPE_OVERRIDE(DrawNode);
 };
@@ -85,6 +94,7 @@ class DrawRenderer : public Renderer
 {
 public:
 	PROPERTY_READONLY(Effect*, DefaultEffect);
+	PROPERTY_READONLY(Effect*, DefaultModelEffect);
 	virtual ~DrawRenderer() { }
 	virtual void render() override;
 	void push(DrawNode* node);
@@ -92,6 +102,7 @@ protected:
 	DrawRenderer();
 private:
 	Ref<Effect> _defaultEffect;
+	Ref<Effect> _defaultModelEffect;
 	Uint64 _lastState;
 	vector<DrawVertex> _vertices;
 	vector<Uint16> _indices;
@@ -136,6 +147,8 @@ public:
 	void set(const vector<Vec2>& verts, Color color);
 	void set(const Vec2* verts, Uint32 size, Color color);
 	void clear();
+	/** @brief lines with at least this many vertices are kept in static gpu buffers. */
+	static const Uint32 StaticVertexCount;
 	CREATE_FUNC(Line);
 protected:
 	Line();
@@ -153,11 +166,13 @@ private:
 	BlendFunc _blendFunc;
 	vector<PosColor> _posColors;
 	vector<PosColorVertex> _vertices;
+	Ref<GeometryBuffer> _geometry;
 	enum
 	{
 		VertexColorDirty = Node::UserFlag,
 		VertexPosDirty = Node::UserFlag << 1,
 		DepthWrite = Node::UserFlag << 2,
+		GeometryDirty = Node::UserFlag << 3,
 	};
 	DORA_TYPE_OVERRIDE(Line);
 };
@@ -166,6 +181,8 @@ class LineRenderer: public Renderer
 {
 public:
 	PROPERTY_READONLY(Effect*, DefaultEffect);
+	/** @brief draws static lines with premultiplied DrawVertex colors. */
+	PROPERTY_READONLY(Effect*, DefaultModelEffect);
 	virtual ~LineRenderer() { }
 	virtual void render() override;
 	void push(Line* line);
@@ -173,6 +190,7 @@ protected:
 	LineRenderer();
 private:
 	Ref<Effect> _defaultEffect;
+	Ref<Effect> _defaultModelEffect;
 	Uint64 _lastState;
 	vector<PosColorVertex> _vertices;
 	SINGLETON_REF(LineRenderer, RendererManager);
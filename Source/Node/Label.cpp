@@ -15,6 +15,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Effect/Effect.h"
 #include "Cache/ShaderCache.h"
 #include "Basic/Content.h"
+#include "Basic/Director.h"
+#include "Common/Async.h"
 #include "fmt/format.h"
 
 NS_DOROTHY_BEGIN
@@ -46,9 +48,11 @@ bgfx::FontHandle Font::getHandle() const
 	return _handle;
 }
 
-Font::Font(TrueTypeFile* file, bgfx::FontHandle handle):
+Font::Font(TrueTypeFile* file, bgfx::FontHandle handle, Font* master):
 _file(file),
-_handle(handle)
+_handle(handle),
+_master(master),
+_asciiGlyphs{}
 { }
 
 Font::~Font()
@@ -70,12 +74,178 @@ TrueTypeFile* Font::getFile() const
 	return _file;
 }
 
+bool Font::isSDF() const
+{
+	return _master != nullptr;
+}
+
+void Font::setGlyphInfo(Uint32 code, const bgfx::GlyphInfo* glyph)
+{
+	if (code < 128)
+	{
+		_asciiGlyphs[code] = glyph;
+	}
+	else
+	{
+		_glyphs[code] = glyph;
+	}
+}
+
+const bgfx::GlyphInfo* Font::findGlyphInfo(Uint32 code)
+{
+	const bgfx::GlyphInfo* glyph = nullptr;
+	if (code < 128)
+	{
+		glyph = _asciiGlyphs[code];
+	}
+	else
+	{
+		auto it = _glyphs.find(code);
+		if (it != _glyphs.end())
+		{
+			glyph = it->second;
+		}
+	}
+	if (!glyph)
+	{
+		glyph = SharedFontManager.findGlyphInfo(_handle, code);
+		if (glyph)
+		{
+			setGlyphInfo(code, glyph);
+		}
+	}
+	return glyph;
+}
+
+const bgfx::GlyphInfo* Font::getGlyphInfo(Uint32 code)
+{
+	const bgfx::GlyphInfo* glyph = findGlyphInfo(code);
+	if (!glyph)
+	{
+		glyph = SharedFontManager.getGlyphInfo(_handle, code);
+		setGlyphInfo(code, glyph);
+	}
+	return glyph;
+}
+
+bool Font::isGlyphMissing(Uint32 code) const
+{
+	return _missingGlyphs.find(code) != _missingGlyphs.end();
+}
+
+void Font::loadGlyphsAsync(const vector<Uint32>& codes, const function<void()>& callback)
+{
+	vector<Uint32> missing;
+	bool loading = false;
+	for (Uint32 code : codes)
+	{
+		if (findGlyphInfo(code) || isGlyphMissing(code)) continue;
+		if (_loadingGlyphs.find(code) != _loadingGlyphs.end())
+		{
+			loading = true;
+			continue;
+		}
+		_loadingGlyphs.insert(code);
+		missing.push_back(code);
+	}
+	if (missing.empty())
+	{
+		if (loading) _loadingCallbacks.push_back(callback);
+		else callback();
+		return;
+	}
+	bgfx::FontHandle handle = _handle;
+	SharedAsyncThread.Process.run([handle, missing]()
+	{
+		auto glyphs = new vector<BakedGlyph>(missing.size());
+		vector<Uint8> buffer(MAX_FONT_BUFFER_SIZE);
+		for (size_t i = 0; i < missing.size(); i++)
+		{
+			BakedGlyph& glyph = (*glyphs)[i];
+			glyph.code = missing[i];
+			glyph.baked = SharedFontManager.bakeGlyph(handle, glyph.code, glyph.info, buffer.data());
+			if (glyph.baked)
+			{
+				size_t size = s_cast<size_t>(std::ceil(glyph.info.width) * std::ceil(glyph.info.height));
+				glyph.bitmap.assign(buffer.begin(), buffer.begin() + size);
+			}
+		}
+		return Values::create(glyphs);
+	}, [font = Ref<Font>(this), callback](Values* result)
+	{
+		vector<BakedGlyph>* glyphs;
+		result->get(glyphs);
+		for (BakedGlyph& glyph : *glyphs)
+		{
+			if (glyph.baked)
+			{
+				SharedFontManager.addGlyph(font->_handle, glyph.code, glyph.info, glyph.bitmap.data());
+			}
+			// glyphs failed to bake get fallback from the synchronized path
+			if (!font->getGlyphInfo(glyph.code))
+			{
+				font->_missingGlyphs.insert(glyph.code);
+			}
+			font->_loadingGlyphs.erase(glyph.code);
+		}
+		delete glyphs;
+		vector<function<void()>> callbacks;
+		callbacks.swap(font->_loadingCallbacks);
+		callback();
+		for (const auto& loadingCallback : callbacks)
+		{
+			loadingCallback();
+		}
+	});
+}
+
+float Font::getKerning(Uint32 left, Uint32 right)
+{
+	Uint64 key = (s_cast<Uint64>(left) << 32) | right;
+	auto it = _kernings.find(key);
+	if (it != _kernings.end())
+	{
+		return it->second;
+	}
+	float kerning = s_cast<float>(s_cast<Sint32>(SharedFontManager.getKerning(_handle, left, right)));
+	_kernings[key] = kerning;
+	return kerning;
+}
+
 /* FontCache */
 
+const Uint32 FontCache::SDFBaseSize = 48;
+
 FontCache::FontCache():
 _defaultEffect(SpriteEffect::create("built-in/vs_sprite.bin"_slice, "built-in/fs_spritewhite.bin"_slice))
 { }
 
+SpriteEffect* FontCache::getSDFEffect()
+{
+	if (!_sdfEffect)
+	{
+		switch (bgfx::getCaps()->rendererType)
+		{
+		case bgfx::RendererType::Direct3D9:
+		case bgfx::RendererType::Direct3D11:
+		case bgfx::RendererType::Direct3D12:
+			// no compiled binaries of the sdf shader for Direct3D yet,
+			// the distance field is drawn as coverage instead
+			_sdfEffect = _defaultEffect;
+			break;
+		default:
+			_sdfEffect = SpriteEffect::create("built-in/vs_sprite.bin"_slice, "built-in/fs_spritesdf.bin"_slice);
+			break;
+		}
+	}
+	return _sdfEffect;
+}
+
+SpriteEffect* FontCache::getCharacterEffect(Font* font)
+{
+	return font->isSDF() ? getSDFEffect() : _defaultEffect.get();
+}
+
 FontCache::~FontCache()
 {
 	unload();
@@ -92,10 +262,11 @@ bool FontCache::unload()
 	return true;
 }
 
-bool FontCache::unload(String fontName, Uint32 fontSize)
+bool FontCache::unload(String fontName, Uint32 fontSize, bool sdf)
 {
 	fmt::MemoryWriter writer;
 	writer << fontName.toString() << ':' << fontSize;
+	if (sdf) writer << ":sdf";
 	string fontFaceName = writer.str();
 	auto fontIt = _fonts.find(fontFaceName);
 	if (fontIt != _fonts.end())
@@ -135,10 +306,36 @@ void FontCache::removeUnused()
 	}
 }
 
-Font* FontCache::load(String fontName, Uint32 fontSize)
+Font* FontCache::createFont(TrueTypeFile* file, String fontName, Uint32 fontSize, bool sdf)
+{
+	if (sdf)
+	{
+		/* glyphs of all sizes are scaled from one distance field master font */
+		string masterName = fontName.toString() + ":sdf";
+		Font* master = nullptr;
+		auto it = _fonts.find(masterName);
+		if (it != _fonts.end())
+		{
+			master = it->second;
+		}
+		else
+		{
+			bgfx::FontHandle masterHandle = SharedFontManager.createFontByPixelSize(file->getHandle(), 0, FontCache::SDFBaseSize, FONT_TYPE_DISTANCE);
+			master = Font::create(file, masterHandle);
+			_fonts[masterName] = master;
+		}
+		bgfx::FontHandle fontHandle = SharedFontManager.createScaledFontToPixelSize(master->getHandle(), fontSize);
+		return Font::create(file, fontHandle, master);
+	}
+	bgfx::FontHandle fontHandle = SharedFontManager.createFontByPixelSize(file->getHandle(), 0, fontSize);
+	return Font::create(file, fontHandle);
+}
+
+Font* FontCache::load(String fontName, Uint32 fontSize, bool sdf)
 {
 	fmt::MemoryWriter writer;
 	writer << fontName.toString() << ':' << fontSize;
+	if (sdf) writer << ":sdf";
 	string fontFaceName = writer.str();
 	auto fontIt = _fonts.find(fontFaceName);
 	if (fontIt != _fonts.end())
@@ -150,8 +347,7 @@ Font* FontCache::load(String fontName, Uint32 fontSize)
 		auto fileIt = _fontFiles.find(fontName);
 		if (fileIt != _fontFiles.end())
 		{
-			bgfx::FontHandle fontHandle = SharedFontManager.createFontByPixelSize(fileIt->second->getHandle(), 0, fontSize);
-			Font* font = Font::create(fileIt->second, fontHandle);
+			Font* font = createFont(fileIt->second, fontName, fontSize, sdf);
 			_fonts[fontFaceName] = font;
 			return font;
 		}
@@ -171,18 +367,18 @@ Font* FontCache::load(String fontName, Uint32 fontSize)
 			bgfx::TrueTypeHandle trueTypeHandle = SharedFontManager.createTtf(data, s_cast<Uint32>(data.size()));
 			TrueTypeFile* file = TrueTypeFile::create(trueTypeHandle);
 			_fontFiles[fontName] = file;
-			bgfx::FontHandle fontHandle = SharedFontManager.createFontByPixelSize(trueTypeHandle, 0, fontSize);
-			Font* font = Font::create(file, fontHandle);
+			Font* font = createFont(file, fontName, fontSize, sdf);
 			_fonts[fontFaceName] = font;
 			return font;
 		}
 	}
 }
 
-void FontCache::loadAync(String fontName, Uint32 fontSize, const function<void(Font* fontHandle)>& callback)
+void FontCache::loadAync(String fontName, Uint32 fontSize, const function<void(Font* fontHandle)>& callback, bool sdf)
 {
 	fmt::MemoryWriter writer;
 	writer << fontName.toString() << ':' << fontSize;
+	if (sdf) writer << ":sdf";
 	string fontFaceName = writer.str();
 	auto faceIt = _fonts.find(fontFaceName);
 	if (faceIt != _fonts.end())
@@ -194,8 +390,7 @@ void FontCache::loadAync(String fontName, Uint32 fontSize, const function<void(F
 		auto fileIt = _fontFiles.find(fontName);
 		if (fileIt != _fontFiles.end())
 		{
-			bgfx::FontHandle fontHandle = SharedFontManager.createFontByPixelSize(fileIt->second->getHandle(), 0, fontSize);
-			Font* font = Font::create(fileIt->second, fontHandle);
+			Font* font = createFont(fileIt->second, fontName, fontSize, sdf);
 			_fonts[fontFaceName] = font;
 			callback(font);
 		}
@@ -208,15 +403,16 @@ void FontCache::loadAync(String fontName, Uint32 fontSize, const function<void(F
 				if (!SharedContent.isExist(fontFile))
 				{
 					callback(nullptr);
+					return;
 				}
 			}
-			SharedContent.loadFileAsyncUnsafe(fontFile, [this, fontFaceName, fontName, fontSize, callback](Uint8* data, Sint64 size)
+			string name = fontName.toString();
+			SharedContent.loadFileAsyncUnsafe(fontFile, [this, fontFaceName, name, fontSize, sdf, callback](Uint8* data, Sint64 size)
 			{
 				bgfx::TrueTypeHandle trueTypeHandle = SharedFontManager.createTtf(data, s_cast<Uint32>(size));
 				TrueTypeFile* file = TrueTypeFile::create(trueTypeHandle);
-				_fontFiles[fontName] = file;
-				bgfx::FontHandle fontHandle = SharedFontManager.createFontByPixelSize(trueTypeHandle, 0, fontSize);
-				Font* font = Font::create(file, fontHandle);
+				_fontFiles[name] = file;
+				Font* font = createFont(file, name, fontSize, sdf);
 				_fonts[fontFaceName] = font;
 				callback(font);
 			});
@@ -230,13 +426,18 @@ Sprite* FontCache::createCharacter(Font* font, bgfx::CodePoint character)
 	Rect rect;
 	std::tie(texture, rect) = getCharacterInfo(font, character);
 	Sprite* sprite = Sprite::create(texture, rect);
-	sprite->setEffect(_defaultEffect);
+	sprite->setEffect(getCharacterEffect(font));
+	if (font->isSDF())
+	{
+		sprite->setScaleX(font->getInfo().scale);
+		sprite->setScaleY(font->getInfo().scale);
+	}
 	return sprite;
 }
 
 std::tuple<Texture2D*, Rect> FontCache::getCharacterInfo(Font* font, bgfx::CodePoint character)
 {
-	const bgfx::GlyphInfo* glyphInfo = SharedFontManager.getGlyphInfo(font->getHandle(), character);
+	const bgfx::GlyphInfo* glyphInfo = font->getGlyphInfo(character);
 	bgfx::Atlas* atlas = glyphInfo->atlas;
 	const bgfx::AtlasRegion& region = atlas->getRegion(glyphInfo->regionIndex);
 	return std::make_tuple(atlas->getTexture(), Rect(region.x, region.y, region.width, region.height));
@@ -244,17 +445,22 @@ std::tuple<Texture2D*, Rect> FontCache::getCharacterInfo(Font* font, bgfx::CodeP
 
 const bgfx::GlyphInfo* FontCache::getGlyphInfo(Font* font, bgfx::CodePoint character)
 {
-	return SharedFontManager.getGlyphInfo(font->getHandle(), character);
+	return font->getGlyphInfo(character);
 }
 
 const bgfx::GlyphInfo* FontCache::updateCharacter(Sprite* sp, Font* font, bgfx::CodePoint character)
 {
-	const bgfx::GlyphInfo* glyphInfo = SharedFontManager.getGlyphInfo(font->getHandle(), character);
+	const bgfx::GlyphInfo* glyphInfo = font->getGlyphInfo(character);
 	bgfx::Atlas* atlas = glyphInfo->atlas;
 	const bgfx::AtlasRegion& region = atlas->getRegion(glyphInfo->regionIndex);
 	sp->setTexture(atlas->getTexture());
 	sp->setTextureRect(Rect(region.x, region.y, region.width, region.height));
 	sp->setSize(sp->getTextureRect().size);
+	if (font->isSDF())
+	{
+		sp->setScaleX(font->getInfo().scale);
+		sp->setScaleY(font->getInfo().scale);
+	}
 	return glyphInfo;
 }
 
@@ -262,12 +468,14 @@ const bgfx::GlyphInfo* FontCache::updateCharacter(Sprite* sp, Font* font, bgfx::
 
 const float Label::AutomaticWidth = -1.0f;
 
-Label::Label(String fontName, Uint32 fontSize):
+Label::Label(String fontName, Uint32 fontSize, bool sdf):
 _lineGap(0),
 _textWidth(Label::AutomaticWidth),
 _alignment(TextAlignment::Center),
-_font(SharedFontCache.load(fontName, fontSize)),
-_blendFunc(BlendFunc::Default)
+_font(SharedFontCache.load(fontName, fontSize, sdf)),
+_blendFunc(BlendFunc::Default),
+_offset(Vec2::zero),
+_batchStart(0)
 {
 	_flags.setOff(Node::TraverseEnabled);
 }
@@ -284,6 +492,7 @@ void Label::setTextWidth(float var)
 	if (_textWidth != var)
 	{
 		_textWidth = var;
+		_lines.clear();
 		updateLabel();
 	}
 }
@@ -298,7 +507,7 @@ void Label::setLineGap(float var)
 	if (_lineGap != var)
 	{
 		_lineGap = var;
-		updateLabel();
+		updateCharacters(0);
 	}
 }
 
@@ -312,7 +521,7 @@ void Label::setAlignment(TextAlignment var)
 	if (_alignment != var)
 	{
 		_alignment = var;
-		updateLabel();
+		updateCharacters(0);
 	}
 }
 
@@ -323,9 +532,8 @@ TextAlignment Label::getAlignment() const
 
 void Label::setText(const char* var)
 {
-	_textUTF8 = var;
-	_text = utf8_get_characters(_textUTF8.c_str());
-	updateLabel();
+	if (_textUTF8 == var) return;
+	updateText(var);
 }
 
 const char* Label::getText() const
@@ -336,7 +544,7 @@ const char* Label::getText() const
 void Label::setBlendFunc(const BlendFunc& var)
 {
 	_blendFunc = var;
-	for (Sprite* fontChar : _characters)
+	for (Sprite* fontChar : _sprites)
 	{
 		if (fontChar)
 		{
@@ -350,11 +558,17 @@ const BlendFunc& Label::getBlendFunc() const
 	return _blendFunc;
 }
 
-Sprite* Label::getCharacter(int index) const
+Sprite* Label::getCharacter(int index)
 {
 	if (0 <= index && index < s_cast<int>(_text.size()))
 	{
-		return _characters[index];
+		if (_flags.isOff(Label::SpriteMode))
+		{
+			_flags.setOn(Label::SpriteMode);
+			_batches.clear();
+			updateSprites(0);
+		}
+		return _sprites[index];
 	}
 	return nullptr;
 }
@@ -364,79 +578,77 @@ int Label::getCharacterCount() const
 	return s_cast<int>(_text.size());
 }
 
-float Label::getLetterPosXLeft(Sprite* sp)
+float Label::getLetterPosXRight(const CharItem& item)
 {
-	return sp->getX() - sp->getAnchorPoint().x;
+	return item.pos.x + item.rect.getWidth() * _font->getInfo().scale * 0.5f;
 }
 
-float Label::getLetterPosXRight(Sprite* sp)
+void Label::updateRealColor3()
 {
-	return sp->getX() + sp->getAnchorPoint().x;
+	Node::updateRealColor3();
+	_flags.setOn(Label::VertexColorDirty);
 }
 
-void Label::updateCharacters(const vector<Uint32>& chars)
+void Label::updateRealOpacity()
 {
-	float nextFontPositionX = 0;
-	float nextFontPositionY = 0;
-	Uint32 prev = 0;
-	float kerningAmount = 0;
-	Size finalSize;
-	float longestLine = 0;
-	float totalHeight = 0;
-	Uint32 quantityOfLines = 1;
-
-	if (_characters.size() > chars.size())
-	{
-		for (size_t i = chars.size(); i < _characters.size(); i++)
-		{
-			if (_characters[i])
-			{
-				_characters[i]->setVisible(false);
-			}
-		}
-	}
+	Node::updateRealOpacity();
+	_flags.setOn(Label::VertexColorDirty);
+}
 
-	if (_characters.size() < chars.size())
+const float* Label::getWorld()
+{
+	if (_flags.isOn(Node::WorldDirty))
 	{
-		_characters.resize(chars.size());
+		_flags.setOn(Label::VertexPosDirty);
 	}
+	return Node::getWorld();
+}
 
-	for (Uint32 ch : chars)
+void Label::layoutLine(TextLine& line)
+{
+	line.text.clear();
+	line.characters.clear();
+	line.widths.clear();
+	line.pending = false;
+	vector<float> pens;
+	float penX = 0;
+	Uint32 prev = 0;
+	size_t lineStart = 0;
+	auto getLineWidth = [&]()
 	{
-		if (ch == '\n')
+		float width = 0.0f;
+		for (size_t i = lineStart; i < line.characters.size(); i++)
 		{
-			quantityOfLines++;
+			const CharItem& item = line.characters[i];
+			if (item.texture)
+			{
+				width = std::max(width, getLetterPosXRight(item));
+			}
 		}
-	}
-
-	float commonHeight = _font->getInfo().commonHeight - _font->getInfo().lineGap + _lineGap;
-	totalHeight = commonHeight * quantityOfLines;
-	nextFontPositionY = 0 - (commonHeight - commonHeight * quantityOfLines);
-
-	const bgfx::GlyphInfo* fontDef = nullptr;
-	for (size_t i = 0; i < chars.size(); i++)
+		return width;
+	};
+	for (Uint32 ch : line.source)
 	{
-		Uint32 ch = chars[i];
-		Sprite* fontChar = _characters[i];
-
-		if (ch == '\n')
+		const bgfx::GlyphInfo* fontDef = _font->findGlyphInfo(ch);
+		if (!fontDef && !_font->isGlyphMissing(ch))
 		{
-			nextFontPositionX = 0;
-			nextFontPositionY -= commonHeight;
-			if (fontChar)
-			{
-				fontChar->setVisible(false);
-			}
+			// Glyph is being baked, keep an invisible placeholder and relayout later.
+			_pendingGlyphs.push_back(ch);
+			line.pending = true;
+			CharItem item;
+			item.code = ch;
+			item.pos = Vec2{penX, 0.0f};
+			line.characters.push_back(item);
+			line.text.push_back(ch);
+			pens.push_back(penX);
+			penX += _font->getInfo().pixelSize * (ch < 128 ? 0.5f : 1.0f);
+			prev = 0;
 			continue;
 		}
-
-		kerningAmount = s_cast<float>(SharedFontManager.getKerning(_font->getHandle(), prev, ch));
-
-		fontDef = SharedFontCache.getGlyphInfo(_font, ch);
 		if (!fontDef)
 		{
 			ch = '?';
-			fontDef = SharedFontCache.getGlyphInfo(_font, '?');
+			fontDef = _font->getGlyphInfo('?');
 			if (!fontDef)
 			{
 				Log("attempted to use character not defined in this font: %d", ch);
@@ -444,313 +656,451 @@ void Label::updateCharacters(const vector<Uint32>& chars)
 			}
 		}
 
-		if (fontChar)
+		float kerningAmount = prev ? _font->getKerning(prev, ch) : 0.0f;
+		float left = penX + fontDef->offset_x + kerningAmount;
+
+		// Out of bounds, wrap the line before the current word or character.
+		if (_textWidth >= 0 && line.characters.size() > lineStart &&
+			!utf8_isspace(ch) && left + fontDef->width > _textWidth)
 		{
-			SharedFontCache.updateCharacter(fontChar, _font, ch);
-			fontChar->setVisible(true);
+			size_t breakPos = line.characters.size();
+			if (ch <= 255 && std::isalnum(ch))
+			{
+				for (size_t i = line.characters.size(); i > lineStart; i--)
+				{
+					Uint32 code = line.text[i - 1];
+					if (code > 255 || !std::isalnum(code))
+					{
+						breakPos = i;
+						break;
+					}
+				}
+			}
+			float shift = breakPos < pens.size() ? pens[breakPos] : penX;
+			vector<CharItem> movedChars(line.characters.begin() + breakPos, line.characters.end());
+			vector<Uint32> movedText(line.text.begin() + breakPos, line.text.end());
+			vector<float> movedPens(pens.begin() + breakPos, pens.end());
+			line.characters.resize(breakPos);
+			line.text.resize(breakPos);
+			pens.resize(breakPos);
+			while (line.text.size() > lineStart && utf8_isspace(line.text.back()))
+			{
+				line.characters.pop_back();
+				line.text.pop_back();
+				pens.pop_back();
+			}
+			line.widths.push_back(getLineWidth());
+			CharItem lineBreak;
+			lineBreak.code = '\n';
+			line.characters.push_back(lineBreak);
+			line.text.push_back('\n');
+			pens.push_back(0.0f);
+			lineStart = line.characters.size();
+			for (size_t i = 0; i < movedChars.size(); i++)
+			{
+				movedChars[i].pos.x -= shift;
+				line.characters.push_back(movedChars[i]);
+				line.text.push_back(movedText[i]);
+				pens.push_back(movedPens[i] - shift);
+			}
+			penX -= shift;
+			left -= shift;
 		}
-		else
+
+		CharItem item;
+		item.code = ch;
+		if (fontDef->atlas)
 		{
-			fontChar = SharedFontCache.createCharacter(_font, ch);
-			fontChar->setBlendFunc(_blendFunc);
-			addChild(fontChar);
-			_characters[i] = fontChar;
+			const bgfx::AtlasRegion& region = fontDef->atlas->getRegion(fontDef->regionIndex);
+			item.texture = fontDef->atlas->getTexture();
+			item.rect = Rect(region.x, region.y, region.width, region.height);
 		}
-
-		float yOffset = commonHeight - fontDef->offset_y;
-		Vec2 fontPos = Vec2{
-			nextFontPositionX + fontDef->offset_x + fontDef->width * 0.5f + kerningAmount,
-			nextFontPositionY + yOffset - fontDef->height * 0.5f};
-		fontChar->setPosition(fontPos);
+		item.pos = Vec2{left + fontDef->width * 0.5f, -fontDef->offset_y - fontDef->height * 0.5f};
+		line.characters.push_back(item);
+		line.text.push_back(ch);
+		pens.push_back(penX);
 
 		// update kerning
-		nextFontPositionX += fontDef->advance_x + kerningAmount;
+		penX += fontDef->advance_x + kerningAmount;
 		prev = ch;
-		if (longestLine < nextFontPositionX)
+	}
+	line.widths.push_back(getLineWidth());
+}
+
+void Label::addLines(vector<TextLine>& lines, const string& text, size_t begin, size_t end)
+{
+	size_t lineStart = begin;
+	for (size_t pos = begin; pos <= end; pos++)
+	{
+		if (pos == end || text[pos] == '\n')
 		{
-			longestLine = nextFontPositionX;
+			lines.emplace_back();
+			TextLine& line = lines.back();
+			line.bytes = pos - lineStart;
+			line.source = utf8_get_characters(text.substr(lineStart, line.bytes).c_str());
+			layoutLine(line);
+			lineStart = pos + 1;
 		}
 	}
+}
 
-	if (_textWidth > 0)
+void Label::updateSprites(size_t start)
+{
+	for (size_t i = _characters.size(); i < _sprites.size(); i++)
 	{
-		finalSize.width = _textWidth;
+		if (_sprites[i])
+		{
+			_sprites[i]->setVisible(false);
+		}
 	}
-	else if (fontDef)
+	if (_sprites.size() < _characters.size())
 	{
-		// If the last character processed has an xAdvance which is less that the width of the characters image, then we need
-		// to adjust the width of the string to take this into account, or the character will overlap the end of the bounding
-		// box
-		if (fontDef->advance_x < fontDef->width)
+		_sprites.resize(_characters.size());
+	}
+	for (size_t i = start; i < _characters.size(); i++)
+	{
+		const CharItem& item = _characters[i];
+		Sprite* fontChar = _sprites[i];
+		if (!item.texture)
+		{
+			if (fontChar)
+			{
+				fontChar->setVisible(false);
+			}
+			continue;
+		}
+		if (fontChar)
 		{
-			finalSize.width = longestLine + fontDef->width - fontDef->advance_x;
+			SharedFontCache.updateCharacter(fontChar, _font, item.code);
+			fontChar->setVisible(true);
 		}
 		else
 		{
-			finalSize.width = longestLine;
+			fontChar = SharedFontCache.createCharacter(_font, item.code);
+			fontChar->setBlendFunc(_blendFunc);
+			addChild(fontChar);
+			_sprites[i] = fontChar;
 		}
+		fontChar->setPosition(item.pos + _offset);
 	}
-	else
+}
+
+void Label::updateBatches(size_t start)
+{
+	for (TextBatch& batch : _batches)
 	{
-		finalSize.width = 0.0f;
+		size_t count = std::lower_bound(batch.owners.begin(), batch.owners.end(), s_cast<Uint32>(start)) - batch.owners.begin();
+		batch.owners.resize(count);
+		batch.positions.resize(count * 4);
+		batch.vertices.resize(count * 4);
+		batch.transformed = std::min(batch.transformed, batch.vertices.size());
+		batch.colored = std::min(batch.colored, batch.vertices.size());
 	}
-	finalSize.height = totalHeight;
-	setSize(finalSize);
+	float scale = _font->getInfo().scale;
+	for (size_t i = start; i < _characters.size(); i++)
+	{
+		const CharItem& item = _characters[i];
+		if (!item.texture || item.rect.size == Size::zero) continue;
+		auto it = std::find_if(_batches.begin(), _batches.end(), [&](const TextBatch& batch)
+		{
+			return batch.texture == item.texture;
+		});
+		if (it == _batches.end())
+		{
+			_batches.push_back({item.texture});
+			it = _batches.end() - 1;
+		}
+		const bgfx::TextureInfo& info = item.texture->getInfo();
+		float left = item.rect.getX() / info.width;
+		float top = item.rect.getY() / info.height;
+		float right = (item.rect.getX() + item.rect.getWidth()) / info.width;
+		float bottom = (item.rect.getY() + item.rect.getHeight()) / info.height;
+		float width = item.rect.getWidth() * scale;
+		float height = item.rect.getHeight() * scale;
+		float x = item.pos.x - width * 0.5f;
+		float y = item.pos.y - height * 0.5f;
+		it->owners.push_back(s_cast<Uint32>(i));
+		it->positions.insert(it->positions.end(), {
+			{x, y + height, 0, 1},
+			{x + width, y + height, 0, 1},
+			{x, y, 0, 1},
+			{x + width, y, 0, 1}
+		});
+		it->vertices.insert(it->vertices.end(), {
+			{0, 0, 0, 1, left, top},
+			{0, 0, 0, 1, right, top},
+			{0, 0, 0, 1, left, bottom},
+			{0, 0, 0, 1, right, bottom}
+		});
+	}
+	_batches.erase(std::remove_if(_batches.begin(), _batches.end(), [](const TextBatch& batch)
+	{
+		return batch.vertices.empty();
+	}), _batches.end());
 }
 
-void Label::updateLabel()
+void Label::render()
 {
-	// Step 0: Create characters
-	updateCharacters(_text);
+	if (_flags.isOn(Label::SpriteMode)) return;
 
-	if (_text.empty()) return;
-
-	// Step 1: Make multiline
-	if (_textWidth >= 0)
+	if (_flags.isOn(Label::BatchDirty))
 	{
-		// Step 1: Make multiline
-		int stringLength = s_cast<int>(_text.size());
-		vector<Uint32> multiline_string;
-		multiline_string.reserve(stringLength);
-		vector<Uint32> last_word;
-		last_word.reserve(stringLength);
+		_flags.setOff(Label::BatchDirty);
+		updateBatches(_batchStart);
+		_batchStart = _characters.size();
+	}
 
-		int i = 0;
-		bool start_line = false, start_word = false, skiped_one = false;
-		float startOfLine = -1, startOfWord = -1;
+	if (_batches.empty()) return;
 
-		for (int j = 0; j < stringLength; j++)
+	// recolor and transform all the quads when the label changes,
+	// otherwise only the quads appended by the last text change
+	bool colorDirty = _flags.isOn(Label::VertexColorDirty);
+	_flags.setOff(Label::VertexColorDirty);
+	Uint32 abgr = _realColor.toABGR();
+	for (TextBatch& batch : _batches)
+	{
+		for (size_t i = colorDirty ? 0 : batch.colored; i < batch.vertices.size(); i++)
 		{
-			int justSkipped = 0;
-			Sprite* characterSprite;
-			while (!(characterSprite = _characters[j + justSkipped]) || !characterSprite->isVisible())
-			{
-				justSkipped++;
-				if (j + justSkipped >= stringLength)
-				{
-					break;
-				}
-			}
-			j += justSkipped;
-
-			if (i >= stringLength) break;
-
-			Uint32 character = _text[i];
+			batch.vertices[i].abgr = abgr;
+		}
+		batch.colored = batch.vertices.size();
+	}
 
-			if (!start_word)
-			{
-				startOfWord = getLetterPosXLeft(characterSprite);
-				start_word = true;
-			}
-			if (!start_line)
-			{
-				startOfLine = startOfWord;
-				start_line = true;
-			}
+	bool posDirty = _flags.isOn(Label::VertexPosDirty);
+	_flags.setOff(Label::VertexPosDirty);
+	float offset[16];
+	float local[16];
+	float transform[16];
+	bx::mtxTranslate(offset, _offset.x, _offset.y, 0.0f);
+	bx::mtxMul(local, offset, _world);
+	bx::mtxMul(transform, local, SharedDirector.getViewProjection());
+	for (TextBatch& batch : _batches)
+	{
+		for (size_t i = posDirty ? 0 : batch.transformed; i < batch.vertices.size(); i++)
+		{
+			bx::vec4MulMtx(&batch.vertices[i].x, batch.positions[i], transform);
+		}
+		batch.transformed = batch.vertices.size();
+	}
 
-			// Newline.
-			if (character == '\n')
-			{
-				utf8_trim_ws(last_word);
-				for (int n = 0; n < justSkipped; n++)
-				{
-					last_word.push_back('\n');
-				}
-				multiline_string.insert(
-					multiline_string.end(),
-					last_word.begin(),
-					last_word.end());
-				last_word.clear();
-				start_word = false;
-				start_line = false;
-				startOfWord = -1;
-				startOfLine = -1;
-				i += justSkipped;
-
-				if (i >= stringLength) break;
-
-				character = _text[i];
-				if (!startOfWord)
-				{
-					startOfWord = getLetterPosXLeft(characterSprite);
-					start_word = true;
-				}
-				if (!startOfLine)
-				{
-					startOfLine = startOfWord;
-					start_line = true;
-				}
-			}
+	Uint64 state = (
+		BGFX_STATE_RGB_WRITE | BGFX_STATE_ALPHA_WRITE |
+		BGFX_STATE_MSAA | _blendFunc.toValue());
+	SpriteEffect* effect = SharedFontCache.getCharacterEffect(_font);
+	SharedRendererManager.setCurrent(SharedSpriteRenderer.getTarget());
+	for (TextBatch& batch : _batches)
+	{
+		SharedSpriteRenderer.push(batch.vertices.data(), s_cast<Uint32>(batch.vertices.size()),
+			effect, batch.texture, state);
+	}
+}
 
-			// Whitespace.
-			if (utf8_isspace(character))
-			{
-				last_word.push_back(character);
-				multiline_string.insert(
-					multiline_string.end(),
-					last_word.begin(),
-					last_word.end());
-				last_word.clear();
-				start_word = false;
-				startOfWord = -1;
-				i++;
-				continue;
-			}
+void Label::updateText(const string& text)
+{
+	if (_lines.empty())
+	{
+		_textUTF8 = text;
+		updateLabel();
+		return;
+	}
 
-			// Out of bounds.
-			if (i > 0 && !skiped_one && getLetterPosXRight(characterSprite) - startOfLine > _textWidth)
-			{
-				if (character <= 255 && std::isalnum(character))
-				{
-					last_word.push_back(character);
-					int found = utf8_find_last_not_alnum(last_word);
-					if (found != -1)
-					{
-						auto begin = last_word.begin();
-						auto end = last_word.begin() + found + 1;
-						multiline_string.insert(multiline_string.end(),
-							begin, end);
-						multiline_string.push_back('\n');
-						last_word.erase(begin, end);
-						startOfWord = getLetterPosXLeft(_characters[i - last_word.size()]);
-						start_word = true;
-						startOfLine = startOfWord;
-						start_line = true;
-						i++;
-					}
-					else
-					{
-						found = utf8_find_last_not_char(multiline_string, ' ');
-						if (found != -1)
-						{
-							utf8_trim_ws(multiline_string);
-						}
-						else
-						{
-							multiline_string.clear();
-						}
-						if (multiline_string.size() > 0)
-						{
-							multiline_string.push_back('\n');
-						}
-						start_line = false;
-						startOfLine = -1;
-						i++;
-					}
-				}
-				else
-				{
-					utf8_trim_ws(last_word);
+	// Step 0: Find the lines kept at both ends by comparing the utf-8 bytes,
+	// so that only the changed part of the text is decoded and laid out
+	size_t oldSize = _textUTF8.size();
+	size_t newSize = text.size();
+	size_t prefix = 0;
+	size_t maxPrefix = std::min(oldSize, newSize);
+	while (prefix < maxPrefix && _textUTF8[prefix] == text[prefix]) prefix++;
+	size_t suffix = 0;
+	size_t maxSuffix = std::min(oldSize, newSize) - prefix;
+	while (suffix < maxSuffix && _textUTF8[oldSize - 1 - suffix] == text[newSize - 1 - suffix]) suffix++;
+
+	size_t oldCount = _lines.size();
+	size_t head = 0;
+	size_t headBytes = 0;
+	while (head < oldCount && !_lines[head].pending && headBytes + _lines[head].bytes + 1 <= prefix)
+	{
+		headBytes += _lines[head].bytes + 1;
+		head++;
+	}
+	if (head == oldCount - 1 && !_lines[head].pending && prefix == oldSize && text[oldSize] == '\n')
+	{
+		// lines appended after the old text
+		headBytes = oldSize + 1;
+		head++;
+	}
+	size_t tail = 0;
+	size_t tailBytes = 0;
+	while (tail < oldCount - head && !_lines[oldCount - 1 - tail].pending &&
+		tailBytes + _lines[oldCount - 1 - tail].bytes + 1 <= suffix)
+	{
+		tailBytes += _lines[oldCount - 1 - tail].bytes + 1;
+		tail++;
+	}
 
-					last_word.push_back('\n');
-					multiline_string.insert(multiline_string.end(),
-						last_word.begin(), last_word.end());
-					last_word.clear();
-					start_word = false;
-					start_line = false;
-					startOfWord = -1;
-					startOfLine = -1;
+	// Step 1: Split the changed bytes by line breaks and lay them out
+	vector<TextLine> changed;
+	addLines(changed, text, headBytes, newSize - tailBytes);
+	vector<TextLine> lines;
+	lines.reserve(head + changed.size() + tail);
+	for (size_t i = 0; i < head; i++)
+	{
+		lines.push_back(std::move(_lines[i]));
+	}
+	for (TextLine& line : changed)
+	{
+		lines.push_back(std::move(line));
+	}
+	for (size_t i = oldCount - tail; i < oldCount; i++)
+	{
+		lines.push_back(std::move(_lines[i]));
+	}
+	_lines = std::move(lines);
+	_textUTF8 = text;
 
-					if (i >= stringLength) break;
+	updateCharacters(head);
+}
 
-					if (!startOfWord)
-					{
-						startOfWord = getLetterPosXLeft(characterSprite);
-						start_word = true;
-					}
-					if (!startOfLine)
-					{
-						startOfLine = startOfWord;
-						start_line = true;
-					}
-					j--;
-					skiped_one = true;
-				}
-			}
-			else
+void Label::updateLabel()
+{
+	// Step 0: Split the whole text by line breaks when it is not laid out,
+	// or lay out again the lines waiting for baked glyphs
+	size_t firstLine = _lines.size();
+	if (_lines.empty())
+	{
+		addLines(_lines, _textUTF8, 0, _textUTF8.size());
+		firstLine = 0;
+	}
+	else
+	{
+		for (size_t i = 0; i < _lines.size(); i++)
+		{
+			if (_lines[i].pending)
 			{
-				skiped_one = false;
-				// Character is normal.
-				last_word.push_back(character);
-				i++;
+				layoutLine(_lines[i]);
+				firstLine = std::min(firstLine, i);
 			}
 		}
+	}
 
-		multiline_string.insert(multiline_string.end(), last_word.begin(), last_word.end());
+	if (firstLine < _lines.size())
+	{
+		updateCharacters(firstLine);
+	}
+}
 
-		size_t size = multiline_string.size();
-		vector<Uint32> str_new(size);
-		for (size_t i = 0; i < size; ++i)
+void Label::updateCharacters(size_t firstLine)
+{
+	// Step 2: Measure label size, alignment and height are applied as an
+	// offset of the whole label, so the laid out characters stay valid
+	Uint32 quantityOfLines = 0;
+	float longestLine = 0.0f;
+	for (const TextLine& line : _lines)
+	{
+		quantityOfLines += s_cast<Uint32>(line.widths.size());
+		for (float width : line.widths)
 		{
-			str_new[i] = multiline_string[i];
+			longestLine = std::max(longestLine, width);
 		}
-		updateCharacters(str_new);
-		_text = std::move(str_new);
+	}
+	float commonHeight = _font->getInfo().commonHeight - _font->getInfo().lineGap + _lineGap;
+	Size finalSize{_textWidth > 0 ? _textWidth : longestLine, commonHeight * quantityOfLines};
+	setSize(finalSize);
+	float align = 0.0f;
+	switch (_alignment)
+	{
+	case TextAlignment::Center:
+		align = 0.5f;
+		break;
+	case TextAlignment::Right:
+		align = 1.0f;
+		break;
+	default:
+		break;
+	}
+	Vec2 offset{finalSize.width * align, finalSize.height};
+	bool moved = offset != _offset;
+	if (moved)
+	{
+		_offset = offset;
+		_flags.setOn(Label::VertexPosDirty);
 	}
 
-	// Step 2: Make alignment
-	if (_alignment != TextAlignment::Left)
+	// Step 3: Place characters from the first changed line
+	size_t start = 0;
+	Uint32 lineNumber = 0;
+	for (size_t i = 0; i < firstLine; i++)
+	{
+		if (i > 0) start++;
+		start += _lines[i].characters.size();
+		lineNumber += s_cast<Uint32>(_lines[i].widths.size());
+	}
+	_text.resize(start);
+	_characters.resize(start);
+	for (size_t n = firstLine; n < _lines.size(); n++)
 	{
-		int i = 0;
-		int lineNumber = 0;
-		vector<Uint32> last_line;
-		for (size_t ctr = 0; ctr <= _text.size(); ++ctr)
+		const TextLine& line = _lines[n];
+		if (n > 0)
 		{
-			if (_text[ctr] == '\n' || _text[ctr] == '\0')
+			CharItem lineBreak;
+			lineBreak.code = '\n';
+			_characters.push_back(lineBreak);
+			_text.push_back('\n');
+		}
+		size_t subLine = 0;
+		float shift = 0.0f;
+		for (size_t i = 0; i < line.characters.size(); i++)
+		{
+			if (i == 0 || line.text[i - 1] == '\n')
 			{
-				float lineWidth = 0.0f;
-				int line_length = s_cast<int>(last_line.size());
-				// if last line is empty we must just increase lineNumber and work with next line
-				if (line_length == 0)
-				{
-					lineNumber++;
-					continue;
-				}
-				int index = i + line_length - 1 + lineNumber;
-				if (index < 0) continue;
-				Sprite* lastChar = _characters[index];
-				if (lastChar == nullptr) continue;
-				lineWidth = lastChar->getX() + lastChar->getWidth() / 2.0f;
-
-				float shift = 0;
-				switch (_alignment)
-				{
-				case TextAlignment::Center:
-					shift = getWidth() / 2.0f - lineWidth / 2.0f;
-					break;
-				case TextAlignment::Right:
-					shift = getWidth() - lineWidth;
-					break;
-				default:
-					break;
-				}
-				if (shift != 0)
-				{
-					for (int j = 0; j < line_length; j++)
-					{
-						index = i + j + lineNumber;
-						if (index < 0) continue;
-						Sprite* characterSprite = _characters[index];
-						if (characterSprite)
-						{
-							characterSprite->setPosition(characterSprite->getPosition() + Vec2{shift, 0.0f});
-						}
-					}
-				}
-
-				i += line_length;
+				shift = -line.widths[subLine++] * align;
 				lineNumber++;
-				last_line.clear();
-				continue;
 			}
-			last_line.push_back(_text[ctr]);
+			CharItem item = line.characters[i];
+			item.pos.x += shift;
+			item.pos.y -= commonHeight * (lineNumber - 1);
+			_characters.push_back(item);
+			_text.push_back(line.text[i]);
+		}
+		if (line.characters.empty())
+		{
+			lineNumber++;
 		}
 	}
+
+	// Step 4: Update sprites or batches after the first changed character
+	if (_flags.isOn(Label::SpriteMode))
+	{
+		updateSprites(moved ? 0 : start);
+	}
+	else
+	{
+		_batchStart = std::min(_batchStart, start);
+		_flags.setOn(Label::BatchDirty);
+	}
+
+	// Step 5: Relayout the pending lines when their glyphs are baked
+	if (!_pendingGlyphs.empty())
+	{
+		vector<Uint32> codes;
+		codes.swap(_pendingGlyphs);
+		WRef<Label> self(this);
+		_font->loadGlyphsAsync(codes, [self]()
+		{
+			Label* label = self.get();
+			if (label && label->_font)
+			{
+				label->updateLabel();
+			}
+		});
+	}
 }
 
 void Label::cleanup()
 {
 	_font = nullptr;
+	_sprites.clear();
+	_batches.clear();
 	Node::cleanup();
 }
 
@@ -11,6 +11,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "font/font_manager.h"
 #include "Support/Geometry.h"
 #include "Node/Node.h"
+#include "Node/Sprite.h"
 
 NS_DOROTHY_BEGIN
 
@@ -32,13 +33,38 @@ public:
 	PROPERTY_READONLY(bgfx::FontHandle, Handle);
 	PROPERTY_READONLY_REF(bgfx::FontInfo, Info);
 	PROPERTY_READONLY(TrueTypeFile*, File);
+	PROPERTY_READONLY_BOOL(SDF);
 	CREATE_FUNC(Font);
 	virtual ~Font();
+	const bgfx::GlyphInfo* getGlyphInfo(Uint32 code);
+	/** @brief get a glyph already loaded, returns nullptr instead of baking it. */
+	const bgfx::GlyphInfo* findGlyphInfo(Uint32 code);
+	/** @brief bake the glyphs not loaded yet in a worker thread, then add
+	 them to the atlas and invoke the callback in main thread. */
+	void loadGlyphsAsync(const vector<Uint32>& codes, const function<void()>& callback);
+	/** @brief whether the glyph is known to be not defined in this font. */
+	bool isGlyphMissing(Uint32 code) const;
+	float getKerning(Uint32 left, Uint32 right);
 protected:
-	Font(TrueTypeFile* file, bgfx::FontHandle handle);
+	Font(TrueTypeFile* file, bgfx::FontHandle handle, Font* master = nullptr);
+	void setGlyphInfo(Uint32 code, const bgfx::GlyphInfo* glyph);
 private:
+	struct BakedGlyph
+	{
+		Uint32 code;
+		bool baked;
+		bgfx::GlyphInfo info;
+		vector<Uint8> bitmap;
+	};
+	unordered_set<Uint32> _loadingGlyphs;
+	unordered_set<Uint32> _missingGlyphs;
+	vector<function<void()>> _loadingCallbacks;
 	bgfx::FontHandle _handle;
 	Ref<TrueTypeFile> _file;
+	Ref<Font> _master;
+	const bgfx::GlyphInfo* _asciiGlyphs[128];
+	unordered_map<Uint32, const bgfx::GlyphInfo*> _glyphs;
+	unordered_map<Uint64, float> _kernings;
 };
 
 class FontManager : public bgfx::FontManager
@@ -61,20 +87,27 @@ public:
 	PROPERTY_READONLY(SpriteEffect*, DefaultEffect);
 	PROPERTY_READONLY(bgfx::FontManager*, Manager);
 	virtual ~FontCache();
+	/** @brief fonts loaded with sdf enabled share one distance field
+	 glyph set of the typeface for all font sizes. */
 	void loadAync(String fontName, Uint32 fontSize,
-		const function<void(Font* font)>& callback);
-	Font* load(String fontName, Uint32 fontSize);
+		const function<void(Font* font)>& callback, bool sdf = false);
+	Font* load(String fontName, Uint32 fontSize, bool sdf = false);
 	bool unload();
-	bool unload(String fontName, Uint32 fontSize);
+	bool unload(String fontName, Uint32 fontSize, bool sdf = false);
 	void removeUnused();
 	Sprite* createCharacter(Font* font, bgfx::CodePoint character);
 	std::tuple<Texture2D*, Rect> getCharacterInfo(Font* font, bgfx::CodePoint character);
 	const bgfx::GlyphInfo* getGlyphInfo(Font* font, bgfx::CodePoint character);
 	const bgfx::GlyphInfo* updateCharacter(Sprite* sp, Font* font, bgfx::CodePoint character);
+	SpriteEffect* getSDFEffect();
+	SpriteEffect* getCharacterEffect(Font* font);
+	static const Uint32 SDFBaseSize;
 protected:
 	FontCache();
+	Font* createFont(TrueTypeFile* file, String fontName, Uint32 fontSize, bool sdf);
 private:
 	Ref<SpriteEffect> _defaultEffect;
+	Ref<SpriteEffect> _sdfEffect;
 	unordered_map<string, Ref<TrueTypeFile>> _fontFiles;
 	unordered_map<string, Ref<Font>> _fonts;
 	SINGLETON_REF(FontCache, FontManager, BGFXDora);
@@ -99,26 +132,81 @@ public:
 	PROPERTY(float, LineGap);
 	PROPERTY(const char*, Text);
 	PROPERTY_REF(BlendFunc, BlendFunc);
-	Sprite* getCharacter(int index) const;
+	/** @brief get a sprite for the character, characters are drawn as
+	 one batch per font atlas page until this is first called,
+	 then label switches to use one sprite node per character. */
+	Sprite* getCharacter(int index);
 	int getCharacterCount() const;
+	virtual void render() override;
+	virtual const float* getWorld() override;
 	virtual void cleanup() override;
 	static const float AutomaticWidth;
 	CREATE_FUNC(Label);
 protected:
-	Label(String fontName, Uint32 fontSize);
-	void updateCharacters(const vector<Uint32>& chars);
+	Label(String fontName, Uint32 fontSize, bool sdf = false);
+	virtual void updateRealColor3() override;
+	virtual void updateRealOpacity() override;
 	void updateLabel();
-	float getLetterPosXLeft(Sprite* sp);
-	float getLetterPosXRight(Sprite* sp);
+	void updateText(const string& text);
+	void updateCharacters(size_t firstLine);
+	void updateSprites(size_t start);
+	void updateBatches(size_t start);
+	struct CharItem
+	{
+		CharItem():code(0), texture(nullptr) { }
+		Uint32 code;
+		Texture2D* texture;
+		Rect rect;
+		Vec2 pos;
+	};
+	/** @brief a line of source text split by line breaks, it is
+	 laid out and wrapped into one or more visual lines. */
+	struct TextLine
+	{
+		size_t bytes = 0;
+		vector<Uint32> source;
+		vector<Uint32> text;
+		vector<CharItem> characters;
+		vector<float> widths;
+		bool pending = false;
+	};
+	void layoutLine(TextLine& line);
+	void addLines(vector<TextLine>& lines, const string& text, size_t begin, size_t end);
+	float getLetterPosXRight(const CharItem& item);
+	enum
+	{
+		VertexColorDirty = Node::UserFlag,
+		VertexPosDirty = Node::UserFlag << 1,
+		BatchDirty = Node::UserFlag << 2,
+		SpriteMode = Node::UserFlag << 3
+	};
 private:
+	/** @brief quads of the characters on one atlas page in character order,
+	 owners keeps the character index of each quad so that a text change
+	 only rewrites the quads after its first changed line. */
+	struct TextBatch
+	{
+		Texture2D* texture;
+		vector<Uint32> owners;
+		vector<Vec4> positions;
+		vector<SpriteVertex> vertices;
+		size_t transformed = 0;
+		size_t colored = 0;
+	};
 	float _textWidth;
 	float _lineGap;
 	Ref<Font> _font;
 	BlendFunc _blendFunc;
 	TextAlignment _alignment;
 	string _textUTF8;
+	Vec2 _offset;
+	size_t _batchStart;
+	vector<Uint32> _pendingGlyphs;
 	vector<Uint32> _text;
-	vector<Sprite*> _characters;
+	vector<CharItem> _characters;
+	vector<TextLine> _lines;
+	vector<Sprite*> _sprites;
+	vector<TextBatch> _batches;
 	DORA_TYPE_OVERRIDE(Label);
 };
 
@@ -384,6 +384,10 @@ void Node::onEnter()
 	}
 	ARRAY_END
 	_flags.setOn(Node::Running);
+	if (isTouchEnabled())
+	{
+		TouchDispatcher::handlerVersion++;
+	}
 	if (isUpdating() || isScheduled())
 	{
 		_scheduler->schedule(this);
@@ -401,6 +405,10 @@ void Node::onExit()
 	}
 	ARRAY_END
 	_flags.setOff(Node::Running);
+	if (isTouchEnabled())
+	{
+		TouchDispatcher::handlerVersion++;
+	}
 	if (isUpdating() || isScheduled())
 	{
 		_scheduler->unschedule(this);
@@ -583,6 +591,10 @@ void Node::setTouchEnabled(bool var)
 		_touchHandler = New<NodeTouchHandler>(this);
 		_touchHandler->setSwallowTouches(_flags.isOn(Node::SwallowTouches));
 	}
+	if (isTouchEnabled() != var && isRunning())
+	{
+		TouchDispatcher::handlerVersion++;
+	}
 	_flags.setFlag(Node::TouchEnabled, var);
 }
 
@@ -605,7 +617,7 @@ bool Node::isSwallowTouches() const
 	return _flags.isOn(Node::SwallowTouches);
 }
 
-TouchHandler* Node::getTouchHandler() const
+NodeTouchHandler* Node::getTouchHandler() const
 {
 	return _touchHandler;
 }
@@ -919,6 +931,7 @@ void Node::markDirty()
 {
 	_flags.setOn(Node::TransformDirty);
 	_flags.setOn(Node::WorldDirty);
+	TouchDispatcher::transformVersion++;
 }
 
 void Node::sortAllChildren()
@@ -931,6 +944,7 @@ void Node::sortAllChildren()
 			return a.to<Node>()->getOrder() < b.to<Node>()->getOrder();
 		});
 		_flags.setOff(Node::Reorder);
+		TouchDispatcher::handlerVersion++;
 	}
 }
 
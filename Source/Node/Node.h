@@ -66,7 +66,7 @@ public:
 	PROPERTY_READONLY_BOOL(Scheduled);
 	PROPERTY_BOOL(TouchEnabled);
 	PROPERTY_BOOL(SwallowTouches);
-	PROPERTY_READONLY(TouchHandler*, TouchHandler);
+	PROPERTY_READONLY(NodeTouchHandler*, TouchHandler);
 
 	virtual void addChild(Node* child, int order, String name);
 	void addChild(Node* child, int order);
@@ -13,6 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Basic/Director.h"
 #include "fmt/format.h"
 #include "Const/XmlTag.h"
+#include "Cache/XmlItemCache.h"
 
 NS_DOROTHY_BEGIN
 
@@ -152,6 +153,64 @@ string ParticleDef::toXml() const
 	return writer.str();
 }
 
+string ParticleDef::toBinary() const
+{
+	BinaryWriter writer('P', 1);
+	auto writeVec4 = [&writer](const Vec4& vec)
+	{
+		writer.write(vec.x); writer.write(vec.y); writer.write(vec.z); writer.write(vec.w);
+	};
+	writer.write(angle);
+	writer.write(angleVariance);
+	writer.write(blendFuncDestination);
+	writer.write(blendFuncSource);
+	writer.write(duration);
+	writer.write(emissionRate);
+	writeVec4(finishColor);
+	writeVec4(finishColorVariance);
+	writer.write(rotationStart);
+	writer.write(rotationStartVariance);
+	writer.write(rotationEnd);
+	writer.write(rotationEndVariance);
+	writer.write(finishParticleSize);
+	writer.write(finishParticleSizeVariance);
+	writer.write(maxParticles);
+	writer.write(particleLifespan);
+	writer.write(particleLifespanVariance);
+	writer.write(startPosition.x); writer.write(startPosition.y);
+	writer.write(startPositionVariance.x); writer.write(startPositionVariance.y);
+	writeVec4(startColor);
+	writeVec4(startColorVariance);
+	writer.write(startParticleSize);
+	writer.write(startParticleSizeVariance);
+	writer.write(textureName);
+	writer.write(textureRect.getX()); writer.write(textureRect.getY());
+	writer.write(textureRect.getWidth()); writer.write(textureRect.getHeight());
+	writer.write(s_cast<Uint8>(emitterType));
+	switch (emitterType)
+	{
+		case EmitterType::Gravity:
+			writer.write(s_cast<Uint8>(mode.gravity.rotationIsDir ? 1 : 0));
+			writer.write(mode.gravity.gravity.x); writer.write(mode.gravity.gravity.y);
+			writer.write(mode.gravity.speed);
+			writer.write(mode.gravity.speedVariance);
+			writer.write(mode.gravity.radialAcceleration);
+			writer.write(mode.gravity.radialAccelVariance);
+			writer.write(mode.gravity.tangentialAcceleration);
+			writer.write(mode.gravity.tangentialAccelVariance);
+			break;
+		case EmitterType::Radius:
+			writer.write(mode.radius.startRadius);
+			writer.write(mode.radius.startRadiusVariance);
+			writer.write(mode.radius.finishRadius);
+			writer.write(mode.radius.finishRadiusVariance);
+			writer.write(mode.radius.rotatePerSecond);
+			writer.write(mode.radius.rotatePerSecondVariance);
+			break;
+	}
+	return writer.getData();
+}
+
 ParticleDef* ParticleDef::fire()
 {
 	ParticleDef* def = ParticleDef::create();
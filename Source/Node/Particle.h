@@ -72,6 +72,7 @@ public:
 	string textureName;
 	Rect textureRect;
 	string toXml() const;
+	string toBinary() const;
 	static ParticleDef* fire();
 	CREATE_FUNC(ParticleDef);
 protected:
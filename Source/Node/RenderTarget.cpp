@@ -21,10 +21,37 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 NS_DOROTHY_BEGIN
 
+/** @brief a reusable slot of the save pipeline, the buffer and the blit
+ texture are kept for the next save once the file is written. */
+struct RenderTarget::Readback
+{
+	enum { Idle, Reading, Encoding } state;
+	Uint32 frame;
+	bgfx::TextureHandle texture;
+	OwnArray<Uint8> data;
+	string file;
+	function<void()> callback;
+	Readback():
+	state(Idle),
+	frame(0)
+	{
+		texture = BGFX_INVALID_HANDLE;
+	}
+	~Readback()
+	{
+		if (bgfx::isValid(texture))
+		{
+			bgfx::destroyTexture(texture);
+		}
+	}
+};
+
 RenderTarget::RenderTarget(Uint16 width, Uint16 height, bgfx::TextureFormat::Enum format):
 _textureWidth(width),
 _textureHeight(height),
-_format(format)
+_format(format),
+_compression(ImageCompression::Default),
+_maxSaves(3)
 { }
 
 RenderTarget::~RenderTarget()
@@ -46,6 +73,36 @@ Camera* RenderTarget::getCamera() const
 	return _camera;
 }
 
+void RenderTarget::setCompression(ImageCompression var)
+{
+	_compression = var;
+}
+
+ImageCompression RenderTarget::getCompression() const
+{
+	return _compression;
+}
+
+void RenderTarget::setMaxSaves(Uint32 var)
+{
+	_maxSaves = std::max(var, 1u);
+}
+
+Uint32 RenderTarget::getMaxSaves() const
+{
+	return _maxSaves;
+}
+
+Uint32 RenderTarget::getPendingSaves() const
+{
+	Uint32 count = 0;
+	for (const auto& readback : _readbacks)
+	{
+		if (readback->state != Readback::Idle) count++;
+	}
+	return count;
+}
+
 bool RenderTarget::init()
 {
 	const Uint32 textureFlags = (
@@ -115,9 +172,13 @@ void RenderTarget::renderAfterClear(Node* target, bool clear, Color color, float
 			}
 		}
 		bgfx::setViewTransform(viewId, nullptr, viewProj);
-		SharedDirector.pushViewProjection(viewProj, [&]()
+		Size viewport{s_cast<float>(_textureWidth), s_cast<float>(_textureHeight)};
+		SharedRendererManager.pushViewport(viewport, [&]()
 		{
-			renderOnly(target);
+			SharedDirector.pushViewProjection(viewProj, [&]()
+			{
+				renderOnly(target);
+			});
 		});
 	});
 }
@@ -150,76 +211,164 @@ void RenderTarget::renderWithClear(Node* target, Color color, float depth, Uint8
 	renderAfterClear(target, true, color, depth, stencil);
 }
 
-void RenderTarget::saveAsync(String filename, const function<void()>& callback)
+bool RenderTarget::saveAsync(String filename, const function<void()>& callback)
 {
-	AssertIf((bgfx::getCaps()->supported & BGFX_CAPS_TEXTURE_READ_BACK) == 0, "texture read back not supported.");
+	// the noop renderer has nothing to read back, the buffer is saved as it is
+	bool noop = bgfx::getCaps()->rendererType == bgfx::RendererType::Noop;
+	AssertIf(!noop && (bgfx::getCaps()->supported & BGFX_CAPS_TEXTURE_READ_BACK) == 0, "texture read back not supported.");
 
-	Uint32 extraFlags = 0;
-	switch (bgfx::getCaps()->rendererType)
+	if (getPendingSaves() >= _maxSaves) return false;
+	Readback* readback = nullptr;
+	for (const auto& item : _readbacks)
 	{
-	case bgfx::RendererType::Direct3D9:
-	case bgfx::RendererType::Direct3D11:
-	case bgfx::RendererType::Direct3D12:
-		extraFlags = BGFX_TEXTURE_BLIT_DST;
-		break;
-	default:
-		break;
+		if (item->state == Readback::Idle)
+		{
+			readback = item.get();
+			break;
+		}
 	}
-	bgfx::TextureHandle textureHandle;
-	if (extraFlags)
+	if (!readback)
 	{
-		const Uint32 textureFlags = BGFX_TEXTURE_U_CLAMP | BGFX_TEXTURE_V_CLAMP | BGFX_TEXTURE_READ_BACK;
-		textureHandle = bgfx::createTexture2D(_textureWidth, _textureHeight, false, 1, _format, textureFlags | extraFlags);
-		SharedView.pushName("SaveTarget"_slice, [&]()
-		{
-			bgfx::blit(SharedView.getId(), textureHandle, 0, 0, _texture->getHandle());
-		});
+		_readbacks.push_back(New<Readback>());
+		readback = _readbacks.back().get();
+	}
+	if (!readback->data)
+	{
+		Uint32 storageSize = _texture->getInfo().storageSize;
+		readback->data = NewArray<Uint8>(storageSize);
+		std::memset(readback->data.get(), 0, storageSize);
+	}
+
+	if (noop)
+	{
+		readback->frame = SharedApplication.getFrame() + 1;
 	}
 	else
 	{
-		textureHandle = _texture->getHandle();
+		bgfx::TextureHandle textureHandle = _texture->getHandle();
+		switch (bgfx::getCaps()->rendererType)
+		{
+		case bgfx::RendererType::Direct3D9:
+		case bgfx::RendererType::Direct3D11:
+		case bgfx::RendererType::Direct3D12:
+			if (!bgfx::isValid(readback->texture))
+			{
+				const Uint32 textureFlags = BGFX_TEXTURE_U_CLAMP | BGFX_TEXTURE_V_CLAMP | BGFX_TEXTURE_READ_BACK | BGFX_TEXTURE_BLIT_DST;
+				readback->texture = bgfx::createTexture2D(_textureWidth, _textureHeight, false, 1, _format, textureFlags);
+			}
+			textureHandle = readback->texture;
+			SharedView.pushName("SaveTarget"_slice, [&]()
+			{
+				bgfx::blit(SharedView.getId(), textureHandle, 0, 0, _texture->getHandle());
+			});
+			break;
+		default:
+			break;
+		}
+		readback->frame = bgfx::readTexture(textureHandle, readback->data.get());
+	}
+	readback->state = Readback::Reading;
+	readback->file = filename;
+	readback->callback = callback;
+
+	if (_flags.isOff(RenderTarget::ReadbackScheduled))
+	{
+		_flags.setOn(RenderTarget::ReadbackScheduled);
+		Ref<RenderTarget> self(this);
+		SharedDirector.getSystemScheduler()->schedule([self](double deltaTime)
+		{
+			DORA_UNUSED_PARAM(deltaTime);
+			return self->updateReadbacks();
+		});
 	}
-	Uint8* data = new Uint8[_texture->getInfo().storageSize];
-	Uint32 frame = bgfx::readTexture(textureHandle, data);
-	Uint32 width = s_cast<Uint32>(_textureWidth);
-	Uint32 height = s_cast<Uint32>(_textureHeight);
-	string file(filename);
-	SharedDirector.getSystemScheduler()->schedule([frame, textureHandle, extraFlags, data, width, height, file, callback](double deltaTime)
-	{
-		DORA_UNUSED_PARAM(deltaTime);
-		if (frame <= SharedApplication.getFrame())
+	return true;
+}
+
+bool RenderTarget::updateReadbacks()
+{
+	bool reading = false;
+	Uint32 frame = SharedApplication.getFrame();
+	for (size_t i = 0; i < _readbacks.size(); i++)
+	{
+		Readback* readback = _readbacks[i].get();
+		if (readback->state != Readback::Reading) continue;
+		if (readback->frame > frame)
 		{
-			if (extraFlags)
+			reading = true;
+			continue;
+		}
+		readback->state = Readback::Encoding;
+		Uint8* data = readback->data.get();
+		Uint32 width = s_cast<Uint32>(_textureWidth);
+		Uint32 height = s_cast<Uint32>(_textureHeight);
+		ImageCompression compression = _compression;
+		// slots take turns on two workers so that captures are encoded in parallel
+		Async& encoder = i % 2 == 0 ? SharedAsyncThread.Process : SharedAsyncThread.Loader;
+		Ref<RenderTarget> self(this);
+		encoder.run([data, width, height, compression]()
+		{
+			LodePNGState state;
+			lodepng_state_init(&state);
+			switch (compression)
+			{
+				case ImageCompression::Fast:
+					state.encoder.auto_convert = 0;
+					state.encoder.filter_strategy = LFS_ZERO;
+					state.encoder.zlibsettings.btype = 1;
+					state.encoder.zlibsettings.windowsize = 512;
+					state.encoder.zlibsettings.lazymatching = 0;
+					break;
+				case ImageCompression::None:
+					state.encoder.auto_convert = 0;
+					state.encoder.filter_strategy = LFS_ZERO;
+					state.encoder.zlibsettings.btype = 0;
+					break;
+				default:
+					break;
+			}
+			Uint8* out = nullptr;
+			size_t outSize = 0;
+			unsigned error = lodepng_encode(&out, &outSize, data, width, height, &state);
+			lodepng_state_cleanup(&state);
+			if (error)
 			{
-				bgfx::destroyTexture(textureHandle);
+				::free(out);
+				out = nullptr;
+				outSize = 0;
 			}
-			SharedAsyncThread.Process.run([data, width, height]()
+			return Values::create(out, outSize);
+		}, [self, readback](Values* values)
+		{
+			Uint8* out;
+			size_t outSize;
+			values->get(out, outSize);
+			auto finish = [self, readback]()
+			{
+				function<void()> callback = std::move(readback->callback);
+				readback->callback = nullptr;
+				readback->file.clear();
+				readback->state = Readback::Idle;
+				if (callback) callback();
+			};
+			if (!out)
 			{
-				unsigned error;
-				LodePNGState state;
-				lodepng_state_init(&state);
-				Uint8* out = nullptr;
-				size_t outSize = 0;
-				error = lodepng_encode(&out, &outSize, data, width, height, &state);
-				lodepng_state_cleanup(&state);
-				delete [] data;
-				return Values::create(out, outSize);
-			}, [callback, file](Values* values)
+				Log("fail to encode image for \"%s\".", readback->file);
+				finish();
+				return;
+			}
+			Slice content(r_cast<char*>(out), outSize);
+			SharedContent.saveToFileAsync(readback->file, content, [out, finish]()
 			{
-				Uint8* out;
-				size_t outSize;
-				values->get(out, outSize);
-				Slice content(r_cast<char*>(out), outSize);
-				SharedContent.saveToFileAsync(file, content, [out, callback]()
-				{
-					::free(out);
-					callback();
-				});
+				::free(out);
+				finish();
 			});
-			return true;
-		}
-		return false;
-	});
+		});
+	}
+	if (!reading)
+	{
+		_flags.setOff(RenderTarget::ReadbackScheduled);
+	}
+	return !reading;
 }
 
 NS_DOROTHY_END
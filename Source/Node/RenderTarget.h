@@ -16,25 +16,47 @@ class Camera;
 class Sprite;
 class Texture2D;
 
+/** @brief How hard the saved png images are compressed,
+ Fast and None trade file size for encoding time. */
+enum struct ImageCompression
+{
+	Default,
+	Fast,
+	None
+};
+
 class RenderTarget : public Node
 {
 public:
 	PROPERTY(Camera*, Camera);
+	PROPERTY(ImageCompression, Compression);
+	/** @brief Count of saves that can be in flight, each one owns a reusable
+	 readback buffer and texture until its file is written. */
+	PROPERTY(Uint32, MaxSaves);
+	PROPERTY_READONLY(Uint32, PendingSaves);
 	virtual ~RenderTarget();
 	virtual bool init() override;
 	void render(Node* target);
 	void renderWithClear(Node* target, Color color, float depth = 1.0f, Uint8 stencil = 0);
-	void saveAsync(String filename, const function<void()>& callback);
+	/** @brief Read back the texture and save it as a png file, returns false
+	 without saving when MaxSaves are still in flight so that the caller can
+	 skip or retry the capture in a later frame. */
+	bool saveAsync(String filename, const function<void()>& callback);
 	CREATE_FUNC(RenderTarget);
 protected:
 	RenderTarget(Uint16 width, Uint16 height, bgfx::TextureFormat::Enum format = bgfx::TextureFormat::RGBA8);
 	void renderAfterClear(Node* target, bool clear, Color color = 0x0, float depth = 1.0f, Uint8 stencil = 0);
 	void renderOnly(Node* target);
 	void end();
+	bool updateReadbacks();
 private:
 	Uint16 _textureWidth;
 	Uint16 _textureHeight;
 	bgfx::TextureFormat::Enum _format;
+	ImageCompression _compression;
+	Uint32 _maxSaves;
+	struct Readback;
+	OwnVector<Readback> _readbacks;
 	Ref<Texture2D> _texture;
 	Ref<Sprite> _sprite;
 	Ref<Camera> _camera;
@@ -42,6 +64,7 @@ private:
 	enum
 	{
 		ViewCleared = Node::UserFlag,
+		ReadbackScheduled = Node::UserFlag << 1,
 	};
 	DORA_TYPE_OVERRIDE(RenderTarget);
 };
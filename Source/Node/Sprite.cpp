@@ -11,6 +11,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "Effect/Effect.h"
 #include "Cache/ShaderCache.h"
 #include "Cache/TextureCache.h"
+#include "Cache/FrameCache.h"
 #include "Basic/Director.h"
 #include "Basic/View.h"
 
@@ -80,7 +81,7 @@ SpriteEffect* Sprite::getEffect() const
 void Sprite::setTextureRect(const Rect& var)
 {
 	_textureRect = var;
-	updateVertPosition();
+	updateVertPositionIfResized();
 	updateVertTexCoord();
 }
 
@@ -100,6 +101,21 @@ Texture2D* Sprite::getTexture() const
 	return _texture;
 }
 
+void Sprite::setFrame(Texture2D* texture, const FrameQuad& frame)
+{
+	_texture = texture;
+	_textureRect = frame.rect;
+	updateVertPositionIfResized();
+	_quad.lt.u = frame.left;
+	_quad.lt.v = frame.top;
+	_quad.rt.u = frame.right;
+	_quad.rt.v = frame.top;
+	_quad.lb.u = frame.left;
+	_quad.lb.v = frame.bottom;
+	_quad.rb.u = frame.right;
+	_quad.rb.v = frame.bottom;
+}
+
 void Sprite::setAlphaRef(float var)
 {
 	_alphaRef = s_cast<Uint8>(255.0f * Math::clamp(var, 0.0f, 1.0f));
@@ -140,6 +156,11 @@ const SpriteQuad& Sprite::getQuad() const
 	return _quad;
 }
 
+const SpriteQuad::Position& Sprite::getQuadPos() const
+{
+	return _quadPos;
+}
+
 Uint32 Sprite::getTextureFlags() const
 {
 	Uint32 textureFlags = _texture->getFlags();
@@ -269,6 +290,16 @@ void Sprite::updateVertPosition()
 	}
 }
 
+void Sprite::updateVertPositionIfResized()
+{
+	// positions only depend on the rect size, frames of the same size
+	// can skip transforming the quad again
+	if (_quadPos.rb.x != _textureRect.getWidth() || _quadPos.lt.y != _textureRect.getHeight())
+	{
+		updateVertPosition();
+	}
+}
+
 void Sprite::updateVertColor()
 {
 	if (_texture)
@@ -312,7 +343,8 @@ void Sprite::render()
 		updateVertColor();
 	}
 
-	if (_flags.isOn(Sprite::VertexPosDirty))
+	// vertex positions are transformed by the render worker when recording
+	if (_flags.isOn(Sprite::VertexPosDirty) && !SharedRendererManager.isRecording())
 	{
 		_flags.setOff(Sprite::VertexPosDirty);
 		float transform[16];
@@ -344,6 +376,7 @@ _lastEffect(nullptr),
 _lastTexture(nullptr),
 _lastState(0),
 _lastFlags(INT32_MAX),
+_lastModelWorld(nullptr),
 _defaultEffect(SpriteEffect::create("built-in/vs_sprite.bin"_slice, "built-in/fs_sprite.bin"_slice)),
 _defaultModelEffect(SpriteEffect::create("built-in/vs_spritemodel.bin"_slice, "built-in/fs_sprite.bin"_slice)),
 _alphaTestEffect(SpriteEffect::create("built-in/vs_sprite.bin"_slice, "built-in/fs_spritealphatest.bin"_slice))
@@ -368,41 +401,68 @@ void SpriteRenderer::render()
 {
 	if (!_vertices.empty())
 	{
-		bgfx::TransientVertexBuffer vertexBuffer;
-		bgfx::TransientIndexBuffer indexBuffer;
 		Uint32 vertexCount = s_cast<Uint32>(_vertices.size());
-		Uint32 spriteCount = vertexCount >> 2;
-		Uint32 indexCount = spriteCount * 6;
-		if (bgfx::allocTransientBuffers(
-			&vertexBuffer, SpriteVertex::ms_decl, vertexCount,
-			&indexBuffer, indexCount))
+		if (SharedRendererManager.isRecording())
 		{
-			Renderer::render();
-			std::memcpy(vertexBuffer.data, _vertices.data(), _vertices.size() * sizeof(SpriteVertex));
-			uint16_t* indices = r_cast<uint16_t*>(indexBuffer.data);
-			for (size_t i = 0; i < spriteCount; i++)
+			RenderCommand command;
+			command.decl = &SpriteVertex::ms_decl;
+			command.vertexCount = vertexCount;
+			command.quadIndices = true;
+			command.effect = _lastEffect;
+			command.sampler = _lastEffect->getSampler();
+			command.texture = _lastTexture;
+			command.textureFlags = _lastFlags;
+			command.state = _lastState;
+			if (_lastModelWorld)
 			{
-				for (size_t j = 0; j < 6; j++)
-				{
-					indices[i * 6 + j] = s_cast<uint16_t>(_spriteIndices[j] + i * 4);
-				}
+				command.hasModelWorld = true;
+				command.modelWorld = *r_cast<const Matrix*>(_lastModelWorld);
 			}
-			bgfx::setVertexBuffer(&vertexBuffer);
-			bgfx::setIndexBuffer(&indexBuffer);
-			Uint8 viewId = SharedView.getId();
-			bgfx::setTexture(viewId, _lastEffect->getSampler(), _lastTexture->getHandle(), _lastFlags);
-			bgfx::setState(_lastState);
-			bgfx::submit(viewId, _lastEffect->apply());
+			SharedRendererManager.record(command, _vertices.data(), nullptr, &_transforms);
 		}
 		else
 		{
-			Log("not enough transient buffer for %d vertices, %d indices.", vertexCount, indexCount);
+			bgfx::TransientVertexBuffer vertexBuffer;
+			bgfx::TransientIndexBuffer indexBuffer;
+			Uint32 spriteCount = vertexCount >> 2;
+			Uint32 indexCount = spriteCount * 6;
+			if (bgfx::allocTransientBuffers(
+				&vertexBuffer, SpriteVertex::ms_decl, vertexCount,
+				&indexBuffer, indexCount))
+			{
+				Renderer::render();
+				std::memcpy(vertexBuffer.data, _vertices.data(), _vertices.size() * sizeof(SpriteVertex));
+				uint16_t* indices = r_cast<uint16_t*>(indexBuffer.data);
+				for (size_t i = 0; i < spriteCount; i++)
+				{
+					for (size_t j = 0; j < 6; j++)
+					{
+						indices[i * 6 + j] = s_cast<uint16_t>(_spriteIndices[j] + i * 4);
+					}
+				}
+				if (_lastModelWorld)
+				{
+					bgfx::setTransform(_lastModelWorld);
+				}
+				bgfx::setVertexBuffer(&vertexBuffer);
+				bgfx::setIndexBuffer(&indexBuffer);
+				Uint8 viewId = SharedView.getId();
+				bgfx::setTexture(viewId, _lastEffect->getSampler(), _lastTexture->getHandle(), _lastFlags);
+				bgfx::setState(_lastState);
+				bgfx::submit(viewId, _lastEffect->apply());
+			}
+			else
+			{
+				Log("not enough transient buffer for %d vertices, %d indices.", vertexCount, indexCount);
+			}
 		}
 		_vertices.clear();
+		_transforms.clear();
 		_lastEffect = nullptr;
 		_lastTexture = nullptr;
 		_lastState = 0;
 		_lastFlags = INT32_MAX;
+		_lastModelWorld = nullptr;
 	}
 }
 
@@ -423,10 +483,23 @@ void SpriteRenderer::push(Sprite* sprite)
 	_lastFlags = flags;
 
 	const SpriteQuad& quad = sprite->getQuad();
+	Uint32 start = s_cast<Uint32>(_vertices.size());
 	for (Uint32 i = 0; i < 4; i++)
 	{
 		_vertices.push_back(quad[i]);
 	}
+	if (SharedRendererManager.isRecording())
+	{
+		// push vertices in local space and leave the transform to render worker
+		const Vec4* pos = r_cast<const Vec4*>(&sprite->getQuadPos());
+		for (Uint32 i = 0; i < 4; i++)
+		{
+			std::memcpy(&_vertices[start + i].x, &pos[i], sizeof(Vec4));
+		}
+		_transforms.push_back({start, 4,
+			SharedRendererManager.recordViewProjection(SharedDirector.getViewProjection()),
+			*r_cast<const Matrix*>(sprite->getWorld())});
+	}
 }
 
 void SpriteRenderer::push(SpriteVertex* verts, Uint32 size,
@@ -448,7 +521,7 @@ void SpriteRenderer::push(SpriteVertex* verts, Uint32 size,
 	}
 	if (modelWorld)
 	{
-		bgfx::setTransform(modelWorld);
+		_lastModelWorld = modelWorld;
 		render();
 	}
 }
@@ -62,6 +62,7 @@ struct SpriteQuad
 };
 
 class SpriteEffect;
+struct FrameQuad;
 
 class Sprite : public Node
 {
@@ -74,6 +75,7 @@ public:
 	PROPERTY_BOOL(DepthWrite);
 	PROPERTY_READONLY(Uint64, RenderState);
 	PROPERTY_READONLY_REF(SpriteQuad, Quad);
+	PROPERTY_READONLY_REF(SpriteQuad::Position, QuadPos);
 	PROPERTY_READONLY(Uint32, TextureFlags);
 	PROPERTY(TextureFilter, Filter);
 	PROPERTY(TextureWrap, UWrap);
@@ -82,6 +84,9 @@ public:
 	virtual bool init() override;
 	virtual void render() override;
 	virtual const float* getWorld() override;
+	/** @brief Show a frame with precomputed texture coordinates,
+	 the vertex positions are kept when the frame size is unchanged. */
+	void setFrame(Texture2D* texture, const FrameQuad& frame);
 	CREATE_FUNC(Sprite);
 protected:
 	Sprite();
@@ -90,6 +95,7 @@ protected:
 	Sprite(Texture2D* texture, const Rect& textureRect);
 	void updateVertTexCoord();
 	void updateVertPosition();
+	void updateVertPositionIfResized();
 	void updateVertColor();
 	virtual void updateRealColor3() override;
 	virtual void updateRealOpacity() override;
@@ -136,7 +142,9 @@ private:
 	SpriteEffect* _lastEffect;
 	Uint64 _lastState;
 	Uint32 _lastFlags;
+	const float* _lastModelWorld;
 	vector<SpriteVertex> _vertices;
+	vector<RenderTransform> _transforms;
 	const uint16_t _spriteIndices[6];
 	SINGLETON_REF(SpriteRenderer, RendererManager);
 };
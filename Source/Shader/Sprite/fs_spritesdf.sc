@@ -0,0 +1,12 @@
+$input v_color0, v_texcoord0
+
+#include "../bgfx_shader.sh"
+
+SAMPLER2D(s_texColor, 0);
+
+void main()
+{
+	float dist = texture2D(s_texColor, v_texcoord0).a;
+	float alpha = smoothstep(0.45, 0.55, dist);
+	gl_FragColor = vec4(v_color0.xyz, v_color0.w * alpha);
+}
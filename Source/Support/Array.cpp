@@ -8,6 +8,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include "Const/Header.h"
 #include "Support/Array.h"
+#include "Basic/Application.h"
 
 NS_DOROTHY_BEGIN
 
@@ -54,7 +55,7 @@ const Ref<Object>& Array::getFirst() const
 const Ref<Object>& Array::getRandomObject() const
 {
 	AssertIf(_data.empty(), "retrieving random item from an empty array.");
-	return _data[std::rand()%_data.size()];
+	return _data[SharedApplication.getRand()%_data.size()];
 }
 
 bool Array::isEmpty() const
@@ -0,0 +1,55 @@
+--[[
+Generate the asset index loaded by Content for a search path, so that the
+folder is not scanned at startup, run it with LuaJIT or Lua 5.1:
+
+	luajit index.lua root
+
+It writes root/assets.index, each line is "<size>\t<path>" relative to the
+root, folders end with a slash and have a size of -1.
+Regenerate it whenever files under the root are added or removed.
+]]
+
+local root = ...
+if not root then
+	print("usage: luajit index.lua root")
+	os.exit(1)
+end
+
+local isWindows = package.config:sub(1, 1) == "\\"
+root = root:gsub("[/\\]$", "")
+
+local function list(kind)
+	local command
+	if isWindows then
+		command = 'dir /s /b '..(kind == "d" and "/ad" or "/a-d")..' "'..root..'"'
+	else
+		command = 'find "'..root..'" -mindepth 1 -type '..kind
+	end
+	local items = {}
+	local pipe = io.popen(command)
+	for line in pipe:lines() do
+		local path = line:sub(#root + 2):gsub("\\", "/")
+		if path ~= "assets.index" then
+			items[#items + 1] = path
+		end
+	end
+	pipe:close()
+	table.sort(items)
+	return items
+end
+
+local lines = {}
+for _, folder in ipairs(list("d")) do
+	lines[#lines + 1] = "-1\t"..folder.."/"
+end
+for _, file in ipairs(list("f")) do
+	local input = assert(io.open(root.."/"..file, "rb"))
+	local size = input:seek("end")
+	input:close()
+	lines[#lines + 1] = size.."\t"..file
+end
+
+local output = assert(io.open(root.."/assets.index", "wb"))
+output:write(table.concat(lines, "\n"), "\n")
+output:close()
+print(string.format("indexed %d items under %s", #lines, root))
@@ -0,0 +1,129 @@
+--[[
+Pack the files under a root folder into one pack mounted by
+Content::addPack(), run it with LuaJIT:
+
+	luajit pack.lua [-c] output.pack root
+
+Files are keyed by their paths relative to the root, "Image/logo.png" is
+loaded as "Image/logo.png" after the pack is mounted. With option -c files
+are deflated with zlib when it saves space, it needs the zlib shared library.
+Files kept uncompressed are served by the engine without copying.
+]]
+
+local args = {...}
+local compressFiles = false
+if args[1] == "-c" then
+	compressFiles = true
+	table.remove(args, 1)
+end
+local output, root = args[1], args[2]
+if not output or not root then
+	print("usage: luajit pack.lua [-c] output.pack root")
+	os.exit(1)
+end
+
+local isWindows = package.config:sub(1, 1) == "\\"
+root = root:gsub("[/\\]$", "")
+
+local PageSize = 4096
+local Stored, Deflated = 0, 1
+
+local compress
+if compressFiles then
+	local ffi = require("ffi")
+	ffi.cdef[[
+	unsigned long compressBound(unsigned long sourceLen);
+	int compress2(uint8_t* dest, unsigned long* destLen, const char* source, unsigned long sourceLen, int level);
+	]]
+	local zlib = ffi.load(isWindows and "zlib1" or "z")
+	compress = function(data)
+		local bound = zlib.compressBound(#data)
+		local buffer = ffi.new("uint8_t[?]", bound)
+		local size = ffi.new("unsigned long[1]", bound)
+		if zlib.compress2(buffer, size, data, #data, 9) ~= 0 then
+			return nil
+		end
+		return ffi.string(buffer, size[0])
+	end
+end
+
+local function listFiles()
+	local command
+	if isWindows then
+		command = 'dir /s /b /a-d "'..root..'"'
+	else
+		command = 'find "'..root..'" -type f'
+	end
+	local files = {}
+	local pipe = io.popen(command)
+	for line in pipe:lines() do
+		files[#files + 1] = line:sub(#root + 2):gsub("\\", "/")
+	end
+	pipe:close()
+	table.sort(files)
+	return files
+end
+
+local function uint32(n)
+	return string.char(n % 256, math.floor(n / 256) % 256,
+		math.floor(n / 65536) % 256, math.floor(n / 16777216) % 256)
+end
+
+local function align(n, alignment)
+	return math.ceil(n / alignment) * alignment
+end
+
+local entries = {}
+local namesSize = 0
+local compressedCount = 0
+for _, name in ipairs(listFiles()) do
+	local input = assert(io.open(root.."/"..name, "rb"))
+	local data = input:read("*a")
+	input:close()
+	local entry = {name = name, size = #data, data = data, compression = Stored}
+	if compress and #data > 0 then
+		local packed = compress(data)
+		if packed and #packed < #data then
+			entry.data = packed
+			entry.compression = Deflated
+			compressedCount = compressedCount + 1
+		end
+	end
+	entry.nameOffset = namesSize
+	namesSize = namesSize + #name
+	entries[#entries + 1] = entry
+end
+
+-- file data larger than a page starts at page boundaries to be mapped
+-- without waste, the small ones are packed tightly with 16 bytes alignment
+local indexSize = 16 + #entries * 32
+local position = align(indexSize + namesSize, 16)
+for _, entry in ipairs(entries) do
+	entry.nameOffset = indexSize + entry.nameOffset
+	position = align(position, #entry.data > PageSize and PageSize or 16)
+	entry.dataOffset = position
+	position = position + #entry.data
+end
+assert(position < 4294967296, "pack larger than 4GB is not supported")
+
+local parts = {"DPAK", uint32(1), uint32(#entries), uint32(0)}
+for _, entry in ipairs(entries) do
+	parts[#parts + 1] = uint32(entry.nameOffset)..uint32(#entry.name)
+		..uint32(entry.dataOffset)..uint32(#entry.data)..uint32(entry.size)
+		..uint32(entry.compression)..uint32(0)..uint32(0)
+end
+for _, entry in ipairs(entries) do
+	parts[#parts + 1] = entry.name
+end
+local size = indexSize + namesSize
+for _, entry in ipairs(entries) do
+	parts[#parts + 1] = string.rep("\0", entry.dataOffset - size)
+	parts[#parts + 1] = entry.data
+	size = entry.dataOffset + #entry.data
+end
+
+local file = assert(io.open(output, "wb"))
+file:write(table.concat(parts))
+file:close()
+print(string.format("packed %d files (%d compressed) into %s, %d bytes",
+	#entries, compressedCount, output, size))
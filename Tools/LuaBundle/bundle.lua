@@ -0,0 +1,98 @@
+--[[
+Pack compiled lua modules into one bytecode bundle loaded by
+LuaEngine::loadBundle(), run it with the same LuaJIT version as the engine:
+
+	luajit bundle.lua [-s] output.bundle root [root ...]
+
+Every *.lua file under the roots is compiled and keyed by its path relative
+to the root without extension, "Lib/Class.lua" is required as "Lib.Class".
+Option -s strips debug info from the bytecode.
+]]
+
+local args = {...}
+local strip = false
+if args[1] == "-s" then
+	strip = true
+	table.remove(args, 1)
+end
+local output = table.remove(args, 1)
+if not output or #args == 0 then
+	print("usage: luajit bundle.lua [-s] output.bundle root [root ...]")
+	os.exit(1)
+end
+
+local isWindows = package.config:sub(1, 1) == "\\"
+
+local function listFiles(root)
+	local command
+	if isWindows then
+		command = 'dir /s /b "'..root..'\\*.lua"'
+	else
+		command = 'find "'..root..'" -type f -name "*.lua"'
+	end
+	local files = {}
+	local pipe = io.popen(command)
+	for line in pipe:lines() do
+		files[#files + 1] = line
+	end
+	pipe:close()
+	return files
+end
+
+local function uint32(value)
+	return string.char(
+		value % 256,
+		math.floor(value / 0x100) % 256,
+		math.floor(value / 0x10000) % 256,
+		math.floor(value / 0x1000000) % 256)
+end
+
+local modules = {}
+local names = {}
+for _, root in ipairs(args) do
+	root = root:gsub("[/\\]+$", "")
+	for _, path in ipairs(listFiles(root)) do
+		local name = path:sub(#root + 2):gsub("\\", "/"):gsub("%.lua$", "")
+		if not modules[name] then
+			local chunk, err = loadfile(path)
+			if not chunk then
+				print(err)
+				os.exit(1)
+			end
+			modules[name] = string.dump(chunk, strip)
+			names[#names + 1] = name
+		end
+	end
+end
+table.sort(names)
+
+-- identical chunks are stored once and shared by their index entries
+local headerSize = 12 + #names * 16
+local offset = headerSize
+local nameOffsets = {}
+for i, name in ipairs(names) do
+	nameOffsets[i] = offset
+	offset = offset + #name
+end
+local blobs = {}
+local dataOffsets = {}
+local entries = {}
+for i, name in ipairs(names) do
+	local data = modules[name]
+	local dataOffset = dataOffsets[data]
+	if not dataOffset then
+		dataOffset = offset
+		dataOffsets[data] = dataOffset
+		blobs[#blobs + 1] = data
+		offset = offset + #data
+	end
+	entries[i] = uint32(nameOffsets[i])..uint32(#name)..uint32(dataOffset)..uint32(#data)
+end
+
+local file = assert(io.open(output, "wb"))
+file:write("DLBC", uint32(1), uint32(#names))
+file:write(table.concat(entries))
+file:write(table.concat(names))
+file:write(table.concat(blobs))
+file:close()
+print(string.format("%d modules packed into \"%s\", %d bytes.", #names, output, offset))
@@ -5,7 +5,15 @@ class Application
 	tolua_readonly tolua_property__common int width;
 	tolua_readonly tolua_property__common int height;
 	tolua_readonly tolua_property__common String platform;
+	tolua_readonly tolua_property__common double lastTime;
 	tolua_readonly tolua_property__common double eclapsedTime;
+	tolua_readonly tolua_property__common double ticksPerSecond;
+	tolua_readonly tolua_property__common double heapSize;
+	tolua_readonly tolua_property__bool bool headless;
+	tolua_readonly tolua_property__common double frameTimeMean;
+	tolua_readonly tolua_property__common double frameTimeP95;
+	tolua_readonly tolua_property__common double frameTimeP99;
+	tolua_readonly tolua_property__common Uint32 missedFrames;
 	tolua_property__common unsigned int seed;
 	static tolua_outside Application* Application_shared @ create();
 };
@@ -35,6 +43,7 @@ class Content
 	void insertSearchPath(int index, String path);
 	void addSearchPath(String path);
 	void removeSearchPath(String path);
+	bool addPack(String filename);
 	void loadFileAsync @ loadAsync(String filename, tolua_function handler);
 	void saveToFileAsync @ saveAsync(String filename, String content, tolua_function handler);
 	void copyFileAsync @ copyAsync(String src, String dst, tolua_function handler);
@@ -75,6 +84,13 @@ class Director
 	tolua_readonly tolua_property__common Array* entries;
 	tolua_readonly tolua_property__common Node* currentEntry;
 	tolua_readonly tolua_property__common double deltaTime;
+	tolua_readonly tolua_property__common double updateTime;
+	tolua_readonly tolua_property__common double touchTime;
+	tolua_readonly tolua_property__common double visitTime;
+	tolua_property__common double gCBudget @ gcBudget;
+	tolua_readonly tolua_property__common double gCTime @ gcTime;
+	tolua_outside void Director_setPipelined @ setPipelined(bool var);
+	tolua_outside bool Director_isPipelined @ isPipelined();
 	void setEntry(Node* entry);
 	void pushEntry(Node* entry);
 	Node* popEntry();
@@ -146,7 +162,7 @@ struct Vec2
 	float distanceSquared(Vec2 vec);
 	void normalize();
 	void clamp(Vec2 from, Vec2 to);
-	static tolua_outside Vec2* Vec2_create @ create(float x = 0, float y = 0);
+	static tolua_outside Vec2 Vec2_create @ create(float x = 0, float y = 0);
 	static tolua_readonly Vec2 zero;
 };
 
@@ -160,7 +176,7 @@ struct Size
 	bool operator==(Size other);
 	Size operator*(Vec2 vec);
 	static tolua_readonly Size zero;
-	static tolua_outside Size* Size_create @ create(float width = 0, float height = 0);
+	static tolua_outside Size Size_create @ create(float width = 0, float height = 0);
 };
 
 struct Rect
@@ -243,6 +259,12 @@ class Slot : public Object
 	void clear();
 };
 
+class LuaBatch @ Batch : public Object
+{
+	tolua_readonly tolua_property__common int count;
+	void flush();
+};
+
 class Action : public Object
 {
 	tolua_readonly tolua_property__common float duration;
@@ -352,7 +374,7 @@ struct BlendFunc
 		InvDstColor,
 		InvDstAlpha
 	};
-	static tolua_outside BlendFunc* BlendFunc_create @ create(Uint32 src, Uint32 dst);
+	static tolua_outside BlendFunc BlendFunc_create @ create(Uint32 src, Uint32 dst);
 	static const BlendFunc Default;
 };
 
@@ -381,6 +403,8 @@ class Effect : public Object
 {
 	void set(String name, float var);
 	void set(String name, float var1, float var2, float var3, float var4);
+	Uint32 getIndex(String name);
+	void set @ setAt(Uint32 index, float var1, float var2, float var3, float var4);
 	static Effect* create(String vertShader, String fragShader);
 };
 
@@ -489,17 +513,30 @@ class Label : public Node
 	tolua_property__common char* text;
 	tolua_property__common BlendFunc blendFunc;
 	tolua_readonly tolua_property__common int characterCount;
-	Sprite* getCharacter(int index) const;
+	Sprite* getCharacter(int index);
 	static const float AutomaticWidth;
-	static Label* create(String fontName, Uint32 fontSize);
+	static Label* create(String fontName, Uint32 fontSize, bool sdf = false);
 };
 
+struct ImageCompression
+{
+	enum {
+		Default,
+		Fast,
+		None
+	};
+};
+enum ImageCompression {};
+
 class RenderTarget : public Node
 {
 	tolua_property__common Camera* camera;
+	tolua_property__common ImageCompression compression;
+	tolua_property__common Uint32 maxSaves;
+	tolua_readonly tolua_property__common Uint32 pendingSaves;
 	void render(Node* target);
 	void renderWithClear(Node* target, Color color, float depth = 1.0f, Uint8 stencil = 0);
-	void saveAsync(String filename, tolua_function handler);
+	bool saveAsync(String filename, tolua_function handler);
 	static RenderTarget* create(Uint16 width, Uint16 height);
 };
 
@@ -561,6 +598,21 @@ class Model: public Node
 	static tolua_outside void Model_getAnimationNames @ getAnimations(String filename);
 };
 
+class ModelBatch : public Node
+{
+	tolua_readonly tolua_property__common Uint32 count;
+	tolua_property__common Uint32 parallelThreshold;
+	Uint32 add(Vec2 position);
+	void place(Uint32 index, Vec2 position);
+	float play(Uint32 index, String name, bool loop = false);
+	void stop(Uint32 index);
+	void setSpeed(Uint32 index, float speed);
+	void setFaceRight(Uint32 index, bool var);
+	void setLook(Uint32 index, String name);
+	void clear();
+	static ModelBatch* create(String filename);
+};
+
 class World : public Node
 {
 	tolua_property__common Vec2 gravity;
@@ -926,8 +978,11 @@ struct Cache
 {
 	static bool load(String filename);
 	static void loadAsync(String filename, tolua_function callback);
+	static void prewarmFont(String fontName, Uint32 fontSize, String text, tolua_function callback, bool sdf = false);
+	static Uint32 getFontAtlasCount();
 	static void update(String filename, String content);
 	static void update(String filename, Texture2D* texture);
+	static bool convert(String filename, String target);
 	static void unload();
 	static bool unload(String name);
 	static void removeUnused();
@@ -936,9 +991,14 @@ struct Cache
 
 class Audio
 {
+	tolua_property__common double latencyBudget;
+	tolua_property__common Uint32 maxVoices;
+	tolua_readonly tolua_property__common Uint32 voiceCount;
 	Uint32 play(String filename, bool loop = false);
+	void setLimit(String filename, Uint32 maxInstances, int priority = 0);
 	void stop(Uint32 handle);
 	void playStream(String filename, bool loop = false, float crossFadeTime = 0.0f);
 	void stopStream(float fadeTime = 0.0f);
+	double mixOffline(double duration);
 	static tolua_outside Audio* Audio_shared @ create();
 };
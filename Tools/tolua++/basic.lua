@@ -7,6 +7,7 @@ local objects = {
 "Array",
 "Dictionary",
 "Slot",
+"LuaBatch",
 "Node",
 "Texture2D",
 "Effect",
@@ -22,6 +23,7 @@ local objects = {
 "DrawNode",
 "Line",
 "Model",
+"ModelBatch",
 "World",
 "Sensor",
 "BodyDef",
@@ -39,6 +41,20 @@ for i = 1, #objects do
 	_collect_functions[objects[i]] = "tolua_collect_object"
 end
 
+-- small value types stored inline in userdata without collector,
+-- keep in sync with tolua_isvaluetype in Source/Lua/ToLua/tolua++.h
+local _value_types = {
+"Vec2",
+"Size",
+"Rect",
+"Color3",
+"Color",
+"BlendFunc",
+}
+for i = 1, #_value_types do
+	_collect_functions[_value_types[i]] = "NULL"
+end
+
 -- Name -> push'name'
 _basic["Slice"] = "slice"
 _basic["Uint8"] = "number"
@@ -93,6 +109,29 @@ function post_output_hook(package)
 
 	--replace("","")
 
+    -- check usertypes by integer type ids instead of class names
+    local ctypes = {}
+    for ctype, ltype in pairs(_userltype) do
+        ctypes[ltype] = string.gsub(ctype, "^%s*const%s+", "")
+    end
+    result = string.gsub(result, 'tolua_isusertype%(tolua_S,(%d+),"([^"]+)",', function(narg, ltype)
+        local ctype = ctypes[ltype]
+        if ctype then
+            return 'tolua_isusertype(tolua_S,'..narg..',LuaType<'..ctype..'>(),'
+        end
+    end)
+
+    -- push value types by copy into userdata instead of heap allocated objects
+    for i = 1, #_value_types do
+        local t = _value_types[i]
+        result = string.gsub(result,
+            'void%* tolua_obj = Mtolua_new%(%('..t..'%)%((.-)%)%);%s*tolua_pushusertype%(tolua_S,tolua_obj,[^;]-%);',
+            'tolua_pushvaluetype(tolua_S,'..t..'(%1));')
+        result = string.gsub(result,
+            t..'%s*%*%s*tolua_ret%s*=%s*%('..t..'%s*%*%)%s*Mtolua_new%(%('..t..'%)%((.-)%)%);%s*tolua_pushusertype%(tolua_S,%(void%*%)tolua_ret,[^;]-%);',
+            'tolua_pushvaluetype(tolua_S,'..t..'(%1));')
+    end
+
     WRITE(result)
 end
 